@@ -27,6 +27,7 @@
  #include "Logger.h"
  #include "ROMLoader.h"
  #include "FileSystem.h"
+ #include "FrameExchange.h"
  #include "SDLRenderer.h"
  #include "SDLAudioOutput.h"
  #include "Debugger.h"
@@ -328,6 +329,10 @@
 	 std::unique_ptr<SDLRenderer> m_renderer;
 	 std::unique_ptr<SDLAudioOutput> m_audioOutput;
 	 
+	 // Finished frames passed from the emulation thread to the main thread
+	 // (sized to the screen resolution when a ROM is loaded)
+	 FrameExchange m_frameExchange;
+	 
 	 // Current state
 	 std::atomic<EmulatorState> m_state;
 	 
@@ -389,10 +394,24 @@
 	 
 	 /**
 	  * Process a single emulation frame
+	  * 
+	  * Runs on the emulation thread. The frame is rendered with
+	  * GraphicsSystem::Render into the exchange's write buffer and published,
+	  * so emulation of the next frame starts without waiting for presentation.
 	  * @return True if frame was processed
 	  */
 	 bool ProcessFrame();
 	 
+	 /**
+	  * Present the latest completed frame
+	  * 
+	  * Runs on the main thread. SDLRenderer::RenderFrame/Present and any vsync
+	  * wait happen here, off the emulation thread; frames completed while a
+	  * present was in progress are skipped rather than queued.
+	  * @return True if a new frame was presented
+	  */
+	 bool PresentLatestFrame();
+	 
 	 /**
 	  * Update emulation timing
 	  * @return Time until next frame in milliseconds
@@ -348,15 +348,18 @@
 	 uint8_t HandleRegisterRead(uint32_t address);
 	 
 	 /**
-	  * Register a Z80 port handler
+	  * Read from a sound chip port on the audio CPU bus
 	  * @param port Port number
-	  * @param readHandler Read handler function
-	  * @param writeHandler Write handler function
-	  * @return True if successful
+	  * @return Port value
+	  */
+	 uint8_t HandlePortRead(uint8_t port);
+	 
+	 /**
+	  * Write to a sound chip port on the audio CPU bus
+	  * @param port Port number
+	  * @param value Value to write
 	  */
-	 bool RegisterPortHandler(uint8_t port, 
-							 std::function<uint8_t()> readHandler,
-							 std::function<void(uint8_t)> writeHandler);
+	 void HandlePortWrite(uint8_t port, uint8_t value);
 	 
 	 /**
 	  * Update from sound RAM
@@ -447,9 +450,10 @@
 		 uint8_t qsoundControl;     // Q-Sound control register
 	 } m_registers;
 	 
-	 // Port handler mappings
-	 std::unordered_map<uint8_t, std::function<uint8_t()>> m_portReadHandlers;
-	 std::unordered_map<uint8_t, std::function<void(uint8_t)>> m_portWriteHandlers;
+	 /**
+	  * Bind the sound chip ports of this hardware variant on the audio CPU
+	  */
+	 void MapChipPorts();
 	 
 	 /**
 	  * Configure audio system for original NiXX-32 hardware
@@ -0,0 +1,108 @@
+/**
+ * EventScheduler.h
+ * Master clock event scheduler for NiXX-32 arcade board emulation
+ *
+ * This file defines the scheduler that orders timed hardware events (video
+ * timing, audio timers, CPU synchronization) on a single 64-bit cycle
+ * timeline. The CPUs run exactly up to the next pending event, so where an
+ * event lands depends only on emulated time, never on host timing.
+ */
+
+ #pragma once
+
+ #include <cstddef>
+ #include <cstdint>
+ #include <vector>
+
+ namespace NiXX32 {
+
+ /**
+  * Events on the master clock
+  *
+  * Events due at the same time are dispatched in this order.
+  */
+ enum class SchedulerEvent : uint8_t {
+	 SCANLINE,     // Start of a scanline
+	 VBLANK,       // Start of vertical blanking
+	 AUDIO_TIMER,  // Catch the audio CPU up, then step the audio chip timers
+	 COUNT
+ };
+
+ /**
+  * Binary heap of pending events keyed by master clock timestamp
+  *
+  * Each event type is pending at most once; scheduling it again moves it.
+  */
+ class EventScheduler {
+ public:
+	 // Timestamp returned when nothing is pending
+	 static constexpr uint64_t NEVER = UINT64_MAX;
+
+	 /**
+	  * Constructor
+	  */
+	 EventScheduler();
+
+	 /**
+	  * Schedule an event, replacing any pending occurrence of it
+	  * @param event Event to schedule
+	  * @param time Master clock timestamp it is due at
+	  */
+	 void Schedule(SchedulerEvent event, uint64_t time);
+
+	 /**
+	  * Drop the pending occurrence of an event
+	  * @param event Event to cancel
+	  */
+	 void Cancel(SchedulerEvent event);
+
+	 /**
+	  * Drop every pending event
+	  */
+	 void Clear();
+
+	 /**
+	  * Get the time an event is due at
+	  * @param event Event to look up
+	  * @return Its timestamp, or NEVER if it is not pending
+	  */
+	 uint64_t GetScheduledTime(SchedulerEvent event) const;
+
+	 /**
+	  * Get the time of the earliest pending event
+	  * @return Its timestamp, or NEVER if nothing is pending
+	  */
+	 uint64_t GetNextEventTime() const;
+
+	 /**
+	  * Remove the earliest event if it is due
+	  * @param now Current master clock timestamp
+	  * @param event Output parameter for the event
+	  * @param time Output parameter for the time it was due at
+	  * @return True if an event was due
+	  */
+	 bool PopDueEvent(uint64_t now, SchedulerEvent& event, uint64_t& time);
+
+ private:
+	 // One scheduled occurrence; superseded entries stay in the heap until they surface
+	 struct Entry {
+		 uint64_t time;        // Due time
+		 uint32_t generation;  // Matches m_generation[event] while current
+		 SchedulerEvent event; // Event type
+	 };
+
+	 // Min-heap on (time, event)
+	 std::vector<Entry> m_heap;
+
+	 // Current generation and due time of each event type
+	 uint32_t m_generation[static_cast<size_t>(SchedulerEvent::COUNT)];
+	 uint64_t m_scheduledTime[static_cast<size_t>(SchedulerEvent::COUNT)];
+
+	 // Heap ordering: true if a is due after b
+	 static bool Later(const Entry& a, const Entry& b);
+
+	 // Pop superseded entries off the top so the top is always current
+	 void DropStale();
+ };
+
+ } // namespace NiXX32
@@ -0,0 +1,127 @@
+/**
+ * HostProfiler.h
+ * Host time accounting for NiXX-32 arcade board emulation
+ *
+ * This file defines a lightweight profiler that splits the host time spent
+ * emulating between subsystems. Scopes nest, and time is only ever charged
+ * to the innermost one, so a Z80 catch-up started from a 68000 memory
+ * handler counts as audio CPU time rather than main CPU time.
+ */
+
+ #pragma once
+
+ #include <chrono>
+ #include <cstddef>
+ #include <cstdint>
+
+ namespace NiXX32 {
+
+ /**
+  * Subsystems host time is charged to
+  */
+ enum class ProfileCategory : uint8_t {
+	 SYSTEM,     // Event dispatch and glue outside any subsystem
+	 MAIN_CPU,   // 68000 execution, including memory and I/O handlers
+	 AUDIO_CPU,  // Z80 execution
+	 GRAPHICS,   // Graphics state updates and line/frame composition
+	 EFFECTS,    // Post-processing effects
+	 AUDIO,      // Audio chip stepping
+	 INPUT,      // Input polling
+	 COUNT
+ };
+
+ /**
+  * Accumulates host time per subsystem while enabled
+  */
+ class HostProfiler {
+ public:
+	 /**
+	  * Constructor
+	  */
+	 HostProfiler();
+
+	 /**
+	  * Enable or disable time accounting
+	  * @param enabled True to start charging time to scopes
+	  */
+	 void SetEnabled(bool enabled);
+
+	 /**
+	  * Check if time accounting is enabled
+	  * @return True if enabled
+	  */
+	 bool IsEnabled() const { return m_enabled; }
+
+	 /**
+	  * Clear the accumulated times
+	  */
+	 void Reset();
+
+	 /**
+	  * Get the host time charged to a subsystem
+	  * @param category Subsystem to look up
+	  * @return Time in seconds
+	  */
+	 double GetSeconds(ProfileCategory category) const;
+
+	 /**
+	  * Get the name of a subsystem as used in reports
+	  * @param category Subsystem to look up
+	  * @return Lower-case name
+	  */
+	 static const char* GetCategoryName(ProfileCategory category);
+
+ private:
+	 friend class ProfileScope;
+
+	 using Clock = std::chrono::steady_clock;
+
+	 // Accounting state
+	 bool m_enabled;
+	 int m_depth;                 // Open scopes; time outside all of them is not charged
+	 ProfileCategory m_current;   // Innermost open scope
+	 Clock::time_point m_mark;    // Time already charged up to
+
+	 // Accumulated time per category
+	 Clock::duration m_time[static_cast<size_t>(ProfileCategory::COUNT)];
+
+	 // Open a scope, returning the category it interrupts
+	 ProfileCategory Enter(ProfileCategory category);
+
+	 // Close a scope, resuming the interrupted category
+	 void Leave(ProfileCategory previous);
+
+	 // Charge the time since m_mark to the current category
+	 void Charge(Clock::time_point now);
+ };
+
+ /**
+  * Charges the host time spent in a block to one subsystem
+  *
+  * Costs a single branch while the profiler is disabled.
+  */
+ class ProfileScope {
+ public:
+	 ProfileScope(HostProfiler& profiler, ProfileCategory category)
+		 : m_profiler(profiler.IsEnabled() ? &profiler : nullptr),
+		   m_previous(ProfileCategory::SYSTEM) {
+		 if (m_profiler) {
+			 m_previous = m_profiler->Enter(category);
+		 }
+	 }
+
+	 ~ProfileScope() {
+		 if (m_profiler) {
+			 m_profiler->Leave(m_previous);
+		 }
+	 }
+
+	 ProfileScope(const ProfileScope&) = delete;
+	 ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+	 HostProfiler* m_profiler;    // Null while profiling is disabled
+	 ProfileCategory m_previous;  // Category resumed on exit
+ };
+
+ } // namespace NiXX32
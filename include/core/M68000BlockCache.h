@@ -0,0 +1,121 @@
+/**
+ * M68000BlockCache.h
+ * Block cache execution core for the NiXX-32 main CPU
+ *
+ * This file defines the optional 68000 core that keeps straight-line runs
+ * of already decoded instructions, keyed by their start address, and
+ * replays them without fetching or decoding each opcode again. Blocks are
+ * recorded while the interpreter executes them, so the cached core always
+ * runs exactly the handlers the interpreter would.
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <memory>
+ #include <unordered_map>
+ #include <vector>
+
+ namespace NiXX32 {
+
+ // Forward declarations
+ class M68000CPU;
+ class MemoryManager;
+ struct CachedBlock;
+
+ /**
+  * Cache of predecoded 68000 instruction blocks
+  */
+ class M68000BlockCache {
+ public:
+	 /**
+	  * Constructor
+	  * @param cpu CPU whose handlers and registers the blocks use
+	  * @param memoryManager Memory manager to watch for writes to cached code
+	  */
+	 M68000BlockCache(M68000CPU& cpu, MemoryManager& memoryManager);
+
+	 /**
+	  * Destructor
+	  */
+	 ~M68000BlockCache();
+
+	 /**
+	  * Execute the block at the current PC, recording it first if needed
+	  *
+	  * Stops early when the cycle budget runs out, an exit is requested or
+	  * an instruction leaves the block, always at an instruction boundary.
+	  * @param cycles Cycle budget
+	  * @return Number of cycles executed
+	  */
+	 int ExecuteBlock(int cycles);
+
+	 /**
+	  * Make the running block stop after the current instruction
+	  */
+	 void RequestExit() { m_exitRequested = true; }
+
+	 /**
+	  * Clear a pending exit request (done at every block boundary)
+	  */
+	 void ClearExitRequest() { m_exitRequested = false; }
+
+	 /**
+	  * Note that the current instruction raised an exception
+	  */
+	 void NotifyException() { m_exitRequested = true; m_faulted = true; }
+
+	 /**
+	  * Drop every block that overlaps a range of memory
+	  * @param address Start address
+	  * @param size Size in bytes
+	  */
+	 void Invalidate(uint32_t address, uint32_t size);
+
+	 /**
+	  * Drop every block
+	  */
+	 void Flush();
+
+ private:
+	 // Reference to the CPU
+	 M68000CPU& m_cpu;
+
+	 // Reference to memory manager
+	 MemoryManager& m_memoryManager;
+
+	 // Blocks by start address
+	 std::unordered_map<uint32_t, std::unique_ptr<CachedBlock>> m_blocks;
+
+	 // Direct-mapped cache of recent lookups in m_blocks
+	 std::vector<CachedBlock*> m_lookup;
+
+	 // Start addresses of the blocks touching each memory page
+	 std::vector<std::vector<uint32_t>> m_pageBlocks;
+
+	 // Invalidated blocks, kept until no block is running
+	 std::vector<std::unique_ptr<CachedBlock>> m_retiredBlocks;
+
+	 // Set when the running block must stop after the current instruction
+	 bool m_exitRequested;
+
+	 // Set when the current instruction raised an exception
+	 bool m_faulted;
+
+	 // Set when code is written while a block is being recorded
+	 bool m_recordingInvalidated;
+
+	 // Find the block starting at an address, or null
+	 CachedBlock* FindBlock(uint32_t address);
+
+	 // Replay a cached block
+	 int Run(const CachedBlock& block, int cycles);
+
+	 // Execute through the interpreter, recording the instructions as a new block
+	 int Record(int cycles);
+
+	 // Code write listener registered with the memory manager
+	 static void OnCodeWritten(void* context, uint32_t address, uint32_t size);
+ };
+
+ } // namespace NiXX32
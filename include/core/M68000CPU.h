@@ -14,6 +14,7 @@
  #include <string>
  #include <functional>
  #include <memory>
+ #include <unordered_map>
  
  namespace NiXX32 {
  
@@ -21,6 +22,8 @@
  class System;
  class MemoryManager;
  class Logger;
+ class M68000BlockCache;
+ struct M68000Ops;
  
  /**
   * Defines the possible CPU execution states
@@ -112,6 +115,14 @@
 	 IPL_7 = 7  // Non-maskable
  };
  
+ /**
+  * Execution cores for the 68000
+  */
+ enum class M68000Core {
+	 INTERPRETER,  // One instruction at a time (reference core)
+	 BLOCK_CACHE   // Cached straight-line blocks of predecoded instructions
+ };
+ 
  /**
   * Class for emulating the Motorola 68000 CPU
   */
@@ -168,6 +179,19 @@
 	  */
 	 void SetInterruptLevel(InterruptLevel level);
 	 
+	 /**
+	  * Check if the CPU is stopped with no interrupt able to wake it
+	  * @return True if executing would only idle
+	  */
+	 bool IsWaitingForInterrupt() const;
+	 
+	 /**
+	  * Let a stopped CPU sit out a number of cycles in one step
+	  * @param cycles Number of cycles to idle
+	  * @return Number of cycles used (a whole number of idle bus cycles)
+	  */
+	 int SkipHaltedCycles(int cycles);
+	 
 	 /**
 	  * Get the current CPU state
 	  * @return Current CPU state
@@ -260,10 +284,19 @@
 	 
 	 /**
 	  * Get the current cycle count
-	  * @return Total cycles executed since reset
+	  * @return Total cycles executed since reset, including the current run
 	  */
 	 uint64_t GetCycleCount() const;
 	 
+	 /**
+	  * Charge cycles taken by another bus master (e.g. DMA) to the CPU
+	  * 
+	  * The cycles are added to the instruction currently executing, so the
+	  * CPU falls behind by the time it was held off the bus.
+	  * @param cycles Number of cycles stolen
+	  */
+	 void StealCycles(int cycles);
+	 
 	 /**
 	  * Get the CPU clock speed
 	  * @return Clock speed in MHz
@@ -297,6 +330,34 @@
 	  * @return True if hook was removed successfully
 	  */
 	 bool RemoveHook(uint32_t address);
+	 
+	 /**
+	  * Select the execution core
+	  * 
+	  * Both cores produce the same results; the block cache skips the
+	  * per-instruction fetch and decode for code it has already seen.
+	  * Builds with memory access statistics always use the interpreter, as
+	  * cached instructions are never fetched through MemoryManager.
+	  * @param core Core to use from the next Execute call
+	  */
+	 void SetCore(M68000Core core);
+	 
+	 /**
+	  * Get the execution core in use
+	  * @return Current core
+	  */
+	 M68000Core GetCore() const;
+	 
+	 /**
+	  * Enable or disable idle loop skipping
+	  * 
+	  * When enabled, short polling loops that only read memory (such as
+	  * waiting for a VBLANK flag) are detected at their backward branch and
+	  * the rest of the timeslice is charged in whole loop iterations
+	  * instead of being interpreted.
+	  * @param enabled True to skip idle loops
+	  */
+	 void SetIdleLoopSkipping(bool enabled);
  
  private:
 	 // Reference to parent system
@@ -317,39 +378,135 @@
 	 // Current interrupt level
 	 InterruptLevel m_interruptLevel;
 	 
+	 // Set when the interrupt level changes or the SR mask is lowered;
+	 // interrupts are only checked while this is set
+	 bool m_attention;
+	 
 	 // Clock speed in MHz
 	 uint32_t m_clockSpeed;
 	 
 	 // Total cycle count since reset
 	 uint64_t m_cycleCount;
 	 
-	 // Pending cycles for current instruction
+	 // Cycles of the current run not yet added to m_cycleCount
 	 int m_pendingCycles;
 	 
 	 // Instruction hook map
 	 std::unordered_map<uint32_t, std::function<void()>> m_hooks;
 	 
+	 // Hook presence, one bit per instruction word (allocated with the first hook)
+	 std::vector<uint64_t> m_hookBitmap;
+	 
+	 // False while no hooks are registered, so the bitmap is never touched
+	 bool m_hasHooks;
+	 
+	 // Check if an address may have a hook (exact check is in m_hooks)
+	 bool HasHook(uint32_t address) const {
+		 uint32_t word = (address & 0x00FFFFFF) >> 1;  // 24-bit address bus
+		 return m_hasHooks && ((m_hookBitmap[word >> 6] >> (word & 63)) & 1) != 0;
+	 }
+	 
+	 // Run the hook at the current PC, if there is one
+	 void CallHook();
+	 
+	 // True to fast-forward through idle polling loops
+	 bool m_idleLoopSkipping;
+	 
+	 /**
+	  * Polling loop being timed before it is skipped
+	  */
+	 struct IdleLoop {
+		 uint32_t branchAddress;  // Address of the backward branch (odd if none)
+		 uint64_t cycleCount;     // Cycle count when the branch was last taken
+		 int iterationCycles;     // Cycles for one pass through the body
+	 };
+	 IdleLoop m_idleLoop;
+	 
+	 // Backward branches of loops that do real work (direct-mapped, odd if empty)
+	 uint32_t m_busyLoops[64];
+	 
+	 // Execute instructions up to the next branch, SR write or interrupt
+	 // change, return cycles used
+	 int ExecuteRun(int cycles);
+	 
+	 // Skip whole iterations of the idle loop just branched to, return cycles skipped
+	 int SkipIdleLoop(int cycles);
+	 
+	 // Run the iterations of a DBRA copy or fill loop that fit in the budget
+	 // as one bulk transfer, return cycles used
+	 int SkipCopyLoop(int cycles);
+	 
+	 // Cycles per iteration if a loop body only reads memory and recomputes what it writes, else 0
+	 int IdleLoopCycles(uint32_t start, uint32_t branchAddress);
+	 
 	 // Prefetch queue management
 	 void RefillPrefetchQueue();
 	 uint16_t FetchNextInstruction();
 	 
-	 // Instruction execution helpers
-	 void ExecuteGroup0(uint16_t opcode);
-	 void ExecuteGroup1(uint16_t opcode);
-	 void ExecuteGroup2(uint16_t opcode);
-	 void ExecuteGroup3(uint16_t opcode);
-	 void ExecuteGroup4(uint16_t opcode);
-	 void ExecuteGroup5(uint16_t opcode);
-	 void ExecuteGroup6(uint16_t opcode);
-	 void ExecuteGroup7(uint16_t opcode);
-	 void ExecuteGroup8(uint16_t opcode);
-	 void ExecuteGroup9(uint16_t opcode);
-	 void ExecuteGroupA(uint16_t opcode);
-	 void ExecuteGroupB(uint16_t opcode);
-	 void ExecuteGroupC(uint16_t opcode);
-	 void ExecuteGroupD(uint16_t opcode);
-	 void ExecuteGroupE(uint16_t opcode);
-	 void ExecuteGroupF(uint16_t opcode);
+	 /**
+	  * Handler for one opcode, specialised on operand size and addressing modes
+	  */
+	 using OpcodeHandler = void (*)(M68000CPU& cpu, uint16_t opcode);
+	 
+	 /**
+	  * Entry in the predecoded opcode table
+	  */
+	 struct OpcodeEntry {
+		 OpcodeHandler handler;  // Handler for this opcode
+		 uint8_t cycles;         // Base cycles, including effective address time
+		 uint8_t flags;          // OPCODE_* block cache flags
+	 };
+	 
+	 // Opcode may change the PC or unmask interrupts, so it ends a cached block
+	 static constexpr uint8_t OPCODE_ENDS_BLOCK = 0x01;
+	 
+	 // Opcode is rare or stops the CPU, so it is never put in a cached block
+	 static constexpr uint8_t OPCODE_INTERPRETED = 0x02;
+	 
+	 // Predecoded handlers for all 65536 opcodes, shared by every instance
+	 static OpcodeEntry s_opcodeTable[0x10000];
+	 
+	 // Decode every opcode into s_opcodeTable (done once per process)
+	 static void BuildOpcodeTable();
+	 
+	 // Opcode handlers need direct register and bus access
+	 friend struct M68000Ops;
+	 
+	 // The block cache runs handlers directly
+	 friend class M68000BlockCache;
+	 
+	 // Block cache core (null when interpreting)
+	 std::unique_ptr<M68000BlockCache> m_blockCache;
+	 
+	 // Address of the instruction being executed (stacked by illegal/privilege exceptions)
+	 uint32_t m_instructionAddress;
+	 
+	 /**
+	  * Kind of operation a lazy flag record describes
+	  */
+	 enum class FlagsOp : uint8_t {
+		 NONE,   // No record; the SR bits are current
+		 ADD,    // result = dst + src (+ X)
+		 SUB,    // result = dst - src (- X)
+		 LOGIC   // N and Z from result, V and C cleared
+	 };
+	 
+	 /**
+	  * Operands of the last flag-setting operation, kept until the flags are read
+	  */
+	 struct LazyFlags {
+		 uint32_t src;     // Source operand
+		 uint32_t dst;     // Destination operand
+		 uint32_t result;  // Result
+		 uint16_t size;    // Operand size in bytes
+		 FlagsOp op;       // Operation that produced the result
+	 };
+	 
+	 // Pending source of N, Z, V and C
+	 LazyFlags m_flags;
+	 
+	 // Pending source of X (the last ADD/SUB; logic ops and CMP leave X alone)
+	 LazyFlags m_extendFlags;
 	 
 	 // Stack operations
 	 void PushLong(uint32_t value);
@@ -366,8 +523,17 @@
 	 // Process pending interrupts
 	 bool CheckPendingInterrupts();
 	 
-	 // Calculate condition code based on instruction results
+	 // Check if the pending interrupt level is above the SR mask (or is NMI)
+	 bool IsInterruptAccepted() const;
+	 
+	 // Record an ADD/SUB result; X, N, Z, V and C are computed only when read
 	 void UpdateConditionCodes(uint32_t src, uint32_t dst, uint32_t result, uint16_t size, bool isAdd);
+	 
+	 // Compute N, Z, V and C from the pending flag record (or the SR if none)
+	 uint16_t ComputeConditionCodes() const;
+	 
+	 // Fold any pending flag records into the SR
+	 void MaterializeFlags();
  };
  
  } // namespace NiXX32
\ No newline at end of file
@@ -0,0 +1,128 @@
+/**
+ * MemoryAccessStats.h
+ * Memory access statistics for NiXX-32 arcade board emulation
+ *
+ * This file defines the optional access counters used to find out which
+ * pages and I/O registers a game uses the most. Counting is selected at
+ * compile time with NIXX32_MEMORY_STATS; without it the counters are an
+ * empty specialization and the memory access paths compile to the same
+ * code as before.
+ */
+
+ #pragma once
+
+ #include <algorithm>
+ #include <cstdint>
+ #include <map>
+ #include <vector>
+
+ namespace NiXX32 {
+
+ #if defined(NIXX32_MEMORY_STATS)
+ constexpr bool MEMORY_STATS_ENABLED = true;
+ #else
+ constexpr bool MEMORY_STATS_ENABLED = false;
+ #endif
+
+ /**
+  * Read and write counts for a page or register
+  */
+ struct MemoryAccessCounts {
+	 uint64_t reads = 0;     // Number of reads
+	 uint64_t writes = 0;    // Number of writes
+ };
+
+ /**
+  * Export formats for access statistics
+  */
+ enum class MemoryStatsFormat {
+	 CSV,     // One row per page/register
+	 JSON     // Object with "pages" and "ioRegisters" arrays
+ };
+
+ /**
+  * Access counters per page and per I/O register
+  * @tparam Enabled True to count, false for a no-op implementation
+  */
+ template <bool Enabled>
+ class MemoryAccessStats {
+ public:
+	 /**
+	  * Constructor
+	  * @param pageCount Number of pages in the address space
+	  */
+	 explicit MemoryAccessStats(uint32_t pageCount) : m_pages(pageCount) {}
+
+	 /**
+	  * Check if counting is compiled in
+	  * @return True if accesses are counted
+	  */
+	 static constexpr bool IsEnabled() { return true; }
+
+	 void RecordPageRead(uint32_t page) { m_pages[page].reads++; }
+	 void RecordPageWrite(uint32_t page) { m_pages[page].writes++; }
+	 void RecordIORead(uint32_t address) { m_ioRegisters[address].reads++; }
+	 void RecordIOWrite(uint32_t address) { m_ioRegisters[address].writes++; }
+
+	 /**
+	  * Clear all counters
+	  */
+	 void Reset() {
+		 std::fill(m_pages.begin(), m_pages.end(), MemoryAccessCounts{});
+		 m_ioRegisters.clear();
+	 }
+
+	 /**
+	  * Get the counters for a page
+	  * @param page Page number
+	  * @return Access counts for the page
+	  */
+	 MemoryAccessCounts GetPageCounts(uint32_t page) const {
+		 return page < m_pages.size() ? m_pages[page] : MemoryAccessCounts{};
+	 }
+
+	 /**
+	  * Get the number of pages tracked
+	  * @return Page count
+	  */
+	 uint32_t GetPageCount() const { return static_cast<uint32_t>(m_pages.size()); }
+
+	 /**
+	  * Get the counters for every I/O register that was accessed
+	  * @return Map of register address to access counts, in address order
+	  */
+	 const std::map<uint32_t, MemoryAccessCounts>& GetIORegisterCounts() const { return m_ioRegisters; }
+
+ private:
+	 std::vector<MemoryAccessCounts> m_pages;
+	 std::map<uint32_t, MemoryAccessCounts> m_ioRegisters;
+ };
+
+ /**
+  * Disabled counters, every call compiles away
+  */
+ template <>
+ class MemoryAccessStats<false> {
+ public:
+	 explicit MemoryAccessStats(uint32_t) {}
+
+	 static constexpr bool IsEnabled() { return false; }
+
+	 void RecordPageRead(uint32_t) {}
+	 void RecordPageWrite(uint32_t) {}
+	 void RecordIORead(uint32_t) {}
+	 void RecordIOWrite(uint32_t) {}
+
+	 void Reset() {}
+
+	 MemoryAccessCounts GetPageCounts(uint32_t) const { return {}; }
+
+	 uint32_t GetPageCount() const { return 0; }
+
+	 const std::map<uint32_t, MemoryAccessCounts>& GetIORegisterCounts() const {
+		 static const std::map<uint32_t, MemoryAccessCounts> empty;
+		 return empty;
+	 }
+ };
+
+ } // namespace NiXX32
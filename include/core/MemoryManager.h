@@ -17,6 +17,7 @@
  #include <functional>
  
  #include "Logger.h"
+ #include "MemoryAccessStats.h"
  
  namespace NiXX32 {
  
@@ -24,6 +25,18 @@
  class System;
  enum class HardwareVariant;
  
+ /**
+  * XOR applied to byte addresses inside word-swapped storage
+  * 
+  * Regions stored as host-order 16-bit words keep the two bytes of each
+  * 68000 word swapped on little-endian hosts, so byte N lives at N ^ 1.
+  */
+ #if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+ constexpr uint32_t HOST_BYTE_XOR = 0;
+ #else
+ constexpr uint32_t HOST_BYTE_XOR = 1;
+ #endif
+ 
  /**
   * Memory access permissions
   */
@@ -46,6 +59,76 @@
 	 EXPANSION       // Expansion or custom hardware memory
  };
  
+ /**
+  * Backing store for a memory region
+  * 
+  * Normally owns a zero-initialised heap buffer. It can instead be backed by
+  * a private mapping of a file, so loading copies nothing and untouched pages
+  * are shared with the OS page cache and with any other process mapping the
+  * same file. A write to a mapped page only copies that page.
+  */
+ class MemoryBuffer {
+ public:
+	 MemoryBuffer() = default;
+	 ~MemoryBuffer();
+	 
+	 MemoryBuffer(MemoryBuffer&& other) noexcept;
+	 MemoryBuffer& operator=(MemoryBuffer&& other) noexcept;
+	 MemoryBuffer(const MemoryBuffer&) = delete;
+	 MemoryBuffer& operator=(const MemoryBuffer&) = delete;
+	 
+	 /**
+	  * Replace the contents with an owned buffer filled with a value
+	  * @param size Buffer size in bytes
+	  * @param value Fill value
+	  */
+	 void assign(size_t size, uint8_t value);
+	 
+	 /**
+	  * Map a file into the buffer
+	  * 
+	  * Existing contents outside the mapped file are preserved. Not supported
+	  * on every platform, callers fall back to copying the file.
+	  * @param path File to map
+	  * @param offset Offset in the buffer to place the file at (host page aligned)
+	  * @param size Total buffer size, or 0 to size the buffer to the file
+	  * @return True if the file was mapped
+	  */
+	 bool MapFile(const std::string& path, size_t offset = 0, size_t size = 0);
+	 
+	 /**
+	  * Check if the buffer is backed by a file mapping
+	  * @return True if mapped
+	  */
+	 bool IsMapped() const { return m_mapped; }
+	 
+	 uint8_t* data() { return m_data; }
+	 const uint8_t* data() const { return m_data; }
+	 size_t size() const { return m_size; }
+	 uint8_t* begin() { return m_data; }
+	 uint8_t* end() { return m_data + m_size; }
+	 const uint8_t* begin() const { return m_data; }
+	 const uint8_t* end() const { return m_data + m_size; }
+	 uint8_t& operator[](size_t index) { return m_data[index]; }
+	 const uint8_t& operator[](size_t index) const { return m_data[index]; }
+ 
+ private:
+	 // Owned storage when not mapped
+	 std::vector<uint8_t> m_storage;
+	 
+	 // Start and size of the active storage (owned or mapped)
+	 uint8_t* m_data = nullptr;
+	 size_t m_size = 0;
+	 
+	 // Backed by a mapping rather than m_storage
+	 bool m_mapped = false;
+	 
+	 /**
+	  * Release the current storage
+	  */
+	 void Release();
+ };
+ 
  /**
   * Defines a memory region in the system
   */
@@ -55,7 +138,9 @@
 	 uint32_t size;                 // Size of the region in bytes
 	 MemoryAccess access;           // Access permissions
 	 MemoryRegionType type;         // Type of memory region
-	 std::vector<uint8_t> data;     // Actual memory data
+	 MemoryBuffer data;             // Actual memory data
+	 bool wordSwapped = false;      // Data held as host-order 16-bit words
+	 bool onMainBus = true;         // Mapped into the 68000 page table
 	 
 	 // Optional handlers for memory-mapped I/O
 	 std::function<uint8_t(uint32_t)> readHandler8;       // 8-bit read handler
@@ -66,6 +151,81 @@
 	 bool hasHandlers() const {
 		 return readHandler8 || readHandler16 || writeHandler8 || writeHandler16;
 	 }
+	 
+	 // Index into data for a region-relative byte offset
+	 uint32_t ByteIndex(uint32_t offset) const {
+		 return wordSwapped ? (offset ^ HOST_BYTE_XOR) : offset;
+	 }
+ };
+ 
+ /**
+  * Page table entry covering one page of the 68000 address space
+  * 
+  * Plain RAM/ROM pages carry direct host pointers so that an access is
+  * resolved with one shift and one load. Pages that belong to a region
+  * with I/O handlers (or that are only partially covered by a region)
+  * leave the pointers null and are resolved through the region index.
+  */
+ struct MemoryPage {
+	 uint8_t* readPointer;      // Host pointer for direct reads, or nullptr
+	 uint8_t* writePointer;     // Host pointer for direct writes, or nullptr
+	 int regionIndex;           // Index of the owning region, or -1 if unmapped
+	 uint16_t ioHandlerIndex;   // Index into the I/O dispatch table, 0 if none
+	 uint32_t byteXor;          // HOST_BYTE_XOR for word-swapped pages, 0 otherwise
+	 bool trackDirty;           // Writes mark the VIDEO_RAM dirty bitmap
+	 uint8_t* protectedWritePointer; // Direct write pointer held back until the first write after a snapshot
+ };
+ 
+ /**
+  * Page of memory contents captured by a snapshot
+  */
+ using SnapshotPage = std::vector<uint8_t>;
+ 
+ /**
+  * Snapshot of all writable memory regions
+  * 
+  * Contents are held as reference-counted pages. A page that did not change
+  * between two snapshots is shared by both instead of being copied again.
+  */
+ struct MemorySnapshot {
+	 struct Region {
+		 std::string name;          // Name of the captured region
+		 uint32_t startAddress;     // Start address of the region
+		 uint32_t size;             // Size of the region in bytes
+		 bool wordSwapped;          // Storage layout the pages were captured in
+		 std::vector<std::shared_ptr<const SnapshotPage>> pages;
+	 };
+	 
+	 std::vector<Region> regions;
+ };
+ 
+ /**
+  * Entry in the I/O dispatch table
+  * 
+  * Binds a device to plain function pointers that forward to its typed
+  * register handlers, so an I/O access is one indirect call without the
+  * type erasure of std::function.
+  */
+ struct IOHandler {
+	 std::string name;          // Name of the I/O window for debugging
+	 uint32_t startAddress;     // Start address of the I/O window
+	 uint32_t size;             // Size of the I/O window in bytes
+	 void* context;             // Device instance passed to the handlers
+	 uint8_t (*read8)(void* context, uint32_t address);
+	 uint16_t (*read16)(void* context, uint32_t address);
+	 void (*write8)(void* context, uint32_t address, uint8_t value);
+	 void (*write16)(void* context, uint32_t address, uint16_t value);
+ };
+ 
+ /**
+  * Extracts the value type from a device register write handler
+  */
+ template <typename Method>
+ struct IOWriteMethodTraits;
+ 
+ template <typename Device, typename Value>
+ struct IOWriteMethodTraits<void (Device::*)(uint32_t, Value)> {
+	 using ValueType = Value;
  };
  
  /**
@@ -73,6 +233,20 @@
   */
  class MemoryManager {
  public:
+	 // Page table geometry (24-bit address space split into 4KB pages)
+	 static constexpr uint32_t ADDRESS_MASK = 0x00FFFFFF;
+	 static constexpr uint32_t PAGE_SHIFT = 12;
+	 static constexpr uint32_t PAGE_SIZE = 1u << PAGE_SHIFT;
+	 static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+	 static constexpr uint32_t PAGE_COUNT = (ADDRESS_MASK + 1) >> PAGE_SHIFT;
+	 
+	 // VIDEO_RAM dirty tracking granularity (256-byte blocks)
+	 static constexpr uint32_t VRAM_DIRTY_SHIFT = 8;
+	 static constexpr uint32_t VRAM_DIRTY_BLOCK_SIZE = 1u << VRAM_DIRTY_SHIFT;
+	 
+	 // Callback for writes to pages holding translated code
+	 using CodeWriteListener = void (*)(void* context, uint32_t address, uint32_t size);
+	 
 	 /**
 	  * Constructor
 	  * @param system Reference to the parent system
@@ -147,18 +321,43 @@
 	  */
 	 bool LoadROM(const std::vector<uint8_t>& romData, uint32_t baseAddress);
 	 
+	 /**
+	  * Load ROM data into memory
+	  * @param romData Pointer to ROM data
+	  * @param size Size of ROM data in bytes
+	  * @param baseAddress Address to load the ROM at
+	  * @return True if ROM was loaded successfully
+	  */
+	 bool LoadROM(const uint8_t* romData, size_t size, uint32_t baseAddress);
+	 
+	 /**
+	  * Load a ROM file by mapping it into its region instead of copying it
+	  * 
+	  * Only uncompressed files can be mapped, and only into a region using
+	  * big-endian storage at a host page aligned offset.
+	  * @param path Path of the ROM file
+	  * @param baseAddress Address to load the ROM at
+	  * @return True if the file was mapped, false if the caller should use LoadROM
+	  */
+	 bool MapROMFile(const std::string& path, uint32_t baseAddress);
+	 
 	 /**
 	  * Define a new memory region
+	  * 
+	  * A region off the main bus belongs to another CPU, which maps its data
+	  * into its own page table. It keeps an address here only for Peek/Poke,
+	  * ROM loading and snapshots; the 68000 sees nothing there.
 	  * @param name Name of the region for debugging
 	  * @param startAddress Start address in the address space
 	  * @param size Size of the region in bytes
 	  * @param access Access permissions
 	  * @param type Type of memory region
+	  * @param onMainBus False to keep the region out of the 68000 page table
 	  * @return Pointer to the created region, or nullptr if failed
 	  */
 	 MemoryRegion* DefineRegion(const std::string& name, uint32_t startAddress, 
 								 uint32_t size, MemoryAccess access, 
-								 MemoryRegionType type);
+								 MemoryRegionType type, bool onMainBus = true);
 	 
 	 /**
 	  * Get a memory region by address
@@ -196,14 +395,265 @@
 						   std::function<void(uint32_t, uint8_t)> handler8,
 						   std::function<void(uint32_t, uint16_t)> handler16);
 	 
+	 /**
+	  * Bind a device's register handlers to an I/O window
+	  * 
+	  * Usage: MapIOHandlers<&Device::HandleRegisterRead, &Device::HandleRegisterWrite>(...)
+	  * Handlers are bound per page, so every access to a page touched by the
+	  * window is routed to the device, which decodes its own registers.
+	  * @param name Name of the I/O window for debugging
+	  * @param startAddress Start address of the window
+	  * @param size Size of the window in bytes
+	  * @param device Device that owns the register handlers
+	  * @return True if the handlers were bound successfully
+	  */
+	 template <auto ReadMethod, auto WriteMethod, typename Device>
+	 bool MapIOHandlers(const std::string& name, uint32_t startAddress, uint32_t size, Device& device) {
+		 IOHandler handler;
+		 handler.name = name;
+		 handler.startAddress = startAddress;
+		 handler.size = size;
+		 handler.context = &device;
+		 handler.read8 = &IOReadThunk<uint8_t, ReadMethod, Device>;
+		 handler.read16 = &IOReadThunk<uint16_t, ReadMethod, Device>;
+		 handler.write8 = &IOWriteThunk<uint8_t, WriteMethod, Device>;
+		 handler.write16 = &IOWriteThunk<uint16_t, WriteMethod, Device>;
+		 return AddIOHandler(handler);
+	 }
+	 
+	 /**
+	  * Bind separate byte and word handlers to an I/O window
+	  * 
+	  * Usage: MapIOHandlers<&Device::Read8, &Device::Read16, &Device::Write8, &Device::Write16>(...)
+	  * For windows that behave like memory, where a word access is not two
+	  * byte accesses to the same register.
+	  * @param name Name of the I/O window for debugging
+	  * @param startAddress Start address of the window
+	  * @param size Size of the window in bytes
+	  * @param device Device that owns the handlers
+	  * @return True if the handlers were bound successfully
+	  */
+	 template <auto Read8Method, auto Read16Method, auto Write8Method, auto Write16Method, typename Device>
+	 bool MapIOHandlers(const std::string& name, uint32_t startAddress, uint32_t size, Device& device) {
+		 IOHandler handler;
+		 handler.name = name;
+		 handler.startAddress = startAddress;
+		 handler.size = size;
+		 handler.context = &device;
+		 handler.read8 = &IOReadThunk<uint8_t, Read8Method, Device>;
+		 handler.read16 = &IOReadThunk<uint16_t, Read16Method, Device>;
+		 handler.write8 = &IOWriteThunk<uint8_t, Write8Method, Device>;
+		 handler.write16 = &IOWriteThunk<uint16_t, Write16Method, Device>;
+		 return AddIOHandler(handler);
+	 }
+	 
 	 /**
 	  * Get direct pointer to memory at specified address
+	  * 
+	  * In word-swapped regions the address must be even and byte N of the
+	  * block is found at pointer[N ^ GetByteAddressXor(address)]. Writes made
+	  * through the pointer must be reported with MarkWritten().
 	  * @param address Memory address
 	  * @param size Size of requested memory block
 	  * @return Pointer to memory, or nullptr if invalid
 	  */
 	 uint8_t* GetDirectPointer(uint32_t address, uint32_t size);
 	 
+	 /**
+	  * Get the XOR to apply to byte offsets within a direct pointer
+	  * @param address Memory address
+	  * @return HOST_BYTE_XOR if the address is in word-swapped storage, 0 otherwise
+	  */
+	 uint32_t GetByteAddressXor(uint32_t address);
+	 
+	 /**
+	  * Check if a range is plain memory that the CPU accesses directly
+	  * 
+	  * True when every page of the range belongs to one region and has no
+	  * I/O handlers, so a bulk transfer through GetDirectPointer() followed
+	  * by MarkWritten() matches the individual bus accesses. Always false
+	  * while access statistics are compiled in, as bulk transfers are not
+	  * counted.
+	  * @param address Start address
+	  * @param size Size of the range in bytes
+	  * @param writable True if the range must also be writable
+	  * @return True if the whole range is plain memory
+	  */
+	 bool IsPlainMemory(uint32_t address, uint32_t size, bool writable) const;
+	 
+	 /**
+	  * Enable host-endian 16-bit word storage for ROM, MAIN_RAM and VIDEO_RAM
+	  * 
+	  * Aligned word and long accesses become native loads and byte accesses
+	  * stay correct through HOST_BYTE_XOR. Existing contents are converted.
+	  * @param enabled True to store eligible regions as host-order words
+	  */
+	 void SetHostEndianStorage(bool enabled);
+	 
+	 /**
+	  * Check if host-endian word storage is enabled
+	  * @return True if enabled
+	  */
+	 bool IsHostEndianStorageEnabled() const;
+	 
+	 /**
+	  * Read a byte for debugging, bypassing handlers and access permissions
+	  * @param address Memory address
+	  * @return Byte value, or 0xFF if unmapped
+	  */
+	 uint8_t Peek8(uint32_t address);
+	 
+	 /**
+	  * Write a byte for debugging, bypassing handlers and access permissions
+	  * @param address Memory address
+	  * @param value Byte value to write
+	  * @return True if the address is backed by memory
+	  */
+	 bool Poke8(uint32_t address, uint8_t value);
+	 
+	 /**
+	  * Report memory changed without going through Write8/16/32
+	  * 
+	  * Keeps snapshot and VIDEO_RAM dirty tracking correct after writes through
+	  * a direct pointer or by another bus master.
+	  * @param address Start address of the range
+	  * @param size Size of the range in bytes
+	  */
+	 void MarkWritten(uint32_t address, uint32_t size);
+	 
+	 /**
+	  * Watch a page that translated CPU code was taken from
+	  * 
+	  * The page's direct write pointer is held back, so the next write of any
+	  * kind reports the whole page to the code write listener and ends the
+	  * watch. Rebuilding the page table reports the whole address space.
+	  * @param address Any address in the page
+	  * @return True if the page is plain memory, false if code there cannot be cached
+	  */
+	 bool WatchCodePage(uint32_t address);
+	 
+	 /**
+	  * Set the callback for writes to watched code pages
+	  * @param listener Function to call, or nullptr to remove it
+	  * @param context Value passed back to the listener
+	  */
+	 void SetCodeWriteListener(CodeWriteListener listener, void* context);
+	 
+	 /**
+	  * Capture the contents of all writable memory regions
+	  * 
+	  * Only pages written since the previous snapshot are copied, the rest are
+	  * shared with it. After the snapshot the pages are write-protected in the
+	  * page table, so the first write to each one takes the slow path once to
+	  * mark it dirty and later writes are direct again.
+	  * Regions off the main bus have no write tracking; their pages are
+	  * compared with the previous snapshot instead.
+	  * @return Snapshot of the writable regions
+	  */
+	 std::shared_ptr<const MemorySnapshot> TakeSnapshot();
+	 
+	 /**
+	  * Restore memory contents from a snapshot
+	  * 
+	  * Pages that still hold the snapshot's contents are skipped.
+	  * @param snapshot Snapshot taken from this memory map
+	  * @return True if the snapshot matched the memory map and was restored
+	  */
+	 bool RestoreSnapshot(const MemorySnapshot& snapshot);
+	 
+	 /**
+	  * Check if any VIDEO_RAM block overlapping a range was written
+	  * 
+	  * Every write to VIDEO_RAM (CPU, DMA or debugger) marks its 256-byte
+	  * block dirty, so graphics code only needs to re-decode tiles, sprites
+	  * and palette entries whose blocks are dirty.
+	  * @param address Start address of the range
+	  * @param size Size of the range in bytes
+	  * @return True if any block in the range is dirty
+	  */
+	 bool IsVideoRamDirty(uint32_t address, uint32_t size) const;
+	 
+	 /**
+	  * Check if any VIDEO_RAM block was written since the last clear
+	  * @return True if any block is dirty
+	  */
+	 bool IsAnyVideoRamDirty() const;
+	 
+	 /**
+	  * Get the addresses of all dirty VIDEO_RAM blocks
+	  * @return Start address of each dirty block, in ascending order
+	  */
+	 std::vector<uint32_t> GetDirtyVideoRamBlocks() const;
+	 
+	 /**
+	  * Mark a VIDEO_RAM range dirty, e.g. after writing through a direct pointer
+	  * @param address Start address of the range
+	  * @param size Size of the range in bytes
+	  */
+	 void MarkVideoRamDirty(uint32_t address, uint32_t size);
+	 
+	 /**
+	  * Clear the dirty state of a VIDEO_RAM range
+	  * @param address Start address of the range
+	  * @param size Size of the range in bytes
+	  */
+	 void ClearVideoRamDirty(uint32_t address, uint32_t size);
+	 
+	 /**
+	  * Clear the dirty state of all of VIDEO_RAM
+	  */
+	 void ClearVideoRamDirty();
+	 
+	 /**
+	  * Get the memory access counters
+	  * 
+	  * Counters are only collected in builds with NIXX32_MEMORY_STATS defined,
+	  * otherwise every count reads as zero.
+	  * @return Access counters per page and per I/O register
+	  */
+	 const MemoryAccessStats<MEMORY_STATS_ENABLED>& GetAccessStats() const;
+	 
+	 /**
+	  * Clear the memory access counters
+	  */
+	 void ResetAccessStats();
+	 
+	 /**
+	  * Export the memory access counters to a file
+	  * @param filePath Output file path
+	  * @param format Output format
+	  * @return True if the counters were written
+	  */
+	 bool ExportAccessStats(const std::string& filePath, MemoryStatsFormat format);
+	 
+	 /**
+	  * Run a DMA block transfer
+	  * 
+	  * Supports ROM->VIDEO_RAM, MAIN_RAM->VIDEO_RAM and MAIN_RAM->SOUND_RAM.
+	  * Both ranges must lie entirely within their regions. Transfers between
+	  * plain memory regions are done as a bulk copy, and the bus cycles the
+	  * transfer occupies are stolen from the main CPU.
+	  * @param source Source address (must be even)
+	  * @param destination Destination address (must be even)
+	  * @param words Number of 16-bit words to transfer
+	  * @return Number of CPU cycles stolen, or -1 if the transfer was rejected
+	  */
+	 int ExecuteDMA(uint32_t source, uint32_t destination, uint32_t words);
+	 
+	 /**
+	  * Handle DMA controller register write
+	  * @param address Register address
+	  * @param value Value to write
+	  */
+	 void HandleDMARegisterWrite(uint32_t address, uint16_t value);
+	 
+	 /**
+	  * Read from DMA controller register
+	  * @param address Register address
+	  * @return Register value
+	  */
+	 uint16_t HandleDMARegisterRead(uint32_t address);
+	 
 	 /**
 	  * Create memory configuration for specific hardware variant
 	  * @param variant Hardware variant to configure for
@@ -223,6 +673,12 @@
 	 // Quick lookup by name
 	 std::unordered_map<std::string, size_t> m_regionsByName;
 	 
+	 // Flat page table covering the whole 24-bit address space
+	 std::vector<MemoryPage> m_pageTable;
+	 
+	 // I/O dispatch table (entry 0 is reserved for "no handler")
+	 std::vector<IOHandler> m_ioHandlers;
+	 
 	 // Hardware variant currently configured for
 	 HardwareVariant m_configuredVariant;
 	 
@@ -232,6 +688,37 @@
 	 uint32_t m_soundRamSize;
 	 uint32_t m_maxRomSize;
 	 
+	 // Store ROM/MAIN_RAM/VIDEO_RAM as host-order 16-bit words
+	 bool m_hostEndianStorage;
+	 
+	 // DMA controller registers
+	 struct {
+		 uint32_t source;         // Source address
+		 uint32_t destination;    // Destination address
+		 uint32_t length;         // Transfer length in words
+		 uint16_t control;        // Control register
+		 uint16_t status;         // Status register
+	 } m_dma;
+	 
+	 // Access counters (empty unless NIXX32_MEMORY_STATS is defined)
+	 MemoryAccessStats<MEMORY_STATS_ENABLED> m_accessStats;
+	 
+	 // VIDEO_RAM dirty bitmap, one bit per 256-byte block
+	 std::vector<uint64_t> m_vramDirty;
+	 uint32_t m_vramDirtyBase;
+	 uint32_t m_vramDirtySize;
+	 
+	 // Pages written since the last snapshot, one bit per page
+	 std::vector<uint64_t> m_snapshotDirty;
+	 
+	 // Pages of the last snapshot taken or restored, per region
+	 std::vector<std::vector<std::shared_ptr<const SnapshotPage>>> m_snapshotBase;
+	 
+	 // Pages watched for writes to translated code, one bit per page
+	 std::vector<uint64_t> m_codePages;
+	 CodeWriteListener m_codeWriteListener;
+	 void* m_codeWriteContext;
+	 
 	 /**
 	  * Configure memory for original NiXX-32 hardware
 	  */
@@ -242,12 +729,124 @@
 	  */
 	 void ConfigurePlusHardware();
 	 
+	 /**
+	  * Rebuild the page table from the current region list
+	  */
+	 void RebuildPageTable();
+	 
+	 /**
+	  * Map the pages covered by a region into the page table
+	  * @param regionIndex Index of the region to map
+	  */
+	 void MapRegionPages(int regionIndex);
+	 
+	 /**
+	  * Check if a region may use host-endian word storage
+	  * @param region Region to check
+	  * @return True for word-aligned ROM, MAIN_RAM and VIDEO_RAM regions
+	  */
+	 bool IsWordStorageEligible(const MemoryRegion& region) const;
+	 
+	 /**
+	  * Switch a region between big-endian byte and host-order word storage
+	  * @param region Region to convert
+	  * @param wordSwapped New storage mode
+	  */
+	 void ConvertRegionStorage(MemoryRegion& region, bool wordSwapped);
+	 
+	 /**
+	  * Check if a region is captured by snapshots
+	  * @param region Region to check
+	  * @return True for writable memory regions
+	  */
+	 bool IsSnapshotRegion(const MemoryRegion& region) const;
+	 
+	 /**
+	  * Check if a snapshot page of a region was written since the last snapshot
+	  * @param region Region containing the page
+	  * @param regionPage Page index relative to the region start
+	  * @return True if the page needs copying
+	  */
+	 bool IsSnapshotPageDirty(const MemoryRegion& region, uint32_t regionPage) const;
+	 
+	 /**
+	  * Clear snapshot dirty state for a range and re-arm the first-write trap
+	  * @param address Start address of the range
+	  * @param size Size of the range in bytes
+	  */
+	 void ProtectSnapshotPages(uint32_t address, uint32_t size);
+	 
+	 /**
+	  * Size the VIDEO_RAM dirty bitmap for the current memory map and mark it all dirty
+	  */
+	 void ResetVideoRamDirtyTracking();
+	 
+	 /**
+	  * Mark the dirty block containing a VIDEO_RAM address
+	  * @param address Address inside VIDEO_RAM
+	  */
+	 void MarkVideoRamDirtyBlock(uint32_t address);
+	 
+	 /**
+	  * Set or clear the dirty bits for a VIDEO_RAM range
+	  * @param address Start address of the range
+	  * @param size Size of the range in bytes
+	  * @param dirty True to set, false to clear
+	  */
+	 void SetVideoRamDirtyRange(uint32_t address, uint32_t size, bool dirty);
+	 
+	 /**
+	  * Check if a DMA source/destination pairing is supported by the hardware
+	  * @param sourceType Type of the source region
+	  * @param destinationType Type of the destination region
+	  * @return True if the pairing is supported
+	  */
+	 bool IsDMAPathSupported(MemoryRegionType sourceType, MemoryRegionType destinationType) const;
+	 
+	 /**
+	  * Add an entry to the I/O dispatch table and map its pages
+	  * @param handler Handler entry to add
+	  * @return True if the window was mapped successfully
+	  */
+	 bool AddIOHandler(const IOHandler& handler);
+	 
+	 /**
+	  * Map the pages covered by an I/O handler into the page table
+	  * @param handlerIndex Index of the handler in the dispatch table
+	  */
+	 void MapIOHandlerPages(uint16_t handlerIndex);
+	 
+	 /**
+	  * Dispatch thunks that forward to a device's typed register handlers
+	  */
+	 template <typename Result, auto Method, typename Device>
+	 static Result IOReadThunk(void* context, uint32_t address) {
+		 return static_cast<Result>((static_cast<Device*>(context)->*Method)(address));
+	 }
+	 
+	 template <typename Value, auto Method, typename Device>
+	 static void IOWriteThunk(void* context, uint32_t address, Value value) {
+		 using DeviceValue = typename IOWriteMethodTraits<decltype(Method)>::ValueType;
+		 (static_cast<Device*>(context)->*Method)(address, static_cast<DeviceValue>(value));
+	 }
+	 
+	 /**
+	  * Slow-path accessors used when a page has no direct host pointer
+	  * @param address Memory address
+	  * @param regionIndex Index of the region from the page table (-1 if unmapped)
+	  */
+	 uint8_t ReadSlow8(uint32_t address, int regionIndex);
+	 uint16_t ReadSlow16(uint32_t address, int regionIndex);
+	 void WriteSlow8(uint32_t address, uint8_t value, int regionIndex);
+	 void WriteSlow16(uint32_t address, uint16_t value, int regionIndex);
+	 
 	 /**
 	  * Find a memory region that contains the specified address
 	  * @param address Memory address to look up
+	  * @param includeOffBus True to also find regions off the main bus
 	  * @return Index of the region, or -1 if not found
 	  */
-	 int FindRegionIndex(uint32_t address);
+	 int FindRegionIndex(uint32_t address, bool includeOffBus = false);
 	 
 	 /**
 	  * Convert system address to region-relative address
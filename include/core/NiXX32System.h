@@ -22,6 +22,8 @@
  #include "ROMLoader.h"
  #include "Config.h"
  #include "Logger.h"
+ #include "EventScheduler.h"
+ #include "HostProfiler.h"
  
  namespace NiXX32 {
  
@@ -80,6 +82,28 @@
 	 */
 	void RunCycle(float deltaTime);
 	
+	/**
+	 * Run until the next vertical blank has been handled
+	 */
+	void RunFrame();
+	
+	/**
+	 * Select scanline-stepped or whole-frame rendering
+	 * 
+	 * In scanline mode the CPUs stop at the start of every visible line and
+	 * the line is composed from the graphics state at that moment, which
+	 * reproduces mid-frame scroll and palette changes. Whole-frame mode only
+	 * stops at frame boundaries and is the one to use for fast-forward.
+	 * @param enabled True for scanline-stepped rendering
+	 */
+	void SetScanlineRendering(bool enabled);
+	
+	/**
+	 * Check if scanline-stepped rendering is selected
+	 * @return True if lines are composed as the beam reaches them
+	 */
+	bool IsScanlineRendering() const;
+	
 	/**
 	 * Reset the emulation system
 	 */
@@ -139,6 +163,12 @@
 	 */
 	InputSystem& GetInputSystem();
 	
+	/**
+	 * Get the host time profiler (disabled until enabled by the caller)
+	 * @return Reference to the profiler
+	 */
+	HostProfiler& GetProfiler();
+	
 	/**
 	 * Attach a debugger to the system
 	 * @param debugger Pointer to debugger instance
@@ -201,6 +231,7 @@
 	uint64_t m_idleThresholdMs;     // Time before entering idle state
 	uint64_t m_sleepThresholdMs;    // Time before entering sleep state
 	bool m_powerManagementEnabled;	
+	float m_sleepAccumulator;       // Time skipped while sleeping, run in one go
 
 	// Core components
 	std::unique_ptr<MemoryManager> m_memoryManager;
@@ -213,6 +244,40 @@
 	std::unique_ptr<Config> m_config;
 	std::unique_ptr<Logger> m_logger;
 	
+	// Part of SOUND_RAM the Z80 sees, and its address for the 68000
+	uint8_t* m_sharedSoundRam;
+	uint32_t m_sharedSoundRamBase;
+	
+	// Audio CPU catch-up: main CPU cycle count at the last sync, Z80 cycles
+	// owed (negative after the Z80 overshoots), and the remainder of the
+	// clock conversion carried to the next sync
+	uint64_t m_audioSyncMainCycles;
+	int64_t m_audioCycleBalance;
+	uint64_t m_audioSyncRemainder;
+	
+	// Master clock (68000 cycles) event timeline
+	EventScheduler m_scheduler;
+	
+	// Master clock time RunCycle has been asked to reach, and the fraction
+	// of a cycle carried between calls
+	uint64_t m_runTarget;
+	double m_cycleFraction;
+	
+	// Video timing: start and length of the current frame, the line the
+	// pending SCANLINE event starts, the audio step within the frame, and
+	// frames completed
+	uint64_t m_frameStartTime;
+	uint64_t m_frameCycles;
+	int m_nextScanline;
+	int m_audioStep;
+	uint64_t m_frameCount;
+	
+	// Compose each visible line at its start instead of the whole frame
+	bool m_scanlineRendering;
+	
+	// Host time per subsystem
+	HostProfiler m_profiler;
+	
 	// Optional debugger attachment
 	std::shared_ptr<Debugger> m_debugger;
 	
@@ -230,6 +295,60 @@
 	 * Set up memory mappings based on hardware variant
 	 */
 	void SetupMemoryMap();
+	
+	/**
+	 * Run the audio CPU up to the main CPU's current time
+	 * 
+	 * The Z80 only ever runs behind the 68000. It is caught up whenever the
+	 * 68000 touches state the two share and on every audio timer event,
+	 * so sound commands and replies are seen in the order they were made.
+	 */
+	void SyncAudioCPU();
+	
+	/**
+	 * Restart audio CPU catch-up from the main CPU's current time
+	 */
+	void ResetAudioSync();
+	
+	/**
+	 * Restart video and audio timing events from the main CPU's current time
+	 */
+	void StartEventTiming();
+	
+	/**
+	 * Run the main CPU up to a master clock time, dispatching events as they fall due
+	 * @param endTime Master clock time to stop at
+	 */
+	void RunUntil(uint64_t endTime);
+	
+	/**
+	 * Handle an event and schedule its next occurrence
+	 * @param event Event that fell due
+	 * @param time Master clock time it was due at
+	 */
+	void DispatchEvent(SchedulerEvent event, uint64_t time);
+	
+	/**
+	 * Get the master clock time of a step within the current frame
+	 * @param step Step index (steps == next frame start)
+	 * @param steps Steps per frame
+	 * @return Master clock timestamp
+	 */
+	uint64_t GetFrameTime(int step, int steps) const;
+	
+	// 68000 accessors for state shared with the Z80; each catches the Z80 up first,
+	// and SOUND_RAM writes are reported with MarkWritten for snapshots
+	uint8_t HandleAudioRegisterRead(uint32_t address);
+	void HandleAudioRegisterWrite(uint32_t address, uint8_t value);
+	uint16_t HandleDMARegisterRead(uint32_t address);
+	void HandleDMARegisterWrite(uint32_t address, uint16_t value);
+	uint8_t HandleSharedSoundRamRead8(uint32_t address);
+	uint16_t HandleSharedSoundRamRead16(uint32_t address);
+	void HandleSharedSoundRamWrite8(uint32_t address, uint8_t value);
+	void HandleSharedSoundRamWrite16(uint32_t address, uint16_t value);
+	
+	// Z80 writes to its SOUND_RAM window, reported to MemoryManager for snapshots
+	void HandleAudioSoundRamWrite(uint16_t address, uint8_t value);
 
 	/**
       * Set up the 68000 interrupt vector table
@@ -22,6 +22,7 @@
  class MemoryManager;
  class Logger;
  class AudioSystem;
+ struct Z80Ops;
  
  /**
   * Defines the possible CPU execution states
@@ -122,8 +123,21 @@
 	 };
 	 
 	 // Index registers
-	 uint16_t ix;  // Index register X
-	 uint16_t iy;  // Index register Y
+	 union {
+		 struct {
+			 uint8_t ixl;
+			 uint8_t ixh;
+		 };
+		 uint16_t ix;  // Index register X
+	 };
+	 
+	 union {
+		 struct {
+			 uint8_t iyl;
+			 uint8_t iyh;
+		 };
+		 uint16_t iy;  // Index register Y
+	 };
 	 
 	 // Special purpose registers
 	 uint16_t sp;  // Stack pointer
@@ -150,6 +164,33 @@
 	 FLAG_S = 0x80   // Sign
  };
  
+ /**
+  * Handlers bound to one Z80 I/O port
+  * 
+  * Plain function pointers plus the device they forward to, so IN and OUT
+  * are one indirect call without hashing or std::function type erasure.
+  * Unbound ports read as open bus and ignore writes.
+  */
+ struct Z80PortHandler {
+	 void* context;  // Device instance passed to the handlers
+	 uint8_t (*read)(void* context, uint8_t port);
+	 void (*write)(void* context, uint8_t port, uint8_t value);
+ };
+ 
+ /**
+  * One page of the Z80's 64 KB address space
+  * 
+  * Plain memory is read and written through host pointers to the start of
+  * the page; a null pointer sends that direction to the handlers instead.
+  */
+ struct Z80MemoryPage {
+	 uint8_t* readPointer;   // Host memory for reads, or null
+	 uint8_t* writePointer;  // Host memory for writes, or null
+	 void* context;          // Device instance passed to the handlers
+	 uint8_t (*read)(void* context, uint16_t address);
+	 void (*write)(void* context, uint16_t address, uint8_t value);
+ };
+ 
  /**
   * Class for emulating the Zilog Z80 CPU
   */
@@ -181,6 +222,15 @@
 	  */
 	 void Reset();
 	 
+	 /**
+	  * Hold the CPU in reset or release it
+	  * 
+	  * A held CPU stays in the RESET state: it executes nothing and ignores
+	  * interrupts while time still passes. Releasing it starts from reset.
+	  * @param held True to hold the reset line
+	  */
+	 void SetResetLine(bool held);
+	 
 	 /**
 	  * Execute a specified number of cycles
 	  * @param cycles Number of cycles to execute
@@ -202,6 +252,19 @@
 	  */
 	 bool TriggerInterrupt(Z80InterruptType type, uint8_t data = 0);
 	 
+	 /**
+	  * Check if the CPU is halted with no interrupt able to wake it
+	  * @return True if executing would only run HALT's internal NOPs
+	  */
+	 bool IsWaitingForInterrupt() const;
+	 
+	 /**
+	  * Let a halted CPU sit out a number of cycles in one step
+	  * @param cycles Number of cycles to idle
+	  * @return Number of cycles used (a whole number of 4-cycle NOPs)
+	  */
+	 int SkipHaltedCycles(int cycles);
+	 
 	 /**
 	  * Get the current CPU state
 	  * @return Current CPU state
@@ -285,22 +348,99 @@
 	 std::string DisassembleInstruction(uint16_t address, int& instructionSize);
 	 
 	 /**
-	  * Register a callback for CPU port I/O
-	  * @param port Port number to hook
-	  * @param readCallback Function to call when the port is read
-	  * @param writeCallback Function to call when the port is written
-	  * @return True if hooks were registered successfully
+	  * Bind handlers to a CPU I/O port
+	  * @param port Port number
+	  * @param handler Handlers and their context; a null read or write
+	  *                handler leaves that direction open bus
 	  */
-	 bool RegisterPortHooks(uint8_t port, 
-						   std::function<uint8_t()> readCallback,
-						   std::function<void(uint8_t)> writeCallback);
+	 void SetPortHandler(uint8_t port, const Z80PortHandler& handler);
 	 
 	 /**
-	  * Remove hooks for the specified port
-	  * @param port Port to remove hooks from
-	  * @return True if hooks were removed successfully
+	  * Bind a device's port handlers to a range of CPU I/O ports
+	  * 
+	  * Usage: MapPortHandlers<&Device::HandlePortRead, &Device::HandlePortWrite>(...)
+	  * The handlers receive the port number and decode it themselves.
+	  * @param firstPort First port of the range
+	  * @param count Number of ports
+	  * @param device Device that owns the port handlers
+	  * @return True if the range fits in the 256-port space
 	  */
-	 bool RemovePortHooks(uint8_t port);
+	 template <auto ReadMethod, auto WriteMethod, typename Device>
+	 bool MapPortHandlers(uint8_t firstPort, unsigned count, Device& device) {
+		 if (count == 0 || firstPort + count > PORT_COUNT) {
+			 return false;
+		 }
+		 Z80PortHandler handler{ &device, &PortReadThunk<ReadMethod, Device>, &PortWriteThunk<WriteMethod, Device> };
+		 for (unsigned port = firstPort; port < firstPort + count; port++) {
+			 SetPortHandler(static_cast<uint8_t>(port), handler);
+		 }
+		 return true;
+	 }
+	 
+	 /**
+	  * Return a port to open bus
+	  * @param port Port to unbind
+	  * @return True if the port had handlers bound
+	  */
+	 bool RemovePortHandler(uint8_t port);
+	 
+	 /**
+	  * Map host memory into the Z80 address space
+	  * 
+	  * The memory must stay valid while it is mapped. Writes to read-only
+	  * mappings are ignored.
+	  * @param address Start address (a multiple of the page size)
+	  * @param size Size in bytes (a multiple of the page size)
+	  * @param data Host memory backing the range
+	  * @param writable True if the Z80 may write the memory
+	  * @return True if the range was mapped
+	  */
+	 bool MapMemory(uint16_t address, uint32_t size, uint8_t* data, bool writable);
+	 
+	 /**
+	  * Bind a device's register handlers to a range of the Z80 address space
+	  * 
+	  * Usage: MapMemoryHandlers<&Device::HandleRead, &Device::HandleWrite>(...)
+	  * Only for memory-mapped I/O; plain memory should use MapMemory.
+	  * @param address Start address (a multiple of the page size)
+	  * @param size Size in bytes (a multiple of the page size)
+	  * @param device Device that owns the handlers
+	  * @return True if the range was mapped
+	  */
+	 template <auto ReadMethod, auto WriteMethod, typename Device>
+	 bool MapMemoryHandlers(uint16_t address, uint32_t size, Device& device) {
+		 return MapPages(address, size, nullptr, false, &device,
+						 &MemoryReadThunk<ReadMethod, Device>, &MemoryWriteThunk<WriteMethod, Device>);
+	 }
+	 
+	 /**
+	  * Map memory the Z80 reads directly but writes through a device handler
+	  * 
+	  * For memory whose writes another component must see, e.g. shared RAM
+	  * that the 68000 side tracks for snapshots. The handler does the store.
+	  * Usage: MapMemoryWriteHandler<&Device::HandleWrite>(...)
+	  * @param address Start address (a multiple of the page size)
+	  * @param size Size in bytes (a multiple of the page size)
+	  * @param data Host memory backing reads of the range
+	  * @param device Device that owns the write handler
+	  * @return True if the range was mapped
+	  */
+	 template <auto WriteMethod, typename Device>
+	 bool MapMemoryWriteHandler(uint16_t address, uint32_t size, uint8_t* data, Device& device) {
+		 if (!data) {
+			 return false;
+		 }
+		 return MapPages(address, size, data, false, &device,
+						 &Z80CPU::OpenBusMemoryRead, &MemoryWriteThunk<WriteMethod, Device>);
+	 }
+	 
+	 /**
+	  * Return a range of the Z80 address space to open bus
+	  * @param address Start address (a multiple of the page size)
+	  * @param size Size in bytes (a multiple of the page size)
+	  * @return True if the range was unmapped
+	  */
+	 bool UnmapMemory(uint16_t address, uint32_t size);
 	 
 	 /**
 	  * Register an instruction execution hook
@@ -336,6 +476,9 @@
 	 // Current CPU state
 	 Z80State m_state;
 	 
+	 // Reset line held, e.g. while no sound program is loaded
+	 bool m_resetHeld;
+	 
 	 // Current interrupt mode
 	 InterruptMode m_interruptMode;
 	 
@@ -343,6 +486,9 @@
 	 bool m_iff1;  // Interrupt enable flip-flop 1
 	 bool m_iff2;  // Interrupt enable flip-flop 2
 	 
+	 // Set by EI; interrupts are held off until the next instruction completes
+	 bool m_afterEI;
+	 
 	 // Pending interrupt
 	 Z80InterruptType m_pendingInterrupt;
 	 uint8_t m_interruptData;
@@ -356,45 +502,85 @@
 	 // Pending cycles for current instruction
 	 int m_pendingCycles;
 	 
-	 // Port I/O hook maps
-	 std::unordered_map<uint8_t, std::function<uint8_t()>> m_portReadHooks;
-	 std::unordered_map<uint8_t, std::function<void(uint8_t)>> m_portWriteHooks;
+	 // Page table geometry (64 KB address space split into 1 KB pages)
+	 static constexpr unsigned PAGE_SHIFT = 10;
+	 static constexpr uint32_t PAGE_SIZE = 1u << PAGE_SHIFT;
+	 static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+	 static constexpr unsigned PAGE_COUNT = 0x10000 >> PAGE_SHIFT;
+	 
+	 // Memory pages, indexed by address >> PAGE_SHIFT
+	 Z80MemoryPage m_pages[PAGE_COUNT];
+	 
+	 // Number of I/O ports (8-bit port addresses)
+	 static constexpr unsigned PORT_COUNT = 256;
+	 
+	 // Port I/O handlers, indexed by port
+	 Z80PortHandler m_portHandlers[PORT_COUNT];
 	 
 	 // Instruction execution hook map
 	 std::unordered_map<uint16_t, std::function<void()>> m_executionHooks;
 	 
+	 // Execution hook presence, one bit per address
+	 uint64_t m_executionHookBitmap[0x10000 / 64];
+	 
+	 // False while no execution hooks are registered, so the bitmap is never touched
+	 bool m_hasExecutionHooks;
+	 
 	 // Memory access helpers
 	 uint8_t ReadByte(uint16_t address);
 	 void WriteByte(uint16_t address, uint8_t value);
 	 uint16_t ReadWord(uint16_t address);
 	 void WriteWord(uint16_t address, uint16_t value);
 	 
+	 // Fill a range of pages, checking its alignment
+	 bool MapPages(uint16_t address, uint32_t size, uint8_t* data, bool writable, void* context,
+				   uint8_t (*read)(void*, uint16_t), void (*write)(void*, uint16_t, uint8_t));
+	 
+	 // Handlers of unmapped memory
+	 static uint8_t OpenBusMemoryRead(void* context, uint16_t address);
+	 static void OpenBusMemoryWrite(void* context, uint16_t address, uint8_t value);
+	 
+	 // Dispatch thunks that forward to a device's typed memory handlers
+	 template <auto Method, typename Device>
+	 static uint8_t MemoryReadThunk(void* context, uint16_t address) {
+		 return static_cast<uint8_t>((static_cast<Device*>(context)->*Method)(address));
+	 }
+	 
+	 template <auto Method, typename Device>
+	 static void MemoryWriteThunk(void* context, uint16_t address, uint8_t value) {
+		 (static_cast<Device*>(context)->*Method)(address, value);
+	 }
+	 
 	 // Port I/O operations
 	 uint8_t InPort(uint8_t port);
 	 void OutPort(uint8_t port, uint8_t value);
 	 
+	 // Handlers of unbound ports
+	 static uint8_t OpenBusRead(void* context, uint8_t port);
+	 static void OpenBusWrite(void* context, uint8_t port, uint8_t value);
+	 
+	 // Dispatch thunks that forward to a device's typed port handlers
+	 template <auto Method, typename Device>
+	 static uint8_t PortReadThunk(void* context, uint8_t port) {
+		 return static_cast<uint8_t>((static_cast<Device*>(context)->*Method)(port));
+	 }
+	 
+	 template <auto Method, typename Device>
+	 static void PortWriteThunk(void* context, uint8_t port, uint8_t value) {
+		 (static_cast<Device*>(context)->*Method)(port, value);
+	 }
+	 
 	 // Stack operations
 	 void Push(uint16_t value);
 	 uint16_t Pop();
 	 
 	 // Instruction fetch and decode
+	 uint8_t FetchOpcode();
 	 uint8_t FetchByte();
 	 uint16_t FetchWord();
 	 
-	 // Instruction execution helpers
-	 int ExecuteMainInstruction(uint8_t opcode);
-	 int ExecuteCBPrefixedInstruction(uint8_t opcode);
-	 int ExecuteDDPrefixedInstruction(uint8_t opcode);
-	 int ExecuteEDPrefixedInstruction(uint8_t opcode);
-	 int ExecuteFDPrefixedInstruction(uint8_t opcode);
-	 int ExecuteDDCBPrefixedInstruction(uint8_t displacement, uint8_t opcode);
-	 int ExecuteFDCBPrefixedInstruction(uint8_t displacement, uint8_t opcode);
-	 
-	 // Flag calculation helpers
-	 uint8_t CalculateParityFlag(uint8_t value);
-	 uint8_t CalculateSignZeroFlags(uint8_t value);
-	 void UpdateFlagsAfterLogicalOp(uint8_t result);
-	 void UpdateFlagsAfterArithmeticOp(uint8_t result, uint8_t operand1, uint8_t operand2, bool isAdd);
+	 // Instruction handlers and their per-prefix dispatch tables
+	 friend struct Z80Ops;
 	 
 	 // Process pending interrupts
 	 bool CheckPendingInterrupts();
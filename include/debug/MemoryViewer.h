@@ -117,6 +117,9 @@
  
  /**
   * Class for viewing and editing system memory
+  * 
+  * Views and edits go through MemoryManager::Peek8/Poke8, which bypass I/O
+  * side effects and account for host-endian word storage in ROM/RAM/VRAM.
   */
  class MemoryViewer {
  public:
@@ -330,6 +333,20 @@
 	  * @return Last viewed address
 	  */
 	 uint32_t GetLastViewedAddress() const;
+	 
+	 /**
+	  * Render a heatmap of memory access counts
+	  * 
+	  * Each character is one MemoryManager page, shaded on a log scale from
+	  * ' ' (never accessed) to '@' (the most accessed page in the range).
+	  * Requires a build with NIXX32_MEMORY_STATS.
+	  * @param startAddress Start address of the range
+	  * @param size Size of the range in bytes
+	  * @param pagesPerRow Number of pages per output row
+	  * @return Heatmap text, one row per line prefixed with its address
+	  */
+	 std::string RenderAccessHeatmap(uint32_t startAddress, uint32_t size,
+								   uint32_t pagesPerRow = 64) const;
  
  private:
 	 // Reference to parent system
@@ -98,6 +98,14 @@
 	  */
 	 void Render(uint32_t* frameBuffer, int width, int height, int pitch);
 	 
+	 /**
+	  * Render one screen line of the layer using the current scroll state
+	  * @param lineBuffer Pointer to the start of the line in the frame buffer
+	  * @param line Screen line to render
+	  * @param width Line width in pixels
+	  */
+	 void RenderLine(uint32_t* lineBuffer, int line, int width);
+	 
 	 /**
 	  * Set the layer's scroll position
 	  * @param scrollX Horizontal scroll position
@@ -138,6 +146,7 @@
 	 
 	 /**
 	  * Update layer data from VRAM
+	  * Only tile map entries and cached tiles in dirty VRAM blocks are re-decoded
 	  */
 	 void UpdateFromVRAM();
 	 
@@ -97,12 +97,19 @@
 	 
 	 /**
 	  * Update graphics state for the current frame
+	  * 
+	  * Palette, sprite and background data are refreshed from VIDEO_RAM
+	  * blocks the MemoryManager reports dirty, then the dirty state is cleared.
 	  * @param deltaTime Time elapsed since last update in milliseconds
 	  */
 	 void Update(float deltaTime);
 	 
 	 /**
 	  * Render the current frame
+	  * 
+	  * With scanline rendering enabled the lines composed by RenderScanline()
+	  * are copied out as they are; otherwise the whole frame is composed from
+	  * the current state.
 	  * @param frameBuffer Pointer to frame buffer to render into
 	  * @param width Frame buffer width
 	  * @param height Frame buffer height
@@ -110,8 +117,32 @@
 	  */
 	 void Render(uint32_t* frameBuffer, int width, int height, int pitch);
 	 
+	 /**
+	  * Compose one line of the internal frame buffer from the current state
+	  * 
+	  * Palette, sprite and background data are refreshed from dirty VIDEO_RAM
+	  * blocks first, so scroll, palette and VRAM changes made while earlier
+	  * lines were displayed show up from this line down (raster effects).
+	  * Post-processing effects are still applied to the whole frame.
+	  * @param line Screen line to compose (0 to screen height - 1)
+	  */
+	 void RenderScanline(int line);
+	 
+	 /**
+	  * Select scanline rendering instead of composing whole frames
+	  * @param enabled True to compose each line as the beam reaches it
+	  */
+	 void SetScanlineRendering(bool enabled);
+	 
+	 /**
+	  * Check if scanline rendering is selected
+	  * @return True if lines are composed as the beam reaches them
+	  */
+	 bool IsScanlineRendering() const;
+	 
 	 /**
 	  * Update palette data from VRAM
+	  * Only runs if the palette's VRAM blocks are dirty
 	  */
 	 void UpdatePalette();
 	 
@@ -252,6 +283,9 @@
 	 // Internal frame buffer
 	 std::vector<uint32_t> m_frameBuffer;
 	 
+	 // Compose lines as the beam reaches them instead of once per frame
+	 bool m_scanlineRendering;
+	 
 	 // Color palette
 	 std::vector<Color> m_palette;
 	 
@@ -297,6 +331,7 @@
 	 
 	 /**
 	  * Process sprite data from VRAM
+	  * Only runs if the sprite table's VRAM blocks are dirty
 	  */
 	 void ProcessSprites();
 	 
@@ -317,8 +352,23 @@
 	  */
 	 void RenderSprites(uint32_t* frameBuffer);
 	 
+	 /**
+	  * Render one line of the background layers
+	  * @param lineBuffer Start of the line in the frame buffer
+	  * @param line Screen line to render
+	  */
+	 void RenderBackgroundLine(uint32_t* lineBuffer, int line);
+	 
+	 /**
+	  * Render one line of sprites
+	  * @param lineBuffer Start of the line in the frame buffer
+	  * @param line Screen line to render
+	  */
+	 void RenderSpriteLine(uint32_t* lineBuffer, int line);
+	 
 	 /**
 	  * Apply post-processing effects
+	  * Host time is charged to ProfileCategory::EFFECTS of the system profiler
 	  * @param frameBuffer Target frame buffer
 	  */
 	 void ApplyEffects(uint32_t* frameBuffer);
@@ -116,6 +116,14 @@
 	  */
 	 void Render(uint32_t* frameBuffer, int width, int height, int pitch);
 	 
+	 /**
+	  * Render the part of the sprite that falls on one screen line
+	  * @param lineBuffer Pointer to the start of the line in the frame buffer
+	  * @param line Screen line to render
+	  * @param width Line width in pixels
+	  */
+	 void RenderLine(uint32_t* lineBuffer, int line, int width);
+	 
 	 /**
 	  * Set the sprite's attributes
 	  * @param attributes New sprite attributes
@@ -264,6 +272,7 @@
 	 
 	 /**
 	  * Update sprite data from VRAM
+	  * Cached pixel data is only re-decoded if its VRAM blocks are dirty
 	  */
 	 void UpdateFromVRAM();
 	 
@@ -471,6 +480,14 @@
 	  */
 	 void Render(uint32_t* frameBuffer, int width, int height, int pitch);
 	 
+	 /**
+	  * Render the sprites that cross one screen line, in priority order
+	  * @param lineBuffer Pointer to the start of the line in the frame buffer
+	  * @param line Screen line to render
+	  * @param width Line width in pixels
+	  */
+	 void RenderLine(uint32_t* lineBuffer, int line, int width);
+	 
 	 /**
 	  * Get a specific sprite
 	  * @param index Sprite index
@@ -486,6 +503,7 @@
 	 
 	 /**
 	  * Update sprite data from VRAM
+	  * Attributes are only re-read for sprite table entries in dirty VRAM blocks
 	  */
 	 void UpdateFromVRAM();
 	 
@@ -78,6 +78,16 @@
 	 std::string region;           // Memory region for this ROM
  };
  
+ /**
+  * View of an individual ROM file's contents
+  */
+ struct ROMFileView {
+	 std::string filename;          // File name
+	 const uint8_t* data;           // File contents
+	 size_t size;                   // Size in bytes
+	 std::string sourcePath;        // Path on disk if the file is uncompressed, empty otherwise
+ };
+ 
  /**
   * ROM loading progress information
   */
@@ -159,6 +169,12 @@
 	  */
 	 ROMInfo GetLoadedROMInfo() const;
 	 
+	 /**
+	  * Get the files of the currently loaded ROM
+	  * @return Information on each loaded file, including its region
+	  */
+	 const std::vector<ROMFileInfo>& GetLoadedROMFiles() const;
+	 
 	 /**
 	  * Check if a ROM is currently loaded
 	  * @return True if ROM is loaded
@@ -321,6 +337,40 @@
 		 const std::unordered_map<std::string, std::vector<uint8_t>>& files,
 		 const std::string& romName);
 	 
+	 /**
+	  * Validate ROM files against database
+	  * @param files Views of the ROM files
+	  * @param romName ROM set name
+	  * @param validateChecksum Whether to validate checksums
+	  * @return Validation status
+	  */
+	 ROMValidationStatus ValidateROMFiles(
+		 const std::vector<ROMFileView>& files,
+		 const std::string& romName,
+		 bool validateChecksum);
+	 
+	 /**
+	  * Load ROM data into memory
+	  * 
+	  * Files with a source path are mapped into their region where possible
+	  * instead of being copied. Database entries for a region off the 68000
+	  * bus (such as Z80_ROM) give their load address within that region.
+	  * @param files Views of the ROM files
+	  * @param romName ROM set name
+	  * @return True if successful
+	  */
+	 bool LoadROMToMemory(
+		 const std::vector<ROMFileView>& files,
+		 const std::string& romName);
+	 
+	 /**
+	  * Build views over a map of extracted files
+	  * @param files ROM files
+	  * @return Views of the files
+	  */
+	 static std::vector<ROMFileView> MakeFileViews(
+		 const std::unordered_map<std::string, std::vector<uint8_t>>& files);
+	 
 	 /**
 	  * Calculate CRC32 checksum
 	  * @param data Data buffer
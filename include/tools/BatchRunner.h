@@ -0,0 +1,84 @@
+/**
+ * BatchRunner.h
+ * Parallel multi-instance batch runner for NiXX-32 arcade board emulation
+ *
+ * Runs independent System instances side by side on a pool of worker
+ * threads, each replaying an input movie headless and recording a hash of
+ * the video frame and audio output of every emulated frame. Comparing the
+ * hash files between builds flags any change in emulated behavior.
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <string>
+ #include <vector>
+
+ #include "NiXX32System.h"
+
+ namespace NiXX32 {
+
+ /**
+  * One scripted session to run
+  */
+ struct BatchJob {
+	 std::string romPath;      // ROM to load
+	 std::string moviePath;    // Input movie to replay (empty for no input)
+	 std::string hashPath;     // Per-frame hash output file (empty to skip)
+	 uint64_t frames;          // Frames to run (0 for the movie's length)
+	 HardwareVariant variant;  // Hardware variant to emulate
+ };
+
+ /**
+  * Outcome of one job
+  */
+ struct BatchResult {
+	 bool success;             // True if every frame ran
+	 std::string error;        // Failure description
+	 uint64_t framesRun;       // Frames emulated
+	 uint64_t videoHash;       // Hash of the last frame's video output
+	 uint64_t audioHash;       // Hash of all audio output
+	 double seconds;           // Host time taken
+ };
+
+ /**
+  * Runs batch jobs on a fixed pool of worker threads
+  *
+  * Instances share nothing mutable, so throughput scales with the number of
+  * threads. ROM files are mapped privately by each instance, which shares
+  * the untouched pages between all of them.
+  */
+ class BatchRunner {
+ public:
+	 /**
+	  * Constructor
+	  * @param threadCount Worker threads (0 for one per hardware thread)
+	  */
+	 explicit BatchRunner(unsigned threadCount = 0);
+
+	 /**
+	  * Run every job and wait for all of them to finish
+	  * @param jobs Jobs to run
+	  * @return One result per job, in job order
+	  */
+	 std::vector<BatchResult> Run(const std::vector<BatchJob>& jobs);
+
+	 /**
+	  * Get the number of worker threads
+	  * @return Thread count
+	  */
+	 unsigned GetThreadCount() const { return m_threadCount; }
+
+ private:
+	 // Worker threads used by Run()
+	 unsigned m_threadCount;
+
+	 /**
+	  * Run one job on the calling thread
+	  * @param job Job to run
+	  * @return Its result
+	  */
+	 static BatchResult RunJob(const BatchJob& job);
+ };
+
+ } // namespace NiXX32
@@ -0,0 +1,96 @@
+/**
+ * InputMovie.h
+ * Scripted input playback for NiXX-32 arcade board emulation
+ *
+ * An input movie is a text file of timed input changes, one per line:
+ *
+ *     # frame  action    arguments
+ *     0        coin      0 1          (slot, pressed)
+ *     2        coin      0 0
+ *     60       button    0 6 1        (player, button, pressed)
+ *     90       joystick  0 9          (player, direction bits)
+ *     300      service   0 1          (control, pressed)
+ *
+ * Blank lines and text after '#' are ignored. Changes are applied before
+ * the given frame is emulated and stay in effect until changed again.
+ */
+
+ #pragma once
+
+ #include <cstdint>
+ #include <string>
+ #include <vector>
+
+ namespace NiXX32 {
+
+ // Forward declarations
+ class InputSystem;
+
+ /**
+  * Kind of input change in a movie
+  */
+ enum class MovieAction : uint8_t {
+	 JOYSTICK,  // Set a player's joystick direction bits
+	 BUTTON,    // Press or release a player button
+	 COIN,      // Press or release a coin switch
+	 SERVICE    // Press or release a service control
+ };
+
+ /**
+  * One input change
+  */
+ struct MovieEvent {
+	 uint64_t frame;      // Frame the change applies from
+	 MovieAction action;  // What changes
+	 uint8_t player;      // Player index (JOYSTICK, BUTTON)
+	 uint8_t control;     // Button, coin slot or service control index
+	 uint8_t value;       // Direction bits, or 0/1 for released/pressed
+ };
+
+ /**
+  * Input movie loaded from a file and replayed frame by frame
+  */
+ class InputMovie {
+ public:
+	 /**
+	  * Constructor
+	  */
+	 InputMovie();
+
+	 /**
+	  * Load a movie, replacing any loaded one
+	  * @param path Movie file path
+	  * @param error Output parameter for a description of the first problem
+	  * @return True if the whole file was parsed
+	  */
+	 bool Load(const std::string& path, std::string& error);
+
+	 /**
+	  * Apply the changes due at a frame
+	  *
+	  * Frames must be applied in increasing order; call Rewind() to restart.
+	  * @param frame Frame about to be emulated
+	  * @param input Input system to apply the changes to
+	  */
+	 void Apply(uint64_t frame, InputSystem& input);
+
+	 /**
+	  * Restart playback from the first change
+	  */
+	 void Rewind();
+
+	 /**
+	  * Get the number of frames the movie covers
+	  * @return One past the frame of the last change, 0 if empty
+	  */
+	 uint64_t GetLength() const;
+
+ private:
+	 // Changes in frame order
+	 std::vector<MovieEvent> m_events;
+
+	 // Next change to apply
+	 size_t m_cursor;
+ };
+
+ } // namespace NiXX32
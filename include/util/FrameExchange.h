@@ -0,0 +1,109 @@
+/**
+ * FrameExchange.h
+ * Lock-free triple-buffered frame handoff for NiXX-32 arcade board emulation
+ *
+ * This file defines the exchange that passes finished video frames from the
+ * emulation thread to the presentation thread. The producer always has a
+ * free buffer to render into and the consumer always has the latest
+ * completed frame, so neither side ever waits for the other: a slow present
+ * or vsync wait only means some frames are never shown.
+ */
+
+ #pragma once
+
+ #include <atomic>
+ #include <cstdint>
+ #include <vector>
+
+ namespace NiXX32 {
+
+ /**
+  * Three frame buffers handed between one producer and one consumer thread
+  *
+  * One buffer belongs to the producer, one to the consumer, and the third
+  * (the spare) is swapped with either side using a single atomic exchange.
+  */
+ class FrameExchange {
+ public:
+	 /**
+	  * Constructor
+	  */
+	 FrameExchange();
+
+	 FrameExchange(const FrameExchange&) = delete;
+	 FrameExchange& operator=(const FrameExchange&) = delete;
+
+	 /**
+	  * Size all three buffers and drop any pending frame
+	  *
+	  * Not thread-safe; call while neither thread is using the exchange.
+	  * @param width Frame width in pixels
+	  * @param height Frame height in pixels
+	  */
+	 void Resize(int width, int height);
+
+	 /**
+	  * Get the producer's buffer to render the next frame into
+	  * @return Pointer to width * height pixels
+	  */
+	 uint32_t* GetWriteBuffer();
+
+	 /**
+	  * Hand the producer's buffer to the consumer as the latest frame
+	  *
+	  * The producer continues with the spare buffer. A published frame the
+	  * consumer has not picked up yet is overwritten.
+	  */
+	 void Publish();
+
+	 /**
+	  * Take the latest published frame, if there is one the consumer has not seen
+	  * @return True if GetReadBuffer() now holds a new frame
+	  */
+	 bool AcquireLatest();
+
+	 /**
+	  * Get the consumer's buffer (the frame last acquired)
+	  * @return Pointer to width * height pixels
+	  */
+	 const uint32_t* GetReadBuffer() const;
+
+	 /**
+	  * Get the frame width
+	  * @return Width in pixels
+	  */
+	 int GetWidth() const { return m_width; }
+
+	 /**
+	  * Get the frame height
+	  * @return Height in pixels
+	  */
+	 int GetHeight() const { return m_height; }
+
+	 /**
+	  * Get the frame pitch
+	  * @return Bytes per row
+	  */
+	 int GetPitch() const { return m_width * static_cast<int>(sizeof(uint32_t)); }
+
+ private:
+	 // Set in m_spare when it holds a frame the consumer has not taken
+	 static constexpr uint8_t FRESH = 0x80;
+	 static constexpr uint8_t INDEX_MASK = 0x03;
+
+	 // The three frame buffers
+	 std::vector<uint32_t> m_buffers[3];
+	 int m_width;
+	 int m_height;
+
+	 // Buffer owned by the producer (touched only by the producer thread)
+	 uint8_t m_writeIndex;
+
+	 // Buffer owned by the consumer (touched only by the consumer thread)
+	 uint8_t m_readIndex;
+
+	 // Spare buffer index, plus FRESH
+	 std::atomic<uint8_t> m_spare;
+ };
+
+ } // namespace NiXX32
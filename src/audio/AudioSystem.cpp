@@ -139,37 +139,9 @@
 	 m_fmInstruments.resize(MAX_INSTRUMENTS);
 	 m_pcmSamples.resize(MAX_SAMPLES);
 	 
-	 // Set up Z80 port handlers
-	 RegisterPortHandler(YM2151_ADDRESS_PORT, 
-		 [this]() -> uint8_t { return m_ym2151->ReadReg(m_registers.fmControl); },
-		 [this](uint8_t value) { m_registers.fmControl = value; }
-	 );
-	 
-	 RegisterPortHandler(YM2151_DATA_PORT, 
-		 [this]() -> uint8_t { return m_ym2151->ReadReg(m_registers.fmControl); },
-		 [this](uint8_t value) { m_ym2151->WriteReg(m_registers.fmControl, value); }
-	 );
-	 
-	 RegisterPortHandler(PCM_CONTROL_PORT, 
-		 [this]() -> uint8_t { return m_pcmPlayer->HandleRegisterRead(m_registers.pcmControl); },
-		 [this](uint8_t value) { m_registers.pcmControl = value; }
-	 );
-	 
-	 RegisterPortHandler(PCM_DATA_PORT, 
-		 [this]() -> uint8_t { return m_pcmPlayer->HandleRegisterRead(m_registers.pcmControl); },
-		 [this](uint8_t value) { m_pcmPlayer->HandleRegisterWrite(m_registers.pcmControl, value); }
-	 );
-	 
-	 if (m_variant == AudioHardwareVariant::NIXX32_PLUS) {
-		 RegisterPortHandler(QSOUND_ADDRESS_PORT, 
-			 [this]() -> uint8_t { return m_qSound->ReadReg(m_registers.qsoundControl); },
-			 [this](uint8_t value) { m_registers.qsoundControl = value; }
-		 );
-		 
-		 RegisterPortHandler(QSOUND_DATA_PORT, 
-			 [this]() -> uint8_t { return m_qSound->ReadReg(m_registers.qsoundControl); },
-			 [this](uint8_t value) { m_qSound->WriteReg(m_registers.qsoundControl, value); }
-		 );
+	 // Bind the chip ports now if the audio CPU is already attached
+	 if (m_audioCPU) {
+		 MapChipPorts();
 	 }
 	 
 	 m_logger.Info("AudioSystem", "Audio system initialized for " + 
@@ -908,28 +880,59 @@
  }
  
  /**
-  * Register a Z80 port handler
+  * Read from a sound chip port
   */
- bool AudioSystem::RegisterPortHandler(uint8_t port, 
-									  std::function<uint8_t()> readHandler,
-									  std::function<void(uint8_t)> writeHandler) {
-	 if (m_portReadHandlers.find(port) != m_portReadHandlers.end() ||
-		 m_portWriteHandlers.find(port) != m_portWriteHandlers.end()) {
-		 m_logger.Warning("AudioSystem", "Port " + std::to_string(port) + " already has handlers");
-		 return false;
+ uint8_t AudioSystem::HandlePortRead(uint8_t port) {
+	 switch (port) {
+		 case YM2151_ADDRESS_PORT:
+		 case YM2151_DATA_PORT:
+			 return m_ym2151->ReadReg(m_registers.fmControl);
+		 
+		 case PCM_CONTROL_PORT:
+		 case PCM_DATA_PORT:
+			 return m_pcmPlayer->HandleRegisterRead(m_registers.pcmControl);
+		 
+		 case QSOUND_ADDRESS_PORT:
+		 case QSOUND_DATA_PORT:
+			 return m_qSound->ReadReg(m_registers.qsoundControl);
+		 
+		 default:
+			 return 0xFF;
 	 }
-	 
-	 m_portReadHandlers[port] = readHandler;
-	 m_portWriteHandlers[port] = writeHandler;
-	 
-	 if (m_audioCPU) {
-		 // Register with Z80 CPU
-		 m_audioCPU->RegisterPortHooks(port, readHandler, writeHandler);
+ }
+ 
+ /**
+  * Write to a sound chip port
+  */
+ void AudioSystem::HandlePortWrite(uint8_t port, uint8_t value) {
+	 switch (port) {
+		 case YM2151_ADDRESS_PORT:
+			 m_registers.fmControl = value;
+			 break;
+		 
+		 case YM2151_DATA_PORT:
+			 m_ym2151->WriteReg(m_registers.fmControl, value);
+			 break;
+		 
+		 case PCM_CONTROL_PORT:
+			 m_registers.pcmControl = value;
+			 break;
+		 
+		 case PCM_DATA_PORT:
+			 m_pcmPlayer->HandleRegisterWrite(m_registers.pcmControl, value);
+			 break;
+		 
+		 case QSOUND_ADDRESS_PORT:
+			 m_registers.qsoundControl = value;
+			 break;
+		 
+		 case QSOUND_DATA_PORT:
+			 m_qSound->WriteReg(m_registers.qsoundControl, value);
+			 break;
+		 
+		 default:
+			 break;
 	 }
-	 
-	 m_logger.Debug("AudioSystem", "Port handlers registered for port " + std::to_string(port));
-	 
-	 return true;
  }
  
  /**
@@ -968,11 +971,10 @@
  void AudioSystem::SetAudioCPU(Z80CPU* cpu) {
 	 m_audioCPU = cpu;
 	 
-	 // Register port handlers with the CPU
+	 // Bind the chip ports on the CPU once the chips exist
 	 if (m_audioCPU) {
-		 for (const auto& handler : m_portReadHandlers) {
-			 uint8_t port = handler.first;
-			 m_audioCPU->RegisterPortHooks(port, m_portReadHandlers[port], m_portWriteHandlers[port]);
+		 if (m_ym2151) {
+			 MapChipPorts();
 		 }
 		 
 		 m_logger.Info("AudioSystem", "Audio CPU set and port handlers registered");
@@ -983,6 +985,18 @@
  
  // Private helper methods
  
+ /**
+  * Bind the sound chip ports
+  */
+ void AudioSystem::MapChipPorts() {
+	 m_audioCPU->MapPortHandlers<&AudioSystem::HandlePortRead, &AudioSystem::HandlePortWrite>(YM2151_ADDRESS_PORT, 2, *this);
+	 m_audioCPU->MapPortHandlers<&AudioSystem::HandlePortRead, &AudioSystem::HandlePortWrite>(PCM_CONTROL_PORT, 2, *this);
+	 
+	 if (m_variant == AudioHardwareVariant::NIXX32_PLUS) {
+		 m_audioCPU->MapPortHandlers<&AudioSystem::HandlePortRead, &AudioSystem::HandlePortWrite>(QSOUND_ADDRESS_PORT, 2, *this);
+	 }
+ }
+ 
  /**
   * Find an available FM channel
   */
@@ -0,0 +1,91 @@
+/**
+ * EventScheduler.cpp
+ * Implementation of the master clock event scheduler
+ *
+ * Rescheduling or cancelling an event only bumps its generation; the old
+ * heap entry is discarded once it reaches the top. With a handful of event
+ * types the heap stays tiny, so every operation is a few comparisons.
+ */
+
+ #include "EventScheduler.h"
+
+ #include <algorithm>
+
+ namespace NiXX32 {
+
+ EventScheduler::EventScheduler()
+	 : m_generation{} {
+	 std::fill(std::begin(m_scheduledTime), std::end(m_scheduledTime), NEVER);
+ }
+
+ void EventScheduler::Schedule(SchedulerEvent event, uint64_t time) {
+	 size_t index = static_cast<size_t>(event);
+	 m_generation[index]++;
+	 m_scheduledTime[index] = time;
+
+	 m_heap.push_back(Entry{ time, m_generation[index], event });
+	 std::push_heap(m_heap.begin(), m_heap.end(), &EventScheduler::Later);
+	 DropStale();
+ }
+
+ void EventScheduler::Cancel(SchedulerEvent event) {
+	 size_t index = static_cast<size_t>(event);
+	 m_generation[index]++;
+	 m_scheduledTime[index] = NEVER;
+	 DropStale();
+ }
+
+ void EventScheduler::Clear() {
+	 m_heap.clear();
+	 for (size_t index = 0; index < static_cast<size_t>(SchedulerEvent::COUNT); index++) {
+		 m_generation[index]++;
+		 m_scheduledTime[index] = NEVER;
+	 }
+ }
+
+ uint64_t EventScheduler::GetScheduledTime(SchedulerEvent event) const {
+	 return m_scheduledTime[static_cast<size_t>(event)];
+ }
+
+ uint64_t EventScheduler::GetNextEventTime() const {
+	 return m_heap.empty() ? NEVER : m_heap.front().time;
+ }
+
+ bool EventScheduler::PopDueEvent(uint64_t now, SchedulerEvent& event, uint64_t& time) {
+	 if (m_heap.empty() || m_heap.front().time > now) {
+		 return false;
+	 }
+
+	 Entry entry = m_heap.front();
+	 std::pop_heap(m_heap.begin(), m_heap.end(), &EventScheduler::Later);
+	 m_heap.pop_back();
+
+	 size_t index = static_cast<size_t>(entry.event);
+	 m_generation[index]++;
+	 m_scheduledTime[index] = NEVER;
+	 DropStale();
+
+	 event = entry.event;
+	 time = entry.time;
+	 return true;
+ }
+
+ bool EventScheduler::Later(const Entry& a, const Entry& b) {
+	 if (a.time != b.time) {
+		 return a.time > b.time;
+	 }
+	 return a.event > b.event;
+ }
+
+ void EventScheduler::DropStale() {
+	 while (!m_heap.empty()) {
+		 const Entry& top = m_heap.front();
+		 if (top.generation == m_generation[static_cast<size_t>(top.event)]) {
+			 break;
+		 }
+		 std::pop_heap(m_heap.begin(), m_heap.end(), &EventScheduler::Later);
+		 m_heap.pop_back();
+	 }
+ }
+
+ } // namespace NiXX32
@@ -0,0 +1,78 @@
+/**
+ * HostProfiler.cpp
+ * Implementation of host time accounting
+ *
+ * Every scope transition reads the clock once and charges the time since
+ * the previous transition to whichever scope was innermost, which keeps
+ * the per-subsystem times exclusive without a separate stack.
+ */
+
+ #include "HostProfiler.h"
+
+ namespace NiXX32 {
+
+ HostProfiler::HostProfiler()
+	 : m_enabled(false),
+	   m_depth(0),
+	   m_current(ProfileCategory::SYSTEM),
+	   m_mark(),
+	   m_time{} {
+ }
+
+ void HostProfiler::SetEnabled(bool enabled) {
+	 m_enabled = enabled;
+	 m_mark = Clock::now();
+ }
+
+ void HostProfiler::Reset() {
+	 for (Clock::duration& time : m_time) {
+		 time = Clock::duration::zero();
+	 }
+	 m_mark = Clock::now();
+ }
+
+ double HostProfiler::GetSeconds(ProfileCategory category) const {
+	 return std::chrono::duration<double>(m_time[static_cast<size_t>(category)]).count();
+ }
+
+ const char* HostProfiler::GetCategoryName(ProfileCategory category) {
+	 switch (category) {
+		 case ProfileCategory::SYSTEM:    return "system";
+		 case ProfileCategory::MAIN_CPU:  return "main_cpu";
+		 case ProfileCategory::AUDIO_CPU: return "audio_cpu";
+		 case ProfileCategory::GRAPHICS:  return "graphics";
+		 case ProfileCategory::EFFECTS:   return "effects";
+		 case ProfileCategory::AUDIO:     return "audio";
+		 case ProfileCategory::INPUT:     return "input";
+		 default:                         return "unknown";
+	 }
+ }
+
+ ProfileCategory HostProfiler::Enter(ProfileCategory category) {
+	 Clock::time_point now = Clock::now();
+	 if (m_depth > 0) {
+		 Charge(now);
+	 }
+	 m_mark = now;
+	 m_depth++;
+
+	 ProfileCategory previous = m_current;
+	 m_current = category;
+	 return previous;
+ }
+
+ void HostProfiler::Leave(ProfileCategory previous) {
+	 if (m_enabled) {
+		 Clock::time_point now = Clock::now();
+		 Charge(now);
+		 m_mark = now;
+	 }
+	 m_depth--;
+	 m_current = previous;
+ }
+
+ void HostProfiler::Charge(Clock::time_point now) {
+	 m_time[static_cast<size_t>(m_current)] += now - m_mark;
+ }
+
+ } // namespace NiXX32
@@ -0,0 +1,248 @@
+/**
+ * M68000BlockCache.cpp
+ * Implementation of the block cache execution core for the NiXX-32 main CPU
+ *
+ * A block is recorded the first time its start address is reached: the
+ * interpreter executes it one instruction at a time and each opcode's
+ * handler, base cycles and address are appended as it goes. Recording
+ * stops after anything that can change the PC or unmask interrupts, before
+ * rare opcodes that stay interpreted, and in front of hooked addresses, so
+ * interrupts and hooks only ever need checking at block boundaries.
+ *
+ * Replaying a block calls the same handlers with the same cycle accounting
+ * as the interpreter, which keeps both cores in lockstep. The memory pages
+ * a block came from are watched; the first write to one drops every block
+ * on it.
+ */
+
+ #include "M68000BlockCache.h"
+ #include "M68000CPU.h"
+ #include "MemoryManager.h"
+
+ #include <algorithm>
+
+ namespace NiXX32 {
+
+ // Longest 68000 instruction (opcode plus two 32-bit extensions)
+ constexpr uint32_t MAX_INSTRUCTION_BYTES = 10;
+
+ // Longest block recorded
+ constexpr size_t MAX_BLOCK_INSTRUCTIONS = 64;
+
+ // Entries in the direct-mapped lookup cache (a power of two)
+ constexpr uint32_t LOOKUP_SIZE = 4096;
+
+ /**
+  * One predecoded instruction in a block
+  */
+ struct CachedInstruction {
+	 void (*handler)(M68000CPU&, uint16_t);  // Handler from the opcode table
+	 uint16_t opcode;                         // Opcode word
+	 uint8_t cycles;                          // Base cycles from the opcode table
+	 uint32_t address;                        // Address of the opcode
+ };
+
+ /**
+  * Straight-line run of instructions starting at one address
+  */
+ struct CachedBlock {
+	 uint32_t startAddress = 0;                    // Address of the first instruction
+	 uint32_t endAddress = 0;                      // Address past the last byte the block may span
+	 std::vector<CachedInstruction> instructions;  // Instructions in execution order
+ };
+
+ M68000BlockCache::M68000BlockCache(M68000CPU& cpu, MemoryManager& memoryManager)
+	 : m_cpu(cpu),
+	   m_memoryManager(memoryManager),
+	   m_lookup(LOOKUP_SIZE, nullptr),
+	   m_pageBlocks(MemoryManager::PAGE_COUNT),
+	   m_exitRequested(false),
+	   m_faulted(false),
+	   m_recordingInvalidated(false) {
+	 m_memoryManager.SetCodeWriteListener(&M68000BlockCache::OnCodeWritten, this);
+ }
+
+ M68000BlockCache::~M68000BlockCache() {
+	 m_memoryManager.SetCodeWriteListener(nullptr, nullptr);
+ }
+
+ int M68000BlockCache::ExecuteBlock(int cycles) {
+	 m_faulted = false;
+
+	 CachedBlock* block = FindBlock(m_cpu.m_registers.pc);
+	 int executed = block ? Run(*block, cycles) : Record(cycles);
+
+	 // No block is running any more
+	 m_retiredBlocks.clear();
+	 return executed;
+ }
+
+ CachedBlock* M68000BlockCache::FindBlock(uint32_t address) {
+	 CachedBlock*& slot = m_lookup[(address >> 1) & (LOOKUP_SIZE - 1)];
+	 if (slot && slot->startAddress == address) {
+		 return slot;
+	 }
+
+	 auto it = m_blocks.find(address);
+	 if (it == m_blocks.end()) {
+		 return nullptr;
+	 }
+	 slot = it->second.get();
+	 return slot;
+ }
+
+ int M68000BlockCache::Run(const CachedBlock& block, int cycles) {
+	 M68000Registers& registers = m_cpu.m_registers;
+
+	 // Cycles build up in m_pendingCycles and are counted once per block
+	 for (const CachedInstruction& instruction : block.instructions) {
+		 // A branch, exception or invalidation left the block
+		 if (registers.pc != instruction.address) {
+			 break;
+		 }
+
+		 m_cpu.m_instructionAddress = instruction.address;
+		 registers.prefetch[0] = instruction.opcode;
+		 registers.pc = instruction.address + 2;
+		 m_cpu.m_pendingCycles += instruction.cycles;
+		 instruction.handler(m_cpu, instruction.opcode);
+
+		 if (m_exitRequested || m_cpu.m_pendingCycles >= cycles) {
+			 break;
+		 }
+	 }
+
+	 int executed = m_cpu.m_pendingCycles;
+	 m_cpu.m_pendingCycles = 0;
+	 m_cpu.m_cycleCount += executed;
+	 return executed;
+ }
+
+ int M68000BlockCache::Record(int cycles) {
+	 M68000Registers& registers = m_cpu.m_registers;
+	 auto block = std::make_unique<CachedBlock>();
+	 block->startAddress = registers.pc;
+	 m_recordingInvalidated = false;
+
+	 int executed = 0;
+	 bool complete = true;
+	 for (;;) {
+		 uint32_t address = registers.pc;
+
+		 // Only plain memory is cached; anything else runs interpreted
+		 if (!m_memoryManager.WatchCodePage(address) ||
+			 !m_memoryManager.WatchCodePage(address + MAX_INSTRUCTION_BYTES - 1)) {
+			 if (block->instructions.empty()) {
+				 return m_cpu.ExecuteInstruction();
+			 }
+			 break;
+		 }
+
+		 uint16_t opcode = m_memoryManager.Read16(address);
+		 const M68000CPU::OpcodeEntry& entry = M68000CPU::s_opcodeTable[opcode];
+		 if (entry.flags & M68000CPU::OPCODE_INTERPRETED) {
+			 if (block->instructions.empty()) {
+				 return m_cpu.ExecuteInstruction();
+			 }
+			 break;
+		 }
+
+		 executed += m_cpu.ExecuteInstruction();
+
+		 // The faulting instruction's length is unknown, so the block ends before it
+		 if (m_faulted) {
+			 break;
+		 }
+
+		 block->instructions.push_back(CachedInstruction{ entry.handler, opcode, entry.cycles, address });
+		 block->endAddress = address + MAX_INSTRUCTION_BYTES;
+
+		 if ((entry.flags & M68000CPU::OPCODE_ENDS_BLOCK) || m_exitRequested ||
+			 block->instructions.size() >= MAX_BLOCK_INSTRUCTIONS || m_cpu.HasHook(registers.pc)) {
+			 break;
+		 }
+
+		 // Out of cycles mid-block: the rest of the block has not been seen yet
+		 if (executed >= cycles) {
+			 complete = false;
+			 break;
+		 }
+	 }
+
+	 if (!complete || m_recordingInvalidated || block->instructions.empty()) {
+		 return executed;
+	 }
+
+	 uint32_t firstPage = (block->startAddress & MemoryManager::ADDRESS_MASK) >> MemoryManager::PAGE_SHIFT;
+	 uint32_t lastPage = ((block->endAddress - 1) & MemoryManager::ADDRESS_MASK) >> MemoryManager::PAGE_SHIFT;
+	 for (uint32_t page = firstPage; ; page = (page + 1) % MemoryManager::PAGE_COUNT) {
+		 std::vector<uint32_t>& starts = m_pageBlocks[page];
+		 if (std::find(starts.begin(), starts.end(), block->startAddress) == starts.end()) {
+			 starts.push_back(block->startAddress);
+		 }
+		 if (page == lastPage) {
+			 break;
+		 }
+	 }
+
+	 uint32_t startAddress = block->startAddress;
+	 m_blocks[startAddress] = std::move(block);
+	 return executed;
+ }
+
+ void M68000BlockCache::Invalidate(uint32_t address, uint32_t size) {
+	 if (size == 0) {
+		 return;
+	 }
+	 if (size >= MemoryManager::ADDRESS_MASK + 1) {
+		 Flush();
+		 return;
+	 }
+
+	 // A block being recorded may overlap the range
+	 m_recordingInvalidated = true;
+
+	 // Blocks are listed under every page they touch
+	 uint32_t firstPage = (address & MemoryManager::ADDRESS_MASK) >> MemoryManager::PAGE_SHIFT;
+	 uint32_t lastPage = ((address + size - 1) & MemoryManager::ADDRESS_MASK) >> MemoryManager::PAGE_SHIFT;
+	 for (uint32_t page = firstPage; ; page = (page + 1) % MemoryManager::PAGE_COUNT) {
+		 for (uint32_t startAddress : m_pageBlocks[page]) {
+			 auto it = m_blocks.find(startAddress);
+			 if (it == m_blocks.end()) {
+				 continue;
+			 }
+			 CachedBlock*& slot = m_lookup[(startAddress >> 1) & (LOOKUP_SIZE - 1)];
+			 if (slot == it->second.get()) {
+				 slot = nullptr;
+			 }
+			 m_retiredBlocks.push_back(std::move(it->second));
+			 m_blocks.erase(it);
+		 }
+		 m_pageBlocks[page].clear();
+		 if (page == lastPage) {
+			 break;
+		 }
+	 }
+
+	 // The running block may have been dropped
+	 m_exitRequested = true;
+ }
+
+ void M68000BlockCache::Flush() {
+	 for (auto& block : m_blocks) {
+		 m_retiredBlocks.push_back(std::move(block.second));
+	 }
+	 m_blocks.clear();
+	 std::fill(m_lookup.begin(), m_lookup.end(), nullptr);
+	 for (auto& starts : m_pageBlocks) {
+		 starts.clear();
+	 }
+	 m_recordingInvalidated = true;
+	 m_exitRequested = true;
+ }
+
+ void M68000BlockCache::OnCodeWritten(void* context, uint32_t address, uint32_t size) {
+	 static_cast<M68000BlockCache*>(context)->Invalidate(address, size);
+ }
+
+ } // namespace NiXX32
@@ -0,0 +1,2501 @@
+/**
+ * M68000CPU.cpp
+ * Implementation of the Motorola 68000 CPU emulation for NiXX-32 arcade board
+ *
+ * Instructions are dispatched through a predecoded table of all 65536
+ * opcodes. Each entry points at a handler instantiated for the opcode's
+ * operand size and addressing modes, so the per-instruction work is a
+ * fetch, one table load and an indirect call; only register numbers are
+ * pulled out of the opcode at run time. The table is built once per
+ * process and shared by every CPU instance.
+ *
+ * Condition codes are evaluated lazily. ADD/SUB/CMP and logic operations
+ * only record their operands and result; X/N/Z/V/C are computed when
+ * something reads them (conditional instructions, SR reads, exceptions,
+ * the debugger). Instructions with unusual flag rules materialize the
+ * pending flags first and then update the SR directly.
+ *
+ * The same handlers back the optional block cache core (M68000BlockCache),
+ * which is why the table also classifies opcodes that end a block.
+ */
+
+ #include "M68000CPU.h"
+ #include "M68000BlockCache.h"
+ #include "MemoryManager.h"
+ #include "NiXX32System.h"
+
+ #include <algorithm>
+ #include <bitset>
+ #include <cstdio>
+ #include <cstring>
+ #include <mutex>
+
+ namespace NiXX32 {
+
+ namespace {
+
+ // Effective address modes, with mode 7 expanded by its register field
+ enum EAMode {
+	 EA_DN = 0,  // Dn
+	 EA_AN,      // An
+	 EA_AI,      // (An)
+	 EA_PI,      // (An)+
+	 EA_PD,      // -(An)
+	 EA_DI,      // d16(An)
+	 EA_IX,      // d8(An,Xn)
+	 EA_AW,      // abs.W
+	 EA_AL,      // abs.L
+	 EA_PCDI,    // d16(PC)
+	 EA_PCIX,    // d8(PC,Xn)
+	 EA_IMM,     // #imm
+	 EA_INVALID
+ };
+
+ // Addressing mode categories, as bitmasks over EAMode
+ constexpr uint16_t EA_ALL = 0x0FFF;
+ constexpr uint16_t EA_DATA = EA_ALL & ~(1 << EA_AN);
+ constexpr uint16_t EA_ALTERABLE = 0x01FF;
+ constexpr uint16_t EA_DATA_ALTERABLE = EA_ALTERABLE & ~(1 << EA_AN);
+ constexpr uint16_t EA_MEMORY_ALTERABLE = EA_DATA_ALTERABLE & ~(1 << EA_DN);
+ constexpr uint16_t EA_CONTROL = (1 << EA_AI) | (1 << EA_DI) | (1 << EA_IX) | (1 << EA_AW) |
+								 (1 << EA_AL) | (1 << EA_PCDI) | (1 << EA_PCIX);
+ constexpr uint16_t EA_CONTROL_ALTERABLE = EA_CONTROL & EA_ALTERABLE;
+
+ // Effective address calculation time for byte/word and long operands
+ constexpr uint8_t EA_CYCLES[2][12] = {
+	 { 0, 0, 4, 4, 6, 8, 10, 8, 12, 8, 10, 4 },
+	 { 0, 0, 8, 8, 10, 12, 14, 12, 16, 12, 14, 8 }
+ };
+
+ // MOVE destination time (no extra -(An) penalty on the write side)
+ constexpr uint8_t MOVE_DEST_CYCLES[2][12] = {
+	 { 0, 0, 4, 4, 4, 8, 10, 8, 12, 0, 0, 0 },
+	 { 0, 0, 8, 8, 8, 12, 14, 12, 16, 0, 0, 0 }
+ };
+
+ // Control addressing timings for LEA, JMP, JSR and MOVEM
+ constexpr uint8_t LEA_CYCLES[12] = { 0, 0, 4, 0, 0, 8, 12, 8, 12, 8, 12, 0 };
+ constexpr uint8_t JMP_CYCLES[12] = { 0, 0, 8, 0, 0, 10, 14, 10, 12, 10, 14, 0 };
+ constexpr uint8_t JSR_CYCLES[12] = { 0, 0, 16, 0, 0, 18, 22, 18, 20, 18, 22, 0 };
+ constexpr uint8_t MOVEM_TO_MEMORY_CYCLES[12] = { 0, 0, 8, 0, 8, 12, 14, 12, 16, 0, 0, 0 };
+ constexpr uint8_t MOVEM_TO_REGISTER_CYCLES[12] = { 0, 0, 12, 12, 0, 16, 18, 16, 20, 16, 18, 0 };
+
+ // Operation selectors for the shared handler templates
+ enum AluOp { ALU_OR, ALU_AND, ALU_SUB, ALU_ADD, ALU_EOR, ALU_CMP };
+ enum BitOp { BIT_TST, BIT_CHG, BIT_CLR, BIT_SET };
+ enum UnaryOp { UNARY_NEGX, UNARY_CLR, UNARY_NEG, UNARY_NOT };
+ enum ShiftOp { SHIFT_AS, SHIFT_LS, SHIFT_ROX, SHIFT_RO };
+
+ // Initial supervisor state after reset: S set, interrupts masked
+ constexpr uint16_t SR_RESET_VALUE = 0x2700;
+
+ // Bits of the status register that exist on the 68000
+ constexpr uint16_t SR_IMPLEMENTED_MASK = 0xA71F;
+ constexpr uint16_t SR_CCR_MASK = 0x001F;
+ constexpr uint16_t SR_INTERRUPT_MASK = 0x0700;
+
+ // Idle bus cycle length used while the CPU is stopped
+ constexpr int IDLE_CYCLES = 4;
+
+ // Longest backward branch checked for an idle polling loop, in bytes
+ constexpr uint32_t IDLE_LOOP_MAX_BYTES = 32;
+
+ // Marks an empty idle loop record or busy loop slot (instructions are even)
+ constexpr uint32_t NO_LOOP = 1;
+
+ // Idle loop register sets: D0-D7 in bits 0-7, A0-A7 in bits 8-15, CCR in bit 16
+ constexpr uint32_t LOOP_CCR = 1u << 16;
+
+ // DBRA Dn, with the register number in bits 0-2
+ constexpr uint16_t DBRA_OPCODE = 0x51C8;
+
+ // Shortest MOVEM list moved through a direct pointer; shorter lists are
+ // cheaper as individual page table accesses
+ constexpr int MOVEM_DIRECT_MIN_REGISTERS = 6;
+
+ int DecodeEA(int mode, int reg) {
+	 if (mode < 7) {
+		 return mode;
+	 }
+	 return reg <= 4 ? EA_AW + reg : EA_INVALID;
+ }
+
+ bool IsAllowed(int ea, uint16_t categories) {
+	 return ea != EA_INVALID && (categories & (1 << ea)) != 0;
+ }
+
+ int EACycles(int ea, int size) {
+	 return EA_CYCLES[size == 4 ? 1 : 0][ea];
+ }
+
+ // Add the registers a source operand reads to reads and step address over
+ // its extension words; false for modes with side effects, and for memory
+ // operands outside plain memory (handler reads may sync another device
+ // whose writes change the value mid-timeslice)
+ bool ReadOnlyOperand(MemoryManager& memory, const M68000Registers& registers, int ea, int reg, int size,
+					  uint32_t& address, uint32_t& reads) {
+	 uint32_t operandAddress = 0;
+	 switch (ea) {
+		 case EA_DN:
+			 reads |= 1u << reg;
+			 return true;
+		 case EA_AN:
+			 reads |= 1u << (8 + reg);
+			 return true;
+		 case EA_AI:
+			 reads |= 1u << (8 + reg);
+			 operandAddress = registers.a[reg];
+			 break;
+		 case EA_DI:
+			 reads |= 1u << (8 + reg);
+			 operandAddress = registers.a[reg] + static_cast<int16_t>(memory.Read16(address));
+			 address += 2;
+			 break;
+		 case EA_IX:
+		 case EA_PCIX: {
+			 uint16_t extension = memory.Read16(address);
+			 int indexRegister = (extension >> 12) & 15;
+			 uint32_t index = indexRegister < 8 ? registers.d[indexRegister] : registers.a[indexRegister - 8];
+			 if (!(extension & 0x0800)) {
+				 index = static_cast<int16_t>(index);
+			 }
+			 reads |= 1u << indexRegister;
+			 if (ea == EA_IX) {
+				 reads |= 1u << (8 + reg);
+			 }
+			 operandAddress = (ea == EA_IX ? registers.a[reg] : address) + static_cast<int8_t>(extension & 0xFF) + index;
+			 address += 2;
+			 break;
+		 }
+		 case EA_AW:
+			 operandAddress = static_cast<int16_t>(memory.Read16(address));
+			 address += 2;
+			 break;
+		 case EA_PCDI:
+			 operandAddress = address + static_cast<int16_t>(memory.Read16(address));
+			 address += 2;
+			 break;
+		 case EA_AL:
+			 operandAddress = memory.Read32(address);
+			 address += 4;
+			 break;
+		 case EA_IMM:
+			 address += (size == 4) ? 4 : 2;
+			 return true;
+		 default:
+			 return false;
+	 }
+	 return memory.IsPlainMemory(operandAddress, size, false);
+ }
+
+ } // namespace
+
+ // Instantiates a handler template for all twelve addressing modes (Mode last)
+ #define M68K_EA_HANDLERS(fn, ...) { \
+	 &fn<__VA_ARGS__, EA_DN>, &fn<__VA_ARGS__, EA_AN>, &fn<__VA_ARGS__, EA_AI>, \
+	 &fn<__VA_ARGS__, EA_PI>, &fn<__VA_ARGS__, EA_PD>, &fn<__VA_ARGS__, EA_DI>, \
+	 &fn<__VA_ARGS__, EA_IX>, &fn<__VA_ARGS__, EA_AW>, &fn<__VA_ARGS__, EA_AL>, \
+	 &fn<__VA_ARGS__, EA_PCDI>, &fn<__VA_ARGS__, EA_PCIX>, &fn<__VA_ARGS__, EA_IMM> }
+
+ // Same, for handler templates whose only parameter is the addressing mode
+ #define M68K_MODE_HANDLERS(fn) { \
+	 &fn<EA_DN>, &fn<EA_AN>, &fn<EA_AI>, &fn<EA_PI>, &fn<EA_PD>, &fn<EA_DI>, \
+	 &fn<EA_IX>, &fn<EA_AW>, &fn<EA_AL>, &fn<EA_PCDI>, &fn<EA_PCIX>, &fn<EA_IMM> }
+
+ // Instantiates a handler template for byte, word and long operands
+ #define M68K_SIZED_HANDLERS(fn, ...) { \
+	 M68K_EA_HANDLERS(fn, __VA_ARGS__, 1), \
+	 M68K_EA_HANDLERS(fn, __VA_ARGS__, 2), \
+	 M68K_EA_HANDLERS(fn, __VA_ARGS__, 4) }
+
+ // MOVE handlers for one size, indexed by source then destination mode
+ #define M68K_MOVE_HANDLERS(size) { \
+	 M68K_EA_HANDLERS(Move, size, EA_DN), M68K_EA_HANDLERS(Move, size, EA_AN), \
+	 M68K_EA_HANDLERS(Move, size, EA_AI), M68K_EA_HANDLERS(Move, size, EA_PI), \
+	 M68K_EA_HANDLERS(Move, size, EA_PD), M68K_EA_HANDLERS(Move, size, EA_DI), \
+	 M68K_EA_HANDLERS(Move, size, EA_IX), M68K_EA_HANDLERS(Move, size, EA_AW), \
+	 M68K_EA_HANDLERS(Move, size, EA_AL), M68K_EA_HANDLERS(Move, size, EA_PCDI), \
+	 M68K_EA_HANDLERS(Move, size, EA_PCIX), M68K_EA_HANDLERS(Move, size, EA_IMM) }
+
+ M68000CPU::OpcodeEntry M68000CPU::s_opcodeTable[0x10000];
+
+ /**
+  * Opcode handlers and the decoder that builds the opcode table
+  */
+ struct M68000Ops {
+	 using Handler = M68000CPU::OpcodeHandler;
+	 using Entry = M68000CPU::OpcodeEntry;
+
+	 // ----- Operand helpers -----
+
+	 template <int Size> static constexpr uint32_t Mask() {
+		 return Size == 1 ? 0xFFu : Size == 2 ? 0xFFFFu : 0xFFFFFFFFu;
+	 }
+
+	 template <int Size> static constexpr uint32_t Msb() {
+		 return Size == 1 ? 0x80u : Size == 2 ? 0x8000u : 0x80000000u;
+	 }
+
+	 template <int Size> static int32_t Signed(uint32_t value) {
+		 if constexpr (Size == 1) {
+			 return static_cast<int8_t>(value);
+		 } else if constexpr (Size == 2) {
+			 return static_cast<int16_t>(value);
+		 } else {
+			 return static_cast<int32_t>(value);
+		 }
+	 }
+
+	 // Dn for index 0-7, An for index 8-15 (MOVEM register list order)
+	 static uint32_t& Register(M68000CPU& cpu, int index) {
+		 return index < 8 ? cpu.m_registers.d[index] : cpu.m_registers.a[index - 8];
+	 }
+
+	 // ----- Bus access -----
+
+	 template <int Size> static uint32_t ReadMemory(M68000CPU& cpu, uint32_t address) {
+		 if constexpr (Size == 1) {
+			 return cpu.m_memoryManager.Read8(address);
+		 } else if constexpr (Size == 2) {
+			 return cpu.m_memoryManager.Read16(address);
+		 } else {
+			 return cpu.m_memoryManager.Read32(address);
+		 }
+	 }
+
+	 template <int Size> static void WriteMemory(M68000CPU& cpu, uint32_t address, uint32_t value) {
+		 if constexpr (Size == 1) {
+			 cpu.m_memoryManager.Write8(address, static_cast<uint8_t>(value));
+		 } else if constexpr (Size == 2) {
+			 cpu.m_memoryManager.Write16(address, static_cast<uint16_t>(value));
+		 } else {
+			 cpu.m_memoryManager.Write32(address, value);
+		 }
+	 }
+
+	 // Direct pointer accesses: byte N of the value is at p[N ^ byteXor]
+	 template <int Size> static uint32_t LoadDirect(const uint8_t* p, uint32_t byteXor) {
+		 uint32_t value = 0;
+		 for (int i = 0; i < Size; i++) {
+			 value = (value << 8) | p[i ^ byteXor];
+		 }
+		 return value;
+	 }
+
+	 template <int Size> static void StoreDirect(uint8_t* p, uint32_t byteXor, uint32_t value) {
+		 for (int i = 0; i < Size; i++) {
+			 p[i ^ byteXor] = static_cast<uint8_t>(value >> (8 * (Size - 1 - i)));
+		 }
+	 }
+
+	 template <int Size> static void FillDirect(uint8_t* p, uint32_t byteXor, uint32_t bytes, uint32_t value) {
+		 value &= Mask<Size>();
+		 if (value == (value & 0xFF) * (Mask<Size>() / 0xFF)) {
+			 // Every byte the same (clearing, mostly), layout does not matter
+			 std::memset(p, static_cast<int>(value & 0xFF), bytes);
+			 return;
+		 }
+		 for (uint32_t offset = 0; offset < bytes; offset += Size) {
+			 StoreDirect<Size>(p + offset, byteXor, value);
+		 }
+	 }
+
+	 static uint16_t FetchWord(M68000CPU& cpu) {
+		 uint16_t value = cpu.m_memoryManager.Read16(cpu.m_registers.pc);
+		 cpu.m_registers.pc += 2;
+		 return value;
+	 }
+
+	 static uint32_t FetchLong(M68000CPU& cpu) {
+		 uint32_t high = FetchWord(cpu);
+		 return (high << 16) | FetchWord(cpu);
+	 }
+
+	 template <int Size> static uint32_t FetchImmediate(M68000CPU& cpu) {
+		 if constexpr (Size == 4) {
+			 return FetchLong(cpu);
+		 } else {
+			 return FetchWord(cpu) & Mask<Size>();
+		 }
+	 }
+
+	 // Brief extension word: d8 + base + Xn (word or long index)
+	 static uint32_t IndexedAddress(M68000CPU& cpu, uint32_t base) {
+		 uint16_t extension = FetchWord(cpu);
+		 int reg = (extension >> 12) & 7;
+		 uint32_t index = (extension & 0x8000) ? cpu.m_registers.a[reg] : cpu.m_registers.d[reg];
+		 if (!(extension & 0x0800)) {
+			 index = static_cast<uint32_t>(static_cast<int16_t>(index));
+		 }
+		 return base + index + static_cast<uint32_t>(static_cast<int8_t>(extension & 0xFF));
+	 }
+
+	 // ----- Effective addresses -----
+
+	 /**
+	  * Calculate a memory effective address, applying (An)+ / -(An) updates
+	  */
+	 template <int Mode, int Size> static uint32_t Address(M68000CPU& cpu, int reg) {
+		 M68000Registers& r = cpu.m_registers;
+		 // Byte accesses through A7 keep the stack word aligned
+		 constexpr uint32_t step = Size;
+		 if constexpr (Mode == EA_AI) {
+			 return r.a[reg];
+		 } else if constexpr (Mode == EA_PI) {
+			 uint32_t address = r.a[reg];
+			 r.a[reg] += (Size == 1 && reg == 7) ? 2 : step;
+			 return address;
+		 } else if constexpr (Mode == EA_PD) {
+			 r.a[reg] -= (Size == 1 && reg == 7) ? 2 : step;
+			 return r.a[reg];
+		 } else if constexpr (Mode == EA_DI) {
+			 uint32_t base = r.a[reg];
+			 return base + static_cast<uint32_t>(static_cast<int16_t>(FetchWord(cpu)));
+		 } else if constexpr (Mode == EA_IX) {
+			 return IndexedAddress(cpu, r.a[reg]);
+		 } else if constexpr (Mode == EA_AW) {
+			 return static_cast<uint32_t>(static_cast<int16_t>(FetchWord(cpu)));
+		 } else if constexpr (Mode == EA_AL) {
+			 return FetchLong(cpu);
+		 } else if constexpr (Mode == EA_PCDI) {
+			 uint32_t base = r.pc;
+			 return base + static_cast<uint32_t>(static_cast<int16_t>(FetchWord(cpu)));
+		 } else if constexpr (Mode == EA_PCIX) {
+			 return IndexedAddress(cpu, r.pc);
+		 } else {
+			 return 0;
+		 }
+	 }
+
+	 /**
+	  * Read an operand; for memory modes the address is returned for a later write
+	  */
+	 template <int Mode, int Size> static uint32_t Read(M68000CPU& cpu, int reg, uint32_t& address) {
+		 if constexpr (Mode == EA_DN) {
+			 return cpu.m_registers.d[reg] & Mask<Size>();
+		 } else if constexpr (Mode == EA_AN) {
+			 return cpu.m_registers.a[reg] & Mask<Size>();
+		 } else if constexpr (Mode == EA_IMM) {
+			 return FetchImmediate<Size>(cpu);
+		 } else {
+			 address = Address<Mode, Size>(cpu, reg);
+			 return ReadMemory<Size>(cpu, address);
+		 }
+	 }
+
+	 template <int Mode, int Size> static uint32_t Read(M68000CPU& cpu, int reg) {
+		 uint32_t address = 0;
+		 return Read<Mode, Size>(cpu, reg, address);
+	 }
+
+	 /**
+	  * Write an operand whose address was already calculated by Read()
+	  */
+	 template <int Mode, int Size> static void Write(M68000CPU& cpu, int reg, uint32_t address, uint32_t value) {
+		 if constexpr (Mode == EA_DN) {
+			 uint32_t& d = cpu.m_registers.d[reg];
+			 d = (d & ~Mask<Size>()) | (value & Mask<Size>());
+		 } else if constexpr (Mode == EA_AN) {
+			 cpu.m_registers.a[reg] = value;
+		 } else if constexpr (Mode >= EA_AI && Mode <= EA_AL) {
+			 WriteMemory<Size>(cpu, address, value);
+		 }
+		 // PC-relative and immediate operands are never destinations
+	 }
+
+	 /**
+	  * Write to a destination that is not read first
+	  */
+	 template <int Mode, int Size> static void WriteTo(M68000CPU& cpu, int reg, uint32_t value) {
+		 uint32_t address = 0;
+		 if constexpr (Mode >= EA_AI && Mode <= EA_AL) {
+			 address = Address<Mode, Size>(cpu, reg);
+		 }
+		 Write<Mode, Size>(cpu, reg, address, value);
+	 }
+
+	 // ----- Condition codes -----
+
+	 template <int Size> static void SetLogicFlags(M68000CPU& cpu, uint32_t result) {
+		 cpu.m_flags = { 0, 0, result & Mask<Size>(), Size, M68000CPU::FlagsOp::LOGIC };
+	 }
+
+	 // Flags of a compare: like SUB, but X is left alone
+	 template <int Size> static void SetCompareFlags(M68000CPU& cpu, uint32_t src, uint32_t dst, uint32_t result) {
+		 cpu.m_flags = { src, dst, result, Size, M68000CPU::FlagsOp::SUB };
+	 }
+
+	 static bool TestCondition(const M68000CPU& cpu, int condition) {
+		 const M68000CPU::LazyFlags& flags = cpu.m_flags;
+		 // Equality tests are the most common and only need the result
+		 if (flags.op != M68000CPU::FlagsOp::NONE && (condition == 0x6 || condition == 0x7)) {
+			 return (flags.result == 0) == (condition == 0x7);
+		 }
+		 uint16_t sr = cpu.ComputeConditionCodes();
+		 bool c = (sr & SR_C) != 0;
+		 bool v = (sr & SR_V) != 0;
+		 bool z = (sr & SR_Z) != 0;
+		 bool n = (sr & SR_N) != 0;
+		 switch (condition) {
+			 case 0x0: return true;               // T
+			 case 0x1: return false;              // F
+			 case 0x2: return !c && !z;           // HI
+			 case 0x3: return c || z;             // LS
+			 case 0x4: return !c;                 // CC
+			 case 0x5: return c;                  // CS
+			 case 0x6: return !z;                 // NE
+			 case 0x7: return z;                  // EQ
+			 case 0x8: return !v;                 // VC
+			 case 0x9: return v;                  // VS
+			 case 0xA: return !n;                 // PL
+			 case 0xB: return n;                  // MI
+			 case 0xC: return n == v;             // GE
+			 case 0xD: return n != v;             // LT
+			 case 0xE: return !z && n == v;       // GT
+			 default:  return z || n != v;        // LE
+		 }
+	 }
+
+	 /**
+	  * Two-operand ALU operation (dst op src), setting the condition codes
+	  */
+	 template <int Op, int Size> static uint32_t Alu(M68000CPU& cpu, uint32_t src, uint32_t dst) {
+		 uint32_t result;
+		 if constexpr (Op == ALU_OR) {
+			 result = (dst | src) & Mask<Size>();
+			 SetLogicFlags<Size>(cpu, result);
+		 } else if constexpr (Op == ALU_AND) {
+			 result = (dst & src) & Mask<Size>();
+			 SetLogicFlags<Size>(cpu, result);
+		 } else if constexpr (Op == ALU_EOR) {
+			 result = (dst ^ src) & Mask<Size>();
+			 SetLogicFlags<Size>(cpu, result);
+		 } else if constexpr (Op == ALU_ADD) {
+			 result = (dst + src) & Mask<Size>();
+			 cpu.UpdateConditionCodes(src, dst, result, Size, true);
+		 } else if constexpr (Op == ALU_SUB) {
+			 result = (dst - src) & Mask<Size>();
+			 cpu.UpdateConditionCodes(src, dst, result, Size, false);
+		 } else {
+			 result = (dst - src) & Mask<Size>();
+			 SetCompareFlags<Size>(cpu, src, dst, result);
+		 }
+		 return result;
+	 }
+
+	 /**
+	  * ADDX/SUBX/NEGX arithmetic: Z is only ever cleared
+	  */
+	 template <bool IsAdd, int Size> static uint32_t AluExtended(M68000CPU& cpu, uint32_t src, uint32_t dst) {
+		 cpu.MaterializeFlags();
+		 uint32_t extend = (cpu.m_registers.sr & SR_X) ? 1 : 0;
+		 uint16_t zero = cpu.m_registers.sr & SR_Z;
+		 uint32_t result = (IsAdd ? dst + src + extend : dst - src - extend) & Mask<Size>();
+		 cpu.UpdateConditionCodes(src, dst, result, Size, IsAdd);
+		 if (result == 0) {
+			 cpu.MaterializeFlags();
+			 cpu.m_registers.sr = (cpu.m_registers.sr & ~SR_Z) | zero;
+		 }
+		 return result;
+	 }
+
+	 // Packed BCD add/subtract with X; Z is only ever cleared
+	 static uint32_t BcdAdd(M68000CPU& cpu, uint32_t src, uint32_t dst) {
+		 cpu.MaterializeFlags();
+		 uint16_t& sr = cpu.m_registers.sr;
+		 uint32_t result = (src & 0x0F) + (dst & 0x0F) + ((sr & SR_X) ? 1 : 0);
+		 if (result > 9) {
+			 result += 6;
+		 }
+		 result += (src & 0xF0) + (dst & 0xF0);
+		 bool carry = result > 0x99;
+		 if (carry) {
+			 result -= 0xA0;
+		 }
+		 return SetBcdFlags(cpu, result & 0xFF, carry);
+	 }
+
+	 static uint32_t BcdSubtract(M68000CPU& cpu, uint32_t src, uint32_t dst) {
+		 cpu.MaterializeFlags();
+		 uint16_t& sr = cpu.m_registers.sr;
+		 uint32_t result = (dst & 0x0F) - (src & 0x0F) - ((sr & SR_X) ? 1 : 0);
+		 if (result > 9) {
+			 result -= 6;
+		 }
+		 result += (dst & 0xF0) - (src & 0xF0);
+		 bool carry = result > 0x99;
+		 if (carry) {
+			 result += 0xA0;
+		 }
+		 return SetBcdFlags(cpu, result & 0xFF, carry);
+	 }
+
+	 static uint32_t SetBcdFlags(M68000CPU& cpu, uint32_t result, bool carry) {
+		 uint16_t& sr = cpu.m_registers.sr;
+		 sr &= ~(SR_X | SR_N | SR_V | SR_C);
+		 if (carry) {
+			 sr |= SR_X | SR_C;
+		 }
+		 if (result & 0x80) {
+			 sr |= SR_N;
+		 }
+		 if (result != 0) {
+			 sr &= ~SR_Z;
+		 }
+		 return result;
+	 }
+
+	 /**
+	  * Shift or rotate by count bits, setting the condition codes
+	  */
+	 template <int Op, bool Left, int Size> static uint32_t Shift(M68000CPU& cpu, uint32_t value, int count) {
+		 constexpr int bits = Size * 8;
+		 cpu.MaterializeFlags();
+		 uint16_t& sr = cpu.m_registers.sr;
+		 value &= Mask<Size>();
+		 uint32_t result = value;
+		 bool carry = false;
+		 bool overflow = false;
+
+		 if constexpr (Op == SHIFT_ROX) {
+			 bool extend = (sr & SR_X) != 0;
+			 for (int i = 0; i < count; i++) {
+				 bool out;
+				 if (Left) {
+					 out = (result & Msb<Size>()) != 0;
+					 result = ((result << 1) | (extend ? 1 : 0)) & Mask<Size>();
+				 } else {
+					 out = (result & 1) != 0;
+					 result = (result >> 1) | (extend ? Msb<Size>() : 0);
+				 }
+				 extend = out;
+			 }
+			 carry = extend;
+			 sr = (sr & ~SR_X) | (extend ? SR_X : 0);
+		 } else if (count > 0) {
+			 if constexpr (Op == SHIFT_RO) {
+				 int n = count % bits;
+				 if (n != 0) {
+					 result = Left ? ((value << n) | (value >> (bits - n))) & Mask<Size>()
+								   : ((value >> n) | (value << (bits - n))) & Mask<Size>();
+				 }
+				 carry = Left ? (result & 1) != 0 : (result & Msb<Size>()) != 0;
+			 } else if constexpr (Left) {
+				 uint64_t wide = static_cast<uint64_t>(value) << std::min(count, bits + 1);
+				 carry = count <= bits && ((wide >> bits) & 1) != 0;
+				 result = static_cast<uint32_t>(wide) & Mask<Size>();
+				 if constexpr (Op == SHIFT_AS) {
+					 // V: the sign bit changed at any point during the shift
+					 if (count >= bits) {
+						 overflow = value != 0;
+					 } else {
+						 uint32_t top = Mask<Size>() & ~static_cast<uint32_t>(Mask<Size>() >> (count + 1));
+						 overflow = (value & top) != 0 && (value & top) != top;
+					 }
+				 }
+			 } else if constexpr (Op == SHIFT_AS) {
+				 int64_t sign = Signed<Size>(value);
+				 int n = std::min(count, bits);
+				 carry = ((sign >> (n - 1)) & 1) != 0;
+				 result = static_cast<uint32_t>(sign >> n) & Mask<Size>();
+			 } else {
+				 carry = count <= bits && ((static_cast<uint64_t>(value) >> (count - 1)) & 1) != 0;
+				 result = count < bits ? value >> count : 0;
+			 }
+			 if constexpr (Op != SHIFT_RO) {
+				 sr = (sr & ~SR_X) | (carry ? SR_X : 0);
+			 }
+		 }
+
+		 sr &= ~(SR_N | SR_Z | SR_V | SR_C);
+		 if (carry) {
+			 sr |= SR_C;
+		 }
+		 if (overflow) {
+			 sr |= SR_V;
+		 }
+		 if (result == 0) {
+			 sr |= SR_Z;
+		 }
+		 if (result & Msb<Size>()) {
+			 sr |= SR_N;
+		 }
+		 return result;
+	 }
+
+	 // ----- Exceptions -----
+
+	 // Exceptions that stack the address of the faulting instruction itself
+	 static void InstructionException(M68000CPU& cpu, ExceptionType type) {
+		 cpu.m_registers.pc = cpu.m_instructionAddress;
+		 cpu.TriggerException(type);
+	 }
+
+	 static bool RequireSupervisor(M68000CPU& cpu) {
+		 if (cpu.m_registers.sr & SR_S) {
+			 return true;
+		 }
+		 InstructionException(cpu, ExceptionType::PRIVILEGE_VIOLATION);
+		 return false;
+	 }
+
+	 // ----- Handlers: immediate and bit operations (group 0) -----
+
+	 template <int Op, int Size, int Mode> static void Immediate(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = FetchImmediate<Size>(cpu);
+		 int reg = opcode & 7;
+		 uint32_t address = 0;
+		 uint32_t dst = Read<Mode, Size>(cpu, reg, address);
+		 uint32_t result = Alu<Op, Size>(cpu, src, dst);
+		 if constexpr (Op != ALU_CMP) {
+			 Write<Mode, Size>(cpu, reg, address, result);
+		 }
+	 }
+
+	 template <int Op> static void ImmediateToCCR(M68000CPU& cpu, uint16_t) {
+		 uint16_t value = FetchWord(cpu) & SR_CCR_MASK;
+		 uint16_t sr = cpu.GetSR();
+		 if constexpr (Op == ALU_OR) {
+			 sr |= value;
+		 } else if constexpr (Op == ALU_AND) {
+			 sr &= value | ~SR_CCR_MASK;
+		 } else {
+			 sr ^= value;
+		 }
+		 cpu.SetSR(sr);
+	 }
+
+	 template <int Op> static void ImmediateToSR(M68000CPU& cpu, uint16_t) {
+		 if (!RequireSupervisor(cpu)) {
+			 return;
+		 }
+		 uint16_t value = FetchWord(cpu);
+		 uint16_t sr = cpu.GetSR();
+		 if constexpr (Op == ALU_OR) {
+			 sr |= value;
+		 } else if constexpr (Op == ALU_AND) {
+			 sr &= value;
+		 } else {
+			 sr ^= value;
+		 }
+		 cpu.SetSR(sr);
+	 }
+
+	 template <int Op, int Mode> static void BitOperation(M68000CPU& cpu, uint16_t opcode, uint32_t bit) {
+		 // Register operands are long, memory operands are bytes
+		 constexpr int Size = Mode == EA_DN ? 4 : 1;
+		 int reg = opcode & 7;
+		 uint32_t address = 0;
+		 uint32_t value = Read<Mode, Size>(cpu, reg, address);
+		 uint32_t mask = 1u << (bit & (Size * 8 - 1));
+		 cpu.MaterializeFlags();
+		 uint16_t& sr = cpu.m_registers.sr;
+		 sr = (value & mask) ? (sr & ~SR_Z) : (sr | SR_Z);
+		 if constexpr (Op == BIT_CHG) {
+			 value ^= mask;
+		 } else if constexpr (Op == BIT_CLR) {
+			 value &= ~mask;
+		 } else if constexpr (Op == BIT_SET) {
+			 value |= mask;
+		 }
+		 if constexpr (Op != BIT_TST) {
+			 Write<Mode, Size>(cpu, reg, address, value);
+		 }
+	 }
+
+	 template <int Op, int Mode> static void BitDynamic(M68000CPU& cpu, uint16_t opcode) {
+		 BitOperation<Op, Mode>(cpu, opcode, cpu.m_registers.d[(opcode >> 9) & 7]);
+	 }
+
+	 template <int Op, int Mode> static void BitStatic(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t bit = FetchWord(cpu) & 0xFF;
+		 BitOperation<Op, Mode>(cpu, opcode, bit);
+	 }
+
+	 template <bool ToMemory, int Size> static void Movep(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t& d = cpu.m_registers.d[(opcode >> 9) & 7];
+		 uint32_t address = cpu.m_registers.a[opcode & 7] + static_cast<uint32_t>(static_cast<int16_t>(FetchWord(cpu)));
+		 if constexpr (ToMemory) {
+			 for (int shift = (Size - 1) * 8; shift >= 0; shift -= 8, address += 2) {
+				 cpu.m_memoryManager.Write8(address, static_cast<uint8_t>(d >> shift));
+			 }
+		 } else {
+			 uint32_t value = 0;
+			 for (int i = 0; i < Size; i++, address += 2) {
+				 value = (value << 8) | cpu.m_memoryManager.Read8(address);
+			 }
+			 d = (d & ~Mask<Size>()) | value;
+		 }
+	 }
+
+	 // ----- Handlers: moves (groups 1-3, 7) -----
+
+	 template <int Size, int Src, int Dst> static void Move(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t value = Read<Src, Size>(cpu, opcode & 7);
+		 WriteTo<Dst, Size>(cpu, (opcode >> 9) & 7, value);
+		 SetLogicFlags<Size>(cpu, value);
+	 }
+
+	 template <int Size, int Src> static void Movea(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t value = Read<Src, Size>(cpu, opcode & 7);
+		 cpu.m_registers.a[(opcode >> 9) & 7] = static_cast<uint32_t>(Signed<Size>(value));
+	 }
+
+	 static void Moveq(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t value = static_cast<uint32_t>(static_cast<int8_t>(opcode & 0xFF));
+		 cpu.m_registers.d[(opcode >> 9) & 7] = value;
+		 SetLogicFlags<4>(cpu, value);
+	 }
+
+	 // ----- Handlers: miscellaneous (group 4) -----
+
+	 template <int Op, int Size, int Mode> static void Unary(M68000CPU& cpu, uint16_t opcode) {
+		 int reg = opcode & 7;
+		 if constexpr (Op == UNARY_CLR) {
+			 WriteTo<Mode, Size>(cpu, reg, 0);
+			 SetLogicFlags<Size>(cpu, 0);
+		 } else {
+			 uint32_t address = 0;
+			 uint32_t value = Read<Mode, Size>(cpu, reg, address);
+			 uint32_t result;
+			 if constexpr (Op == UNARY_NEGX) {
+				 result = AluExtended<false, Size>(cpu, value, 0);
+			 } else if constexpr (Op == UNARY_NEG) {
+				 result = Alu<ALU_SUB, Size>(cpu, value, 0);
+			 } else {
+				 result = ~value & Mask<Size>();
+				 SetLogicFlags<Size>(cpu, result);
+			 }
+			 Write<Mode, Size>(cpu, reg, address, result);
+		 }
+	 }
+
+	 template <int Mode> static void MoveFromSR(M68000CPU& cpu, uint16_t opcode) {
+		 WriteTo<Mode, 2>(cpu, opcode & 7, cpu.GetSR());
+	 }
+
+	 template <int Mode> static void MoveToCCR(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t value = Read<Mode, 2>(cpu, opcode & 7);
+		 cpu.SetSR((cpu.m_registers.sr & ~SR_CCR_MASK) | (value & SR_CCR_MASK));
+	 }
+
+	 template <int Mode> static void MoveToSR(M68000CPU& cpu, uint16_t opcode) {
+		 if (!RequireSupervisor(cpu)) {
+			 return;
+		 }
+		 cpu.SetSR(static_cast<uint16_t>(Read<Mode, 2>(cpu, opcode & 7)));
+	 }
+
+	 template <int Mode> static void Nbcd(M68000CPU& cpu, uint16_t opcode) {
+		 int reg = opcode & 7;
+		 uint32_t address = 0;
+		 uint32_t value = Read<Mode, 1>(cpu, reg, address);
+		 Write<Mode, 1>(cpu, reg, address, BcdSubtract(cpu, value, 0));
+	 }
+
+	 template <int Mode> static void Lea(M68000CPU& cpu, uint16_t opcode) {
+		 cpu.m_registers.a[(opcode >> 9) & 7] = Address<Mode, 4>(cpu, opcode & 7);
+	 }
+
+	 template <int Mode> static void Pea(M68000CPU& cpu, uint16_t opcode) {
+		 cpu.PushLong(Address<Mode, 4>(cpu, opcode & 7));
+	 }
+
+	 template <int Mode> static void Jmp(M68000CPU& cpu, uint16_t opcode) {
+		 cpu.m_registers.pc = Address<Mode, 4>(cpu, opcode & 7);
+	 }
+
+	 template <int Mode> static void Jsr(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t target = Address<Mode, 4>(cpu, opcode & 7);
+		 cpu.PushLong(cpu.m_registers.pc);
+		 cpu.m_registers.pc = target;
+	 }
+
+	 template <int Mode> static void Chk(M68000CPU& cpu, uint16_t opcode) {
+		 int16_t bound = static_cast<int16_t>(Read<Mode, 2>(cpu, opcode & 7));
+		 int16_t value = static_cast<int16_t>(cpu.m_registers.d[(opcode >> 9) & 7]);
+		 if (value < 0 || value > bound) {
+			 cpu.MaterializeFlags();
+			 uint16_t& sr = cpu.m_registers.sr;
+			 sr = value < 0 ? (sr | SR_N) : (sr & ~SR_N);
+			 cpu.TriggerException(ExceptionType::CHK_INSTRUCTION);
+		 }
+	 }
+
+	 template <int Size, int Mode> static void Tst(M68000CPU& cpu, uint16_t opcode) {
+		 SetLogicFlags<Size>(cpu, Read<Mode, Size>(cpu, opcode & 7));
+	 }
+
+	 template <int Mode> static void Tas(M68000CPU& cpu, uint16_t opcode) {
+		 int reg = opcode & 7;
+		 uint32_t address = 0;
+		 uint32_t value = Read<Mode, 1>(cpu, reg, address);
+		 SetLogicFlags<1>(cpu, value);
+		 Write<Mode, 1>(cpu, reg, address, value | 0x80);
+	 }
+
+	 static uint16_t ReverseList(uint16_t list) {
+		 uint16_t reversed = 0;
+		 for (int i = 0; i < 16; i++) {
+			 reversed |= static_cast<uint16_t>(((list >> i) & 1) << (15 - i));
+		 }
+		 return reversed;
+	 }
+
+	 // Move a register list (bit i is register i, lowest address first) in
+	 // one go if it lies in plain memory, else return false
+	 template <bool ToMemory, int Size> static bool MovemDirect(M68000CPU& cpu, uint32_t address, uint16_t list, int count) {
+		 uint32_t bytes = static_cast<uint32_t>(count) * Size;
+		 MemoryManager& memory = cpu.m_memoryManager;
+		 if ((address & 1) != 0 || !memory.IsPlainMemory(address, bytes, ToMemory)) {
+			 return false;
+		 }
+		 uint8_t* p = memory.GetDirectPointer(address, bytes);
+		 if (!p) {
+			 return false;
+		 }
+
+		 uint32_t byteXor = memory.GetByteAddressXor(address);
+		 for (int i = 0; i < 16; i++) {
+			 if (list & (1 << i)) {
+				 if constexpr (ToMemory) {
+					 StoreDirect<Size>(p, byteXor, Register(cpu, i));
+				 } else {
+					 Register(cpu, i) = static_cast<uint32_t>(Signed<Size>(LoadDirect<Size>(p, byteXor)));
+				 }
+				 p += Size;
+			 }
+		 }
+		 if constexpr (ToMemory) {
+			 memory.MarkWritten(address, bytes);
+		 }
+		 return true;
+	 }
+
+	 template <bool ToMemory, int Size, int Mode> static void Movem(M68000CPU& cpu, uint16_t opcode) {
+		 uint16_t list = FetchWord(cpu);
+		 int reg = opcode & 7;
+		 int count = static_cast<int>(std::bitset<16>(list).count());
+		 bool direct = count >= MOVEM_DIRECT_MIN_REGISTERS;
+
+		 if constexpr (ToMemory && Mode == EA_PD) {
+			 // Predecrement lists are reversed: bit 0 is A7, bit 15 is D0
+			 uint32_t address = cpu.m_registers.a[reg];
+			 if (direct && MovemDirect<true, Size>(cpu, address - count * Size, ReverseList(list), count)) {
+				 address -= count * Size;
+			 } else {
+				 for (int i = 0; i < 16; i++) {
+					 if (list & (1 << i)) {
+						 address -= Size;
+						 WriteMemory<Size>(cpu, address, Register(cpu, 15 - i));
+					 }
+				 }
+			 }
+			 cpu.m_registers.a[reg] = address;
+		 } else if constexpr (ToMemory) {
+			 uint32_t address = Address<Mode, Size>(cpu, reg);
+			 if (!direct || !MovemDirect<true, Size>(cpu, address, list, count)) {
+				 for (int i = 0; i < 16; i++) {
+					 if (list & (1 << i)) {
+						 WriteMemory<Size>(cpu, address, Register(cpu, i));
+						 address += Size;
+					 }
+				 }
+			 }
+		 } else {
+			 uint32_t address = Mode == EA_PI ? cpu.m_registers.a[reg] : Address<Mode, Size>(cpu, reg);
+			 if (direct && MovemDirect<false, Size>(cpu, address, list, count)) {
+				 address += count * Size;
+			 } else {
+				 for (int i = 0; i < 16; i++) {
+					 if (list & (1 << i)) {
+						 // Words are sign-extended into the whole register
+						 Register(cpu, i) = static_cast<uint32_t>(Signed<Size>(ReadMemory<Size>(cpu, address)));
+						 address += Size;
+					 }
+				 }
+			 }
+			 if constexpr (Mode == EA_PI) {
+				 cpu.m_registers.a[reg] = address;
+			 }
+		 }
+
+		 cpu.m_pendingCycles += count * (Size == 4 ? 8 : 4);
+	 }
+
+	 static void Swap(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t& d = cpu.m_registers.d[opcode & 7];
+		 d = (d >> 16) | (d << 16);
+		 SetLogicFlags<4>(cpu, d);
+	 }
+
+	 template <int Size> static void Ext(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t& d = cpu.m_registers.d[opcode & 7];
+		 if constexpr (Size == 2) {
+			 d = (d & 0xFFFF0000) | (static_cast<uint32_t>(Signed<1>(d)) & 0xFFFF);
+		 } else {
+			 d = static_cast<uint32_t>(Signed<2>(d));
+		 }
+		 SetLogicFlags<Size>(cpu, d);
+	 }
+
+	 static void Illegal(M68000CPU& cpu, uint16_t) {
+		 InstructionException(cpu, ExceptionType::ILLEGAL_INSTRUCTION);
+	 }
+
+	 static void LineA(M68000CPU& cpu, uint16_t) {
+		 InstructionException(cpu, ExceptionType::LINE_A_EMULATOR);
+	 }
+
+	 static void LineF(M68000CPU& cpu, uint16_t) {
+		 InstructionException(cpu, ExceptionType::LINE_F_EMULATOR);
+	 }
+
+	 static void Trap(M68000CPU& cpu, uint16_t opcode) {
+		 cpu.TriggerException(ExceptionType::TRAP, opcode & 0x0F);
+	 }
+
+	 static void Trapv(M68000CPU& cpu, uint16_t) {
+		 if (cpu.GetSR() & SR_V) {
+			 cpu.TriggerException(ExceptionType::TRAPV_INSTRUCTION);
+		 }
+	 }
+
+	 static void Link(M68000CPU& cpu, uint16_t opcode) {
+		 int reg = opcode & 7;
+		 M68000Registers& r = cpu.m_registers;
+		 // LINK A7 stores the already decremented stack pointer
+		 cpu.PushLong(reg == 7 ? r.a[7] - 4 : r.a[reg]);
+		 r.a[reg] = r.a[7];
+		 r.a[7] += static_cast<uint32_t>(static_cast<int16_t>(FetchWord(cpu)));
+	 }
+
+	 static void Unlk(M68000CPU& cpu, uint16_t opcode) {
+		 int reg = opcode & 7;
+		 cpu.m_registers.a[7] = cpu.m_registers.a[reg];
+		 cpu.m_registers.a[reg] = cpu.PopLong();
+	 }
+
+	 static void MoveUsp(M68000CPU& cpu, uint16_t opcode) {
+		 if (!RequireSupervisor(cpu)) {
+			 return;
+		 }
+		 // In supervisor mode the user stack pointer lives in usp
+		 uint32_t& a = cpu.m_registers.a[opcode & 7];
+		 if (opcode & 0x08) {
+			 a = cpu.m_registers.usp;
+		 } else {
+			 cpu.m_registers.usp = a;
+		 }
+	 }
+
+	 static void ResetDevices(M68000CPU& cpu, uint16_t) {
+		 // Asserts RESET to external devices only; the CPU itself carries on
+		 RequireSupervisor(cpu);
+	 }
+
+	 static void Nop(M68000CPU&, uint16_t) {
+	 }
+
+	 static void Stop(M68000CPU& cpu, uint16_t) {
+		 if (!RequireSupervisor(cpu)) {
+			 return;
+		 }
+		 cpu.SetSR(FetchWord(cpu));
+		 cpu.m_state = CPUState::HALTED;
+	 }
+
+	 static void Rte(M68000CPU& cpu, uint16_t) {
+		 if (!RequireSupervisor(cpu)) {
+			 return;
+		 }
+		 uint16_t sr = cpu.PopWord();
+		 cpu.m_registers.pc = cpu.PopLong();
+		 cpu.SetSR(sr);
+	 }
+
+	 static void Rts(M68000CPU& cpu, uint16_t) {
+		 cpu.m_registers.pc = cpu.PopLong();
+	 }
+
+	 static void Rtr(M68000CPU& cpu, uint16_t) {
+		 uint16_t ccr = cpu.PopWord();
+		 cpu.m_registers.pc = cpu.PopLong();
+		 cpu.SetSR((cpu.m_registers.sr & ~SR_CCR_MASK) | (ccr & SR_CCR_MASK));
+	 }
+
+	 // ----- Handlers: quick arithmetic, Scc, DBcc, branches (groups 5-6) -----
+
+	 template <int Op, int Size, int Mode> static void Quick(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t data = (opcode >> 9) & 7;
+		 if (data == 0) {
+			 data = 8;
+		 }
+		 int reg = opcode & 7;
+		 if constexpr (Mode == EA_AN) {
+			 // Address register destinations are always long and leave the flags alone
+			 cpu.m_registers.a[reg] += Op == ALU_ADD ? data : 0u - data;
+		 } else {
+			 uint32_t address = 0;
+			 uint32_t dst = Read<Mode, Size>(cpu, reg, address);
+			 Write<Mode, Size>(cpu, reg, address, Alu<Op, Size>(cpu, data, dst));
+		 }
+	 }
+
+	 template <int Mode> static void Scc(M68000CPU& cpu, uint16_t opcode) {
+		 bool condition = TestCondition(cpu, (opcode >> 8) & 0x0F);
+		 WriteTo<Mode, 1>(cpu, opcode & 7, condition ? 0xFF : 0x00);
+		 if (Mode == EA_DN && condition) {
+			 cpu.m_pendingCycles += 2;
+		 }
+	 }
+
+	 static void Dbcc(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t base = cpu.m_registers.pc;
+		 int16_t displacement = static_cast<int16_t>(FetchWord(cpu));
+		 if (TestCondition(cpu, (opcode >> 8) & 0x0F)) {
+			 cpu.m_pendingCycles += 2;
+			 return;
+		 }
+		 uint32_t& d = cpu.m_registers.d[opcode & 7];
+		 uint16_t counter = static_cast<uint16_t>(d) - 1;
+		 d = (d & 0xFFFF0000) | counter;
+		 if (counter != 0xFFFF) {
+			 cpu.m_registers.pc = base + static_cast<uint32_t>(displacement);
+		 } else {
+			 cpu.m_pendingCycles += 4;
+		 }
+	 }
+
+	 template <int Condition> static void Branch(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t base = cpu.m_registers.pc;
+		 int32_t displacement = static_cast<int8_t>(opcode & 0xFF);
+		 bool wordDisplacement = displacement == 0;
+		 if (wordDisplacement) {
+			 displacement = static_cast<int16_t>(FetchWord(cpu));
+		 }
+		 if constexpr (Condition == 1) {
+			 // BSR
+			 cpu.PushLong(cpu.m_registers.pc);
+			 cpu.m_registers.pc = base + static_cast<uint32_t>(displacement);
+		 } else if (TestCondition(cpu, Condition)) {
+			 cpu.m_registers.pc = base + static_cast<uint32_t>(displacement);
+		 } else {
+			 cpu.m_pendingCycles += wordDisplacement ? 2 : -2;
+		 }
+	 }
+
+	 // ----- Handlers: register/memory ALU forms (groups 8, 9, B, C, D) -----
+
+	 template <int Op, int Size, int Mode> static void AluToRegister(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = Read<Mode, Size>(cpu, opcode & 7);
+		 uint32_t& d = cpu.m_registers.d[(opcode >> 9) & 7];
+		 uint32_t result = Alu<Op, Size>(cpu, src, d & Mask<Size>());
+		 if constexpr (Op != ALU_CMP) {
+			 d = (d & ~Mask<Size>()) | result;
+		 }
+	 }
+
+	 template <int Op, int Size, int Mode> static void AluToMemory(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = cpu.m_registers.d[(opcode >> 9) & 7] & Mask<Size>();
+		 int reg = opcode & 7;
+		 uint32_t address = 0;
+		 uint32_t dst = Read<Mode, Size>(cpu, reg, address);
+		 Write<Mode, Size>(cpu, reg, address, Alu<Op, Size>(cpu, src, dst));
+	 }
+
+	 template <int Op, int Size, int Mode> static void AluAddress(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = static_cast<uint32_t>(Signed<Size>(Read<Mode, Size>(cpu, opcode & 7)));
+		 uint32_t& a = cpu.m_registers.a[(opcode >> 9) & 7];
+		 if constexpr (Op == ALU_ADD) {
+			 a += src;
+		 } else if constexpr (Op == ALU_SUB) {
+			 a -= src;
+		 } else {
+			 Alu<ALU_CMP, 4>(cpu, src, a);
+		 }
+	 }
+
+	 template <bool IsAdd, int Size, bool Memory> static void Extended(M68000CPU& cpu, uint16_t opcode) {
+		 int srcReg = opcode & 7;
+		 int dstReg = (opcode >> 9) & 7;
+		 if constexpr (Memory) {
+			 uint32_t src = ReadMemory<Size>(cpu, Address<EA_PD, Size>(cpu, srcReg));
+			 uint32_t address = Address<EA_PD, Size>(cpu, dstReg);
+			 uint32_t dst = ReadMemory<Size>(cpu, address);
+			 WriteMemory<Size>(cpu, address, AluExtended<IsAdd, Size>(cpu, src, dst));
+		 } else {
+			 uint32_t& d = cpu.m_registers.d[dstReg];
+			 uint32_t result = AluExtended<IsAdd, Size>(cpu, cpu.m_registers.d[srcReg] & Mask<Size>(), d & Mask<Size>());
+			 d = (d & ~Mask<Size>()) | result;
+		 }
+	 }
+
+	 template <bool IsAdd, bool Memory> static void Bcd(M68000CPU& cpu, uint16_t opcode) {
+		 int srcReg = opcode & 7;
+		 int dstReg = (opcode >> 9) & 7;
+		 if constexpr (Memory) {
+			 uint32_t src = cpu.m_memoryManager.Read8(Address<EA_PD, 1>(cpu, srcReg));
+			 uint32_t address = Address<EA_PD, 1>(cpu, dstReg);
+			 uint32_t dst = cpu.m_memoryManager.Read8(address);
+			 uint32_t result = IsAdd ? BcdAdd(cpu, src, dst) : BcdSubtract(cpu, src, dst);
+			 cpu.m_memoryManager.Write8(address, static_cast<uint8_t>(result));
+		 } else {
+			 uint32_t& d = cpu.m_registers.d[dstReg];
+			 uint32_t src = cpu.m_registers.d[srcReg] & 0xFF;
+			 uint32_t result = IsAdd ? BcdAdd(cpu, src, d & 0xFF) : BcdSubtract(cpu, src, d & 0xFF);
+			 d = (d & ~0xFFu) | result;
+		 }
+	 }
+
+	 template <int Size> static void Cmpm(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = ReadMemory<Size>(cpu, Address<EA_PI, Size>(cpu, opcode & 7));
+		 uint32_t dst = ReadMemory<Size>(cpu, Address<EA_PI, Size>(cpu, (opcode >> 9) & 7));
+		 Alu<ALU_CMP, Size>(cpu, src, dst);
+	 }
+
+	 template <bool IsSigned, int Mode> static void Multiply(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = Read<Mode, 2>(cpu, opcode & 7);
+		 uint32_t& d = cpu.m_registers.d[(opcode >> 9) & 7];
+		 uint32_t result;
+		 if constexpr (IsSigned) {
+			 result = static_cast<uint32_t>(Signed<2>(src) * Signed<2>(d));
+			 // Timing depends on the number of 01/10 bit pairs in the source
+			 cpu.m_pendingCycles += 2 * static_cast<int>(std::bitset<16>((src << 1) ^ src).count());
+		 } else {
+			 result = src * (d & 0xFFFF);
+			 cpu.m_pendingCycles += 2 * static_cast<int>(std::bitset<16>(src).count());
+		 }
+		 d = result;
+		 SetLogicFlags<4>(cpu, result);
+	 }
+
+	 template <bool IsSigned, int Mode> static void Divide(M68000CPU& cpu, uint16_t opcode) {
+		 uint32_t src = Read<Mode, 2>(cpu, opcode & 7);
+		 uint32_t& d = cpu.m_registers.d[(opcode >> 9) & 7];
+		 if (src == 0) {
+			 cpu.MaterializeFlags();
+			 cpu.m_registers.sr &= ~SR_C;
+			 cpu.TriggerException(ExceptionType::ZERO_DIVIDE);
+			 return;
+		 }
+
+		 int64_t quotient;
+		 int64_t remainder;
+		 if constexpr (IsSigned) {
+			 int64_t dividend = static_cast<int32_t>(d);
+			 int64_t divisor = Signed<2>(src);
+			 quotient = dividend / divisor;
+			 remainder = dividend % divisor;
+		 } else {
+			 quotient = d / src;
+			 remainder = d % src;
+		 }
+
+		 bool overflow = IsSigned ? (quotient < -32768 || quotient > 32767) : quotient > 0xFFFF;
+		 if (overflow) {
+			 // Operands are left unchanged
+			 cpu.MaterializeFlags();
+			 cpu.m_registers.sr = (cpu.m_registers.sr & ~SR_C) | SR_V;
+			 return;
+		 }
+		 d = (static_cast<uint32_t>(remainder & 0xFFFF) << 16) | static_cast<uint32_t>(quotient & 0xFFFF);
+		 SetLogicFlags<2>(cpu, d);
+	 }
+
+	 static void Exg(M68000CPU& cpu, uint16_t opcode) {
+		 int rx = (opcode >> 9) & 7;
+		 int ry = opcode & 7;
+		 M68000Registers& r = cpu.m_registers;
+		 switch (opcode & 0xF8) {
+			 case 0x40: std::swap(r.d[rx], r.d[ry]); break;
+			 case 0x48: std::swap(r.a[rx], r.a[ry]); break;
+			 default:   std::swap(r.d[rx], r.a[ry]); break;
+		 }
+	 }
+
+	 // ----- Handlers: shifts and rotates (group E) -----
+
+	 template <int Op, bool Left, int Size> static void ShiftRegister(M68000CPU& cpu, uint16_t opcode) {
+		 int count = (opcode >> 9) & 7;
+		 if (opcode & 0x20) {
+			 count = cpu.m_registers.d[count] & 63;
+		 } else if (count == 0) {
+			 count = 8;
+		 }
+		 uint32_t& d = cpu.m_registers.d[opcode & 7];
+		 d = (d & ~Mask<Size>()) | Shift<Op, Left, Size>(cpu, d, count);
+		 cpu.m_pendingCycles += 2 * count;
+	 }
+
+	 template <int Op, bool Left, int Mode> static void ShiftMemory(M68000CPU& cpu, uint16_t opcode) {
+		 int reg = opcode & 7;
+		 uint32_t address = 0;
+		 uint32_t value = Read<Mode, 2>(cpu, reg, address);
+		 Write<Mode, 2>(cpu, reg, address, Shift<Op, Left, 2>(cpu, value, 1));
+	 }
+
+	 // ----- Decoder -----
+
+	 static Entry Make(Handler handler, int cycles) {
+		 return Entry{ handler, static_cast<uint8_t>(cycles), 0 };
+	 }
+
+	 static Entry IllegalEntry() {
+		 return Make(&Illegal, 0);
+	 }
+
+	 // Standard two-bit size field (bits 7-6): 0 byte, 1 word, 2 long
+	 static int SizeIndex(uint16_t opcode) {
+		 return (opcode >> 6) & 3;
+	 }
+
+	 static Entry DecodeGroup0(uint16_t opcode, int ea) {
+		 static const Handler immediate[6][3][12] = {
+			 M68K_SIZED_HANDLERS(Immediate, ALU_OR), M68K_SIZED_HANDLERS(Immediate, ALU_AND),
+			 M68K_SIZED_HANDLERS(Immediate, ALU_SUB), M68K_SIZED_HANDLERS(Immediate, ALU_ADD),
+			 M68K_SIZED_HANDLERS(Immediate, ALU_EOR), M68K_SIZED_HANDLERS(Immediate, ALU_CMP)
+		 };
+		 static const Handler bitDynamic[4][12] = {
+			 M68K_EA_HANDLERS(BitDynamic, BIT_TST), M68K_EA_HANDLERS(BitDynamic, BIT_CHG),
+			 M68K_EA_HANDLERS(BitDynamic, BIT_CLR), M68K_EA_HANDLERS(BitDynamic, BIT_SET)
+		 };
+		 static const Handler bitStatic[4][12] = {
+			 M68K_EA_HANDLERS(BitStatic, BIT_TST), M68K_EA_HANDLERS(BitStatic, BIT_CHG),
+			 M68K_EA_HANDLERS(BitStatic, BIT_CLR), M68K_EA_HANDLERS(BitStatic, BIT_SET)
+		 };
+
+		 int bitOp = (opcode >> 6) & 3;
+
+		 if (opcode & 0x0100) {
+			 if (((opcode >> 3) & 7) == 1) {
+				 static const Handler movep[4] = {
+					 &Movep<false, 2>, &Movep<false, 4>, &Movep<true, 2>, &Movep<true, 4>
+				 };
+				 return Make(movep[bitOp], (bitOp & 1) ? 24 : 16);
+			 }
+			 uint16_t allowed = bitOp == BIT_TST ? EA_DATA : EA_DATA_ALTERABLE;
+			 if (!IsAllowed(ea, allowed)) {
+				 return IllegalEntry();
+			 }
+			 int cycles = ea == EA_DN ? (bitOp == BIT_TST ? 6 : bitOp == BIT_CLR ? 10 : 8)
+									  : (bitOp == BIT_TST ? 4 : 8) + EACycles(ea, 1);
+			 return Make(bitDynamic[bitOp][ea], cycles);
+		 }
+
+		 int kind = (opcode >> 9) & 7;
+		 if (kind == 4) {
+			 uint16_t allowed = bitOp == BIT_TST ? (EA_DATA & ~(1 << EA_IMM)) : EA_DATA_ALTERABLE;
+			 if (!IsAllowed(ea, allowed)) {
+				 return IllegalEntry();
+			 }
+			 int cycles = ea == EA_DN ? (bitOp == BIT_TST ? 10 : bitOp == BIT_CLR ? 14 : 12)
+									  : (bitOp == BIT_TST ? 8 : 12) + EACycles(ea, 1);
+			 return Make(bitStatic[bitOp][ea], cycles);
+		 }
+
+		 static const int aluForKind[8] = { ALU_OR, ALU_AND, ALU_SUB, ALU_ADD, -1, ALU_EOR, ALU_CMP, -1 };
+		 int op = aluForKind[kind];
+		 if (op < 0) {
+			 return IllegalEntry();
+		 }
+
+		 // ORI/ANDI/EORI to CCR and SR use the immediate addressing mode slot
+		 if (ea == EA_IMM && (op == ALU_OR || op == ALU_AND || op == ALU_EOR)) {
+			 int sizeIndex = SizeIndex(opcode);
+			 if (sizeIndex == 0) {
+				 static const Handler toCCR[] = { &ImmediateToCCR<ALU_OR>, &ImmediateToCCR<ALU_AND>, nullptr, nullptr, &ImmediateToCCR<ALU_EOR> };
+				 return Make(toCCR[op], 20);
+			 }
+			 if (sizeIndex == 1) {
+				 static const Handler toSR[] = { &ImmediateToSR<ALU_OR>, &ImmediateToSR<ALU_AND>, nullptr, nullptr, &ImmediateToSR<ALU_EOR> };
+				 return Make(toSR[op], 20);
+			 }
+			 return IllegalEntry();
+		 }
+
+		 int sizeIndex = SizeIndex(opcode);
+		 if (sizeIndex == 3 || !IsAllowed(ea, EA_DATA_ALTERABLE)) {
+			 return IllegalEntry();
+		 }
+		 bool isLong = sizeIndex == 2;
+		 int cycles;
+		 if (op == ALU_CMP) {
+			 cycles = ea == EA_DN ? (isLong ? 14 : 8) : (isLong ? 12 : 8) + EACycles(ea, isLong ? 4 : 2);
+		 } else if (ea == EA_DN) {
+			 cycles = isLong ? (op == ALU_AND ? 14 : 16) : 8;
+		 } else {
+			 cycles = (isLong ? 20 : 12) + EACycles(ea, isLong ? 4 : 2);
+		 }
+		 return Make(immediate[op][sizeIndex][ea], cycles);
+	 }
+
+	 static Entry DecodeMove(uint16_t opcode, int ea) {
+		 static const Handler moveByte[12][12] = M68K_MOVE_HANDLERS(1);
+		 static const Handler moveWord[12][12] = M68K_MOVE_HANDLERS(2);
+		 static const Handler moveLong[12][12] = M68K_MOVE_HANDLERS(4);
+		 static const Handler movea[2][12] = { M68K_EA_HANDLERS(Movea, 2), M68K_EA_HANDLERS(Movea, 4) };
+
+		 int group = opcode >> 12;
+		 int size = group == 1 ? 1 : group == 3 ? 2 : 4;
+		 int dst = DecodeEA((opcode >> 6) & 7, (opcode >> 9) & 7);
+		 if (!IsAllowed(ea, EA_ALL) || (size == 1 && ea == EA_AN)) {
+			 return IllegalEntry();
+		 }
+
+		 if (dst == EA_AN) {
+			 if (size == 1) {
+				 return IllegalEntry();
+			 }
+			 return Make(movea[size == 4 ? 1 : 0][ea], 4 + EACycles(ea, size));
+		 }
+		 if (!IsAllowed(dst, EA_DATA_ALTERABLE)) {
+			 return IllegalEntry();
+		 }
+
+		 const Handler (*table)[12] = size == 1 ? moveByte : size == 2 ? moveWord : moveLong;
+		 return Make(table[ea][dst], 4 + EACycles(ea, size) + MOVE_DEST_CYCLES[size == 4 ? 1 : 0][dst]);
+	 }
+
+	 static Entry DecodeGroup4(uint16_t opcode, int ea) {
+		 static const Handler unary[4][3][12] = {
+			 M68K_SIZED_HANDLERS(Unary, UNARY_NEGX), M68K_SIZED_HANDLERS(Unary, UNARY_CLR),
+			 M68K_SIZED_HANDLERS(Unary, UNARY_NEG), M68K_SIZED_HANDLERS(Unary, UNARY_NOT)
+		 };
+		 static const Handler tst[3][12] = { M68K_EA_HANDLERS(Tst, 1), M68K_EA_HANDLERS(Tst, 2), M68K_EA_HANDLERS(Tst, 4) };
+		 static const Handler movem[2][2][12] = {
+			 { M68K_EA_HANDLERS(Movem, false, 2), M68K_EA_HANDLERS(Movem, false, 4) },
+			 { M68K_EA_HANDLERS(Movem, true, 2), M68K_EA_HANDLERS(Movem, true, 4) }
+		 };
+		 static const Handler lea[12] = M68K_MODE_HANDLERS(Lea);
+		 static const Handler pea[12] = M68K_MODE_HANDLERS(Pea);
+		 static const Handler jmp[12] = M68K_MODE_HANDLERS(Jmp);
+		 static const Handler jsr[12] = M68K_MODE_HANDLERS(Jsr);
+		 static const Handler chk[12] = M68K_MODE_HANDLERS(Chk);
+		 static const Handler moveFromSR[12] = M68K_MODE_HANDLERS(MoveFromSR);
+		 static const Handler moveToCCR[12] = M68K_MODE_HANDLERS(MoveToCCR);
+		 static const Handler moveToSR[12] = M68K_MODE_HANDLERS(MoveToSR);
+		 static const Handler nbcd[12] = M68K_MODE_HANDLERS(Nbcd);
+		 static const Handler tas[12] = M68K_MODE_HANDLERS(Tas);
+
+		 if ((opcode & 0xF1C0) == 0x41C0) {
+			 return IsAllowed(ea, EA_CONTROL) ? Make(lea[ea], LEA_CYCLES[ea]) : IllegalEntry();
+		 }
+		 if ((opcode & 0xF1C0) == 0x4180) {
+			 return IsAllowed(ea, EA_DATA) ? Make(chk[ea], 10 + EACycles(ea, 2)) : IllegalEntry();
+		 }
+
+		 switch (opcode) {
+			 case 0x4AFC: return IllegalEntry();
+			 case 0x4E70: return Make(&ResetDevices, 132);
+			 case 0x4E71: return Make(&Nop, 4);
+			 case 0x4E72: return Make(&Stop, 4);
+			 case 0x4E73: return Make(&Rte, 20);
+			 case 0x4E75: return Make(&Rts, 16);
+			 case 0x4E76: return Make(&Trapv, 4);
+			 case 0x4E77: return Make(&Rtr, 20);
+			 default: break;
+		 }
+
+		 switch (opcode & 0xFFF8) {
+			 case 0x4840: return Make(&Swap, 4);
+			 case 0x4880: return Make(&Ext<2>, 4);
+			 case 0x48C0: return Make(&Ext<4>, 4);
+			 case 0x4E50: return Make(&Link, 16);
+			 case 0x4E58: return Make(&Unlk, 12);
+			 case 0x4E40: case 0x4E48: return Make(&Trap, 0);
+			 case 0x4E60: case 0x4E68: return Make(&MoveUsp, 4);
+			 default: break;
+		 }
+
+		 switch (opcode & 0xFFC0) {
+			 case 0x40C0:
+				 return IsAllowed(ea, EA_DATA_ALTERABLE) ? Make(moveFromSR[ea], ea == EA_DN ? 6 : 8 + EACycles(ea, 2)) : IllegalEntry();
+			 case 0x44C0:
+				 return IsAllowed(ea, EA_DATA) ? Make(moveToCCR[ea], 12 + EACycles(ea, 2)) : IllegalEntry();
+			 case 0x46C0:
+				 return IsAllowed(ea, EA_DATA) ? Make(moveToSR[ea], 12 + EACycles(ea, 2)) : IllegalEntry();
+			 case 0x4800:
+				 return IsAllowed(ea, EA_DATA_ALTERABLE) ? Make(nbcd[ea], ea == EA_DN ? 6 : 8 + EACycles(ea, 1)) : IllegalEntry();
+			 case 0x4840:
+				 return IsAllowed(ea, EA_CONTROL) ? Make(pea[ea], LEA_CYCLES[ea] + 8) : IllegalEntry();
+			 case 0x4AC0:
+				 return IsAllowed(ea, EA_DATA_ALTERABLE) ? Make(tas[ea], ea == EA_DN ? 4 : 14 + EACycles(ea, 1)) : IllegalEntry();
+			 case 0x4E80:
+				 return IsAllowed(ea, EA_CONTROL) ? Make(jsr[ea], JSR_CYCLES[ea]) : IllegalEntry();
+			 case 0x4EC0:
+				 return IsAllowed(ea, EA_CONTROL) ? Make(jmp[ea], JMP_CYCLES[ea]) : IllegalEntry();
+			 default: break;
+		 }
+
+		 if ((opcode & 0xFB80) == 0x4880) {
+			 bool toRegisters = (opcode & 0x0400) != 0;
+			 int sizeIndex = (opcode & 0x0040) ? 1 : 0;
+			 if (toRegisters) {
+				 if (!IsAllowed(ea, EA_CONTROL | (1 << EA_PI))) {
+					 return IllegalEntry();
+				 }
+				 return Make(movem[0][sizeIndex][ea], MOVEM_TO_REGISTER_CYCLES[ea]);
+			 }
+			 if (!IsAllowed(ea, EA_CONTROL_ALTERABLE | (1 << EA_PD))) {
+				 return IllegalEntry();
+			 }
+			 return Make(movem[1][sizeIndex][ea], MOVEM_TO_MEMORY_CYCLES[ea]);
+		 }
+
+		 int sizeIndex = SizeIndex(opcode);
+		 if (sizeIndex == 3) {
+			 return IllegalEntry();
+		 }
+		 int size = 1 << sizeIndex;
+
+		 if ((opcode & 0xFF00) == 0x4A00) {
+			 return IsAllowed(ea, EA_DATA_ALTERABLE) ? Make(tst[sizeIndex][ea], 4 + EACycles(ea, size)) : IllegalEntry();
+		 }
+
+		 int unaryOp;
+		 switch (opcode & 0xFF00) {
+			 case 0x4000: unaryOp = UNARY_NEGX; break;
+			 case 0x4200: unaryOp = UNARY_CLR; break;
+			 case 0x4400: unaryOp = UNARY_NEG; break;
+			 case 0x4600: unaryOp = UNARY_NOT; break;
+			 default: return IllegalEntry();
+		 }
+		 if (!IsAllowed(ea, EA_DATA_ALTERABLE)) {
+			 return IllegalEntry();
+		 }
+		 int cycles = ea == EA_DN ? (size == 4 ? 6 : 4) : (size == 4 ? 12 : 8) + EACycles(ea, size);
+		 return Make(unary[unaryOp][sizeIndex][ea], cycles);
+	 }
+
+	 static Entry DecodeGroup5(uint16_t opcode, int ea) {
+		 static const Handler quick[2][3][12] = {
+			 M68K_SIZED_HANDLERS(Quick, ALU_ADD), M68K_SIZED_HANDLERS(Quick, ALU_SUB)
+		 };
+		 static const Handler scc[12] = M68K_MODE_HANDLERS(Scc);
+
+		 int sizeIndex = SizeIndex(opcode);
+		 if (sizeIndex == 3) {
+			 if (ea == EA_AN) {
+				 return Make(&Dbcc, 10);
+			 }
+			 return IsAllowed(ea, EA_DATA_ALTERABLE) ? Make(scc[ea], ea == EA_DN ? 4 : 8 + EACycles(ea, 1)) : IllegalEntry();
+		 }
+
+		 int size = 1 << sizeIndex;
+		 if (!IsAllowed(ea, EA_ALTERABLE) || (size == 1 && ea == EA_AN)) {
+			 return IllegalEntry();
+		 }
+		 int cycles;
+		 if (ea == EA_AN) {
+			 cycles = 8;
+		 } else if (ea == EA_DN) {
+			 cycles = size == 4 ? 8 : 4;
+		 } else {
+			 cycles = (size == 4 ? 12 : 8) + EACycles(ea, size);
+		 }
+		 return Make(quick[(opcode & 0x0100) ? 1 : 0][sizeIndex][ea], cycles);
+	 }
+
+	 static Entry DecodeBranch(uint16_t opcode) {
+		 static const Handler branch[16] = {
+			 &Branch<0x0>, &Branch<0x1>, &Branch<0x2>, &Branch<0x3>, &Branch<0x4>, &Branch<0x5>, &Branch<0x6>, &Branch<0x7>,
+			 &Branch<0x8>, &Branch<0x9>, &Branch<0xA>, &Branch<0xB>, &Branch<0xC>, &Branch<0xD>, &Branch<0xE>, &Branch<0xF>
+		 };
+		 int condition = (opcode >> 8) & 0x0F;
+		 return Make(branch[condition], condition == 1 ? 18 : 10);
+	 }
+
+	 // <ea>,Dn / Dn,<ea> forms shared by OR, SUB, CMP/EOR, AND and ADD
+	 static Entry DecodeAlu(uint16_t opcode, int ea, int op) {
+		 static const Handler toRegister[6][3][12] = {
+			 M68K_SIZED_HANDLERS(AluToRegister, ALU_OR), M68K_SIZED_HANDLERS(AluToRegister, ALU_AND),
+			 M68K_SIZED_HANDLERS(AluToRegister, ALU_SUB), M68K_SIZED_HANDLERS(AluToRegister, ALU_ADD),
+			 M68K_SIZED_HANDLERS(AluToRegister, ALU_EOR), M68K_SIZED_HANDLERS(AluToRegister, ALU_CMP)
+		 };
+		 static const Handler toMemory[6][3][12] = {
+			 M68K_SIZED_HANDLERS(AluToMemory, ALU_OR), M68K_SIZED_HANDLERS(AluToMemory, ALU_AND),
+			 M68K_SIZED_HANDLERS(AluToMemory, ALU_SUB), M68K_SIZED_HANDLERS(AluToMemory, ALU_ADD),
+			 M68K_SIZED_HANDLERS(AluToMemory, ALU_EOR), M68K_SIZED_HANDLERS(AluToMemory, ALU_CMP)
+		 };
+
+		 int sizeIndex = SizeIndex(opcode);
+		 int size = 1 << sizeIndex;
+		 bool isLong = size == 4;
+
+		 if (!(opcode & 0x0100)) {
+			 // Address registers are only a source for word/long ADD, SUB and CMP
+			 uint16_t allowed = (op == ALU_OR || op == ALU_AND || size == 1) ? EA_DATA : EA_ALL;
+			 if (!IsAllowed(ea, allowed)) {
+				 return IllegalEntry();
+			 }
+			 int cycles = 4 + EACycles(ea, size);
+			 if (isLong) {
+				 cycles += (op != ALU_CMP && (ea == EA_DN || ea == EA_AN || ea == EA_IMM)) ? 4 : 2;
+			 }
+			 return Make(toRegister[op][sizeIndex][ea], cycles);
+		 }
+
+		 // EOR is the only Dn,<ea> form that may target a data register
+		 uint16_t allowed = op == ALU_EOR ? EA_DATA_ALTERABLE : EA_MEMORY_ALTERABLE;
+		 if (!IsAllowed(ea, allowed)) {
+			 return IllegalEntry();
+		 }
+		 int cycles = ea == EA_DN ? (isLong ? 8 : 4) : (isLong ? 12 : 8) + EACycles(ea, size);
+		 return Make(toMemory[op][sizeIndex][ea], cycles);
+	 }
+
+	 // ADDA/SUBA/CMPA <ea>,An
+	 static Entry DecodeAddressAlu(uint16_t opcode, int ea, int op) {
+		 static const Handler address[3][2][12] = {
+			 { M68K_EA_HANDLERS(AluAddress, ALU_SUB, 2), M68K_EA_HANDLERS(AluAddress, ALU_SUB, 4) },
+			 { M68K_EA_HANDLERS(AluAddress, ALU_ADD, 2), M68K_EA_HANDLERS(AluAddress, ALU_ADD, 4) },
+			 { M68K_EA_HANDLERS(AluAddress, ALU_CMP, 2), M68K_EA_HANDLERS(AluAddress, ALU_CMP, 4) }
+		 };
+		 if (!IsAllowed(ea, EA_ALL)) {
+			 return IllegalEntry();
+		 }
+		 bool isLong = (opcode & 0x0100) != 0;
+		 int size = isLong ? 4 : 2;
+		 int cycles;
+		 if (op == ALU_CMP) {
+			 cycles = 6 + EACycles(ea, size);
+		 } else if (isLong) {
+			 cycles = ((ea == EA_DN || ea == EA_AN || ea == EA_IMM) ? 8 : 6) + EACycles(ea, size);
+		 } else {
+			 cycles = 8 + EACycles(ea, size);
+		 }
+		 int row = op == ALU_SUB ? 0 : op == ALU_ADD ? 1 : 2;
+		 return Make(address[row][isLong ? 1 : 0][ea], cycles);
+	 }
+
+	 static Entry DecodeGroup8(uint16_t opcode, int ea) {
+		 static const Handler divu[12] = M68K_EA_HANDLERS(Divide, false);
+		 static const Handler divs[12] = M68K_EA_HANDLERS(Divide, true);
+
+		 if (SizeIndex(opcode) == 3) {
+			 if (!IsAllowed(ea, EA_DATA)) {
+				 return IllegalEntry();
+			 }
+			 bool isSigned = (opcode & 0x0100) != 0;
+			 return Make(isSigned ? divs[ea] : divu[ea], (isSigned ? 158 : 140) + EACycles(ea, 2));
+		 }
+		 if ((opcode & 0x01F0) == 0x0100) {
+			 bool memory = (opcode & 0x08) != 0;
+			 return Make(memory ? &Bcd<false, true> : &Bcd<false, false>, memory ? 18 : 6);
+		 }
+		 return DecodeAlu(opcode, ea, ALU_OR);
+	 }
+
+	 static Entry DecodeAddSub(uint16_t opcode, int ea, bool isAdd) {
+		 if (SizeIndex(opcode) == 3) {
+			 return DecodeAddressAlu(opcode, ea, isAdd ? ALU_ADD : ALU_SUB);
+		 }
+		 if ((opcode & 0x0130) == 0x0100) {
+			 static const Handler extended[2][3][2] = {
+				 { { &Extended<false, 1, false>, &Extended<false, 1, true> },
+				   { &Extended<false, 2, false>, &Extended<false, 2, true> },
+				   { &Extended<false, 4, false>, &Extended<false, 4, true> } },
+				 { { &Extended<true, 1, false>, &Extended<true, 1, true> },
+				   { &Extended<true, 2, false>, &Extended<true, 2, true> },
+				   { &Extended<true, 4, false>, &Extended<true, 4, true> } }
+			 };
+			 int sizeIndex = SizeIndex(opcode);
+			 bool memory = (opcode & 0x08) != 0;
+			 bool isLong = sizeIndex == 2;
+			 int cycles = memory ? (isLong ? 30 : 18) : (isLong ? 8 : 4);
+			 return Make(extended[isAdd ? 1 : 0][sizeIndex][memory ? 1 : 0], cycles);
+		 }
+		 return DecodeAlu(opcode, ea, isAdd ? ALU_ADD : ALU_SUB);
+	 }
+
+	 static Entry DecodeGroupB(uint16_t opcode, int ea) {
+		 int sizeIndex = SizeIndex(opcode);
+		 if (sizeIndex == 3) {
+			 return DecodeAddressAlu(opcode, ea, ALU_CMP);
+		 }
+		 if (!(opcode & 0x0100)) {
+			 return DecodeAlu(opcode, ea, ALU_CMP);
+		 }
+		 if (ea == EA_AN) {
+			 static const Handler cmpm[3] = { &Cmpm<1>, &Cmpm<2>, &Cmpm<4> };
+			 return Make(cmpm[sizeIndex], sizeIndex == 2 ? 20 : 12);
+		 }
+		 return DecodeAlu(opcode, ea, ALU_EOR);
+	 }
+
+	 static Entry DecodeGroupC(uint16_t opcode, int ea) {
+		 static const Handler mulu[12] = M68K_EA_HANDLERS(Multiply, false);
+		 static const Handler muls[12] = M68K_EA_HANDLERS(Multiply, true);
+
+		 if (SizeIndex(opcode) == 3) {
+			 if (!IsAllowed(ea, EA_DATA)) {
+				 return IllegalEntry();
+			 }
+			 return Make((opcode & 0x0100) ? muls[ea] : mulu[ea], 38 + EACycles(ea, 2));
+		 }
+		 if ((opcode & 0x01F0) == 0x0100) {
+			 bool memory = (opcode & 0x08) != 0;
+			 return Make(memory ? &Bcd<true, true> : &Bcd<true, false>, memory ? 18 : 6);
+		 }
+		 switch (opcode & 0x01F8) {
+			 case 0x0140: case 0x0148: case 0x0188:
+				 return Make(&Exg, 6);
+			 default:
+				 break;
+		 }
+		 return DecodeAlu(opcode, ea, ALU_AND);
+	 }
+
+	 static Entry DecodeGroupE(uint16_t opcode, int ea) {
+		 static const Handler shiftMemory[4][2][12] = {
+			 { M68K_EA_HANDLERS(ShiftMemory, SHIFT_AS, false), M68K_EA_HANDLERS(ShiftMemory, SHIFT_AS, true) },
+			 { M68K_EA_HANDLERS(ShiftMemory, SHIFT_LS, false), M68K_EA_HANDLERS(ShiftMemory, SHIFT_LS, true) },
+			 { M68K_EA_HANDLERS(ShiftMemory, SHIFT_ROX, false), M68K_EA_HANDLERS(ShiftMemory, SHIFT_ROX, true) },
+			 { M68K_EA_HANDLERS(ShiftMemory, SHIFT_RO, false), M68K_EA_HANDLERS(ShiftMemory, SHIFT_RO, true) }
+		 };
+		 static const Handler shiftRegister[4][2][3] = {
+			 { { &ShiftRegister<SHIFT_AS, false, 1>, &ShiftRegister<SHIFT_AS, false, 2>, &ShiftRegister<SHIFT_AS, false, 4> },
+			   { &ShiftRegister<SHIFT_AS, true, 1>, &ShiftRegister<SHIFT_AS, true, 2>, &ShiftRegister<SHIFT_AS, true, 4> } },
+			 { { &ShiftRegister<SHIFT_LS, false, 1>, &ShiftRegister<SHIFT_LS, false, 2>, &ShiftRegister<SHIFT_LS, false, 4> },
+			   { &ShiftRegister<SHIFT_LS, true, 1>, &ShiftRegister<SHIFT_LS, true, 2>, &ShiftRegister<SHIFT_LS, true, 4> } },
+			 { { &ShiftRegister<SHIFT_ROX, false, 1>, &ShiftRegister<SHIFT_ROX, false, 2>, &ShiftRegister<SHIFT_ROX, false, 4> },
+			   { &ShiftRegister<SHIFT_ROX, true, 1>, &ShiftRegister<SHIFT_ROX, true, 2>, &ShiftRegister<SHIFT_ROX, true, 4> } },
+			 { { &ShiftRegister<SHIFT_RO, false, 1>, &ShiftRegister<SHIFT_RO, false, 2>, &ShiftRegister<SHIFT_RO, false, 4> },
+			   { &ShiftRegister<SHIFT_RO, true, 1>, &ShiftRegister<SHIFT_RO, true, 2>, &ShiftRegister<SHIFT_RO, true, 4> } }
+		 };
+
+		 int left = (opcode & 0x0100) ? 1 : 0;
+		 int sizeIndex = SizeIndex(opcode);
+		 if (sizeIndex == 3) {
+			 if ((opcode & 0x0800) || !IsAllowed(ea, EA_MEMORY_ALTERABLE)) {
+				 return IllegalEntry();
+			 }
+			 return Make(shiftMemory[(opcode >> 9) & 3][left][ea], 8 + EACycles(ea, 2));
+		 }
+		 return Make(shiftRegister[(opcode >> 3) & 3][left][sizeIndex], sizeIndex == 2 ? 8 : 6);
+	 }
+
+	 // Block cache flags: control flow and SR writes end a block, rare
+	 // and CPU-stopping opcodes are always run through the interpreter
+	 static uint8_t Classify(uint16_t opcode, Handler handler) {
+		 if (handler == &Illegal || handler == &LineA || handler == &LineF ||
+			 handler == &Trap || handler == &Stop || handler == &ResetDevices) {
+			 return M68000CPU::OPCODE_INTERPRETED;
+		 }
+		 bool endsBlock =
+			 (opcode & 0xF000) == 0x6000 ||                       // Bcc, BRA, BSR
+			 (opcode & 0xF0F8) == 0x50C8 ||                       // DBcc
+			 (opcode & 0xFF80) == 0x4E80 ||                       // JSR, JMP
+			 (opcode >= 0x4E60 && opcode <= 0x4E77 && opcode != 0x4E71) ||  // MOVE USP, RTE, RTS, TRAPV, RTR
+			 (opcode & 0xF1C0) == 0x4180 ||                       // CHK
+			 (opcode & 0xF0C0) == 0x80C0 ||                       // DIVU, DIVS
+			 (opcode & 0xFFC0) == 0x46C0 ||                       // MOVE to SR
+			 opcode == 0x007C || opcode == 0x027C || opcode == 0x0A7C;  // ORI/ANDI/EORI to SR
+		 return endsBlock ? M68000CPU::OPCODE_ENDS_BLOCK : 0;
+	 }
+
+	 static Entry Decode(uint16_t opcode) {
+		 int ea = DecodeEA((opcode >> 3) & 7, opcode & 7);
+		 switch (opcode >> 12) {
+			 case 0x0: return DecodeGroup0(opcode, ea);
+			 case 0x1: case 0x2: case 0x3: return DecodeMove(opcode, ea);
+			 case 0x4: return DecodeGroup4(opcode, ea);
+			 case 0x5: return DecodeGroup5(opcode, ea);
+			 case 0x6: return DecodeBranch(opcode);
+			 case 0x7: return (opcode & 0x0100) ? IllegalEntry() : Make(&Moveq, 4);
+			 case 0x8: return DecodeGroup8(opcode, ea);
+			 case 0x9: return DecodeAddSub(opcode, ea, false);
+			 case 0xA: return Make(&LineA, 0);
+			 case 0xB: return DecodeGroupB(opcode, ea);
+			 case 0xC: return DecodeGroupC(opcode, ea);
+			 case 0xD: return DecodeAddSub(opcode, ea, true);
+			 case 0xE: return DecodeGroupE(opcode, ea);
+			 default:  return Make(&LineF, 0);
+		 }
+	 }
+ };
+
+ #undef M68K_MOVE_HANDLERS
+ #undef M68K_SIZED_HANDLERS
+ #undef M68K_MODE_HANDLERS
+ #undef M68K_EA_HANDLERS
+
+ /**
+  * M68000 CPU
+  */
+ M68000CPU::M68000CPU(System& system, MemoryManager& memoryManager, Logger& logger)
+	 : m_system(system),
+	   m_memoryManager(memoryManager),
+	   m_logger(logger),
+	   m_registers{},
+	   m_state(CPUState::RESET),
+	   m_interruptLevel(IPL_NONE),
+	   m_attention(false),
+	   m_clockSpeed(0),
+	   m_cycleCount(0),
+	   m_pendingCycles(0),
+	   m_hasHooks(false),
+	   m_idleLoopSkipping(true),
+	   m_idleLoop{ NO_LOOP, 0, 0 },
+	   m_instructionAddress(0),
+	   m_flags{},
+	   m_extendFlags{} {
+	 std::fill(std::begin(m_busyLoops), std::end(m_busyLoops), NO_LOOP);
+ }
+
+ M68000CPU::~M68000CPU() {
+ }
+
+ void M68000CPU::BuildOpcodeTable() {
+	 for (uint32_t opcode = 0; opcode < 0x10000; opcode++) {
+		 OpcodeEntry entry = M68000Ops::Decode(static_cast<uint16_t>(opcode));
+		 entry.flags = M68000Ops::Classify(static_cast<uint16_t>(opcode), entry.handler);
+		 s_opcodeTable[opcode] = entry;
+	 }
+ }
+
+ bool M68000CPU::Initialize(uint32_t clockSpeed) {
+	 static std::once_flag tableBuilt;
+	 std::call_once(tableBuilt, &M68000CPU::BuildOpcodeTable);
+
+	 m_clockSpeed = clockSpeed;
+	 Reset();
+
+	 m_logger.Info("M68000CPU", "68000 initialized at " + std::to_string(clockSpeed) + " Hz");
+	 return true;
+ }
+
+ void M68000CPU::Reset() {
+	 m_registers = M68000Registers{};
+	 m_registers.sr = SR_RESET_VALUE;
+	 m_flags = LazyFlags{};
+	 m_extendFlags = LazyFlags{};
+
+	 // The reset vector holds the initial SSP and PC
+	 m_registers.ssp = m_memoryManager.Read32(0x000000);
+	 m_registers.a[7] = m_registers.ssp;
+	 m_registers.pc = m_memoryManager.Read32(0x000004);
+
+	 m_state = CPUState::RUNNING;
+	 m_interruptLevel = IPL_NONE;
+	 m_attention = false;
+	 m_cycleCount = 0;
+	 m_pendingCycles = 0;
+	 m_instructionAddress = m_registers.pc;
+	 m_idleLoop = IdleLoop{ NO_LOOP, 0, 0 };
+
+	 // Reset also follows ROM loads, which may bypass write tracking
+	 if (m_blockCache) {
+		 m_blockCache->Flush();
+	 }
+
+	 RefillPrefetchQueue();
+ }
+
+ int M68000CPU::Execute(int cycles) {
+	 int executed = 0;
+
+	 while (executed < cycles) {
+		 if (m_attention) {
+			 m_attention = false;
+			 CheckPendingInterrupts();
+		 }
+
+		 if (m_state != CPUState::RUNNING) {
+			 // Stopped or held in reset: only an interrupt changes anything,
+			 // and none can arrive before this timeslice ends
+			 executed += SkipHaltedCycles(cycles - executed);
+			 break;
+		 }
+
+		 if (m_blockCache) {
+			 m_blockCache->ClearExitRequest();
+			 if (HasHook(m_registers.pc)) {
+				 CallHook();
+			 }
+			 executed += m_blockCache->ExecuteBlock(cycles - executed);
+		 } else {
+			 executed += ExecuteRun(cycles - executed);
+		 }
+
+		 // A short backward branch may close a copy loop or a polling loop
+		 if (m_registers.pc < m_instructionAddress && m_instructionAddress - m_registers.pc <= IDLE_LOOP_MAX_BYTES) {
+			 int skipped = SkipCopyLoop(cycles - executed);
+			 if (skipped == 0 && m_idleLoopSkipping) {
+				 skipped = SkipIdleLoop(cycles - executed);
+			 }
+			 executed += skipped;
+		 }
+	 }
+
+	 return executed;
+ }
+
+ int M68000CPU::ExecuteInstruction() {
+	 m_instructionAddress = m_registers.pc;
+	 uint16_t opcode = FetchNextInstruction();
+
+	 const OpcodeEntry& entry = s_opcodeTable[opcode];
+	 m_pendingCycles += entry.cycles;
+	 entry.handler(*this, opcode);
+
+	 // Includes exception processing and cycles stolen by other bus masters
+	 int cycles = m_pendingCycles;
+	 m_pendingCycles = 0;
+	 m_cycleCount += cycles;
+	 return cycles;
+ }
+
+ int M68000CPU::ExecuteRun(int cycles) {
+	 // Branches end the run so Execute can look for idle loops, and SR
+	 // writes or a new interrupt level so it can check for interrupts
+	 const OpcodeEntry* entry;
+	 do {
+		 if (HasHook(m_registers.pc)) {
+			 CallHook();
+		 }
+
+		 m_instructionAddress = m_registers.pc;
+		 uint16_t opcode = FetchNextInstruction();
+
+		 entry = &s_opcodeTable[opcode];
+		 m_pendingCycles += entry->cycles;
+		 entry->handler(*this, opcode);
+	 } while (m_pendingCycles < cycles && entry->flags == 0 && !m_attention);
+
+	 int executed = m_pendingCycles;
+	 m_pendingCycles = 0;
+	 m_cycleCount += executed;
+	 return executed;
+ }
+
+ void M68000CPU::TriggerException(ExceptionType type, int vector) {
+	 int vectorNumber;
+	 int cycles;
+	 switch (type) {
+		 case ExceptionType::RESET:
+			 Reset();
+			 m_pendingCycles += 40;
+			 return;
+		 case ExceptionType::BUS_ERROR:           vectorNumber = 2; cycles = 50; break;
+		 case ExceptionType::ADDRESS_ERROR:       vectorNumber = 3; cycles = 50; break;
+		 case ExceptionType::ILLEGAL_INSTRUCTION: vectorNumber = 4; cycles = 34; break;
+		 case ExceptionType::ZERO_DIVIDE:         vectorNumber = 5; cycles = 38; break;
+		 case ExceptionType::CHK_INSTRUCTION:     vectorNumber = 6; cycles = 30; break;
+		 case ExceptionType::TRAPV_INSTRUCTION:   vectorNumber = 7; cycles = 30; break;
+		 case ExceptionType::PRIVILEGE_VIOLATION: vectorNumber = 8; cycles = 34; break;
+		 case ExceptionType::TRACE:               vectorNumber = 9; cycles = 34; break;
+		 case ExceptionType::LINE_A_EMULATOR:     vectorNumber = 10; cycles = 34; break;
+		 case ExceptionType::LINE_F_EMULATOR:     vectorNumber = 11; cycles = 34; break;
+		 case ExceptionType::INTERRUPT:           vectorNumber = 24 + (vector & 7); cycles = 44; break;
+		 case ExceptionType::TRAP:                vectorNumber = 32 + (vector & 15); cycles = 34; break;
+		 default:
+			 m_logger.Error("M68000CPU", "Unknown exception type");
+			 return;
+	 }
+
+	 m_state = CPUState::EXCEPTION;
+	 m_idleLoop.branchAddress = NO_LOOP;
+	 if (m_blockCache) {
+		 m_blockCache->NotifyException();
+	 }
+
+	 uint16_t oldSR = GetSR();
+	 SwitchPrivilegeMode(PrivilegeMode::SUPERVISOR);
+	 m_registers.sr &= ~SR_T;
+	 if (type == ExceptionType::INTERRUPT) {
+		 m_registers.sr = (m_registers.sr & ~SR_INTERRUPT_MASK) | ((vector & 7) << 8);
+	 }
+
+	 PushLong(m_registers.pc);
+	 PushWord(oldSR);
+	 if (type == ExceptionType::BUS_ERROR || type == ExceptionType::ADDRESS_ERROR) {
+		 // Group 0 frame: instruction register, access address, status word
+		 PushWord(m_registers.prefetch[0]);
+		 PushLong(m_instructionAddress);
+		 PushWord(0);
+	 }
+
+	 m_registers.pc = m_memoryManager.Read32(static_cast<uint32_t>(vectorNumber) * 4);
+	 m_state = CPUState::RUNNING;
+	 m_pendingCycles += cycles;
+ }
+
+ void M68000CPU::SetInterruptLevel(InterruptLevel level) {
+	 m_interruptLevel = level;
+	 m_attention = true;
+	 if (m_blockCache) {
+		 m_blockCache->RequestExit();
+	 }
+ }
+
+ bool M68000CPU::IsWaitingForInterrupt() const {
+	 return m_state != CPUState::RUNNING && !IsInterruptAccepted();
+ }
+
+ int M68000CPU::SkipHaltedCycles(int cycles) {
+	 // The bus idles in whole IDLE_CYCLES steps, plus anything stolen meanwhile
+	 int idle = (cycles > 0) ? (cycles + IDLE_CYCLES - 1) / IDLE_CYCLES * IDLE_CYCLES : 0;
+	 idle += m_pendingCycles;
+	 m_pendingCycles = 0;
+	 m_cycleCount += idle;
+	 return idle;
+ }
+
+ bool M68000CPU::IsInterruptAccepted() const {
+	 if (m_interruptLevel == IPL_NONE) {
+		 return false;
+	 }
+	 int mask = (m_registers.sr & SR_INTERRUPT_MASK) >> 8;
+	 return m_interruptLevel == IPL_7 || m_interruptLevel > mask;
+ }
+
+ bool M68000CPU::CheckPendingInterrupts() {
+	 if (!IsInterruptAccepted()) {
+		 return false;
+	 }
+
+	 // Requests are acknowledged (and dropped) as soon as they are taken
+	 int level = m_interruptLevel;
+	 m_interruptLevel = IPL_NONE;
+	 TriggerException(ExceptionType::INTERRUPT, level);
+	 return true;
+ }
+
+ CPUState M68000CPU::GetState() const {
+	 return m_state;
+ }
+
+ PrivilegeMode M68000CPU::GetPrivilegeMode() const {
+	 return (m_registers.sr & SR_S) ? PrivilegeMode::SUPERVISOR : PrivilegeMode::USER;
+ }
+
+ uint32_t M68000CPU::GetPC() const {
+	 return m_registers.pc;
+ }
+
+ void M68000CPU::SetPC(uint32_t newPC) {
+	 m_registers.pc = newPC;
+ }
+
+ M68000Registers M68000CPU::GetRegisters() const {
+	 M68000Registers registers = m_registers;
+	 registers.sr = GetSR();
+	 // A7 is the live copy of whichever stack pointer is active
+	 if (registers.sr & SR_S) {
+		 registers.ssp = registers.a[7];
+	 } else {
+		 registers.usp = registers.a[7];
+	 }
+	 return registers;
+ }
+
+ void M68000CPU::SetRegisters(const M68000Registers& registers) {
+	 m_registers = registers;
+	 m_registers.sr &= SR_IMPLEMENTED_MASK;
+	 m_attention = true;
+	 m_flags.op = FlagsOp::NONE;
+	 m_extendFlags.op = FlagsOp::NONE;
+	 m_registers.a[7] = (m_registers.sr & SR_S) ? m_registers.ssp : m_registers.usp;
+ }
+
+ uint32_t M68000CPU::GetDataRegister(int regNum) const {
+	 return (regNum >= 0 && regNum < 8) ? m_registers.d[regNum] : 0;
+ }
+
+ void M68000CPU::SetDataRegister(int regNum, uint32_t value) {
+	 if (regNum >= 0 && regNum < 8) {
+		 m_registers.d[regNum] = value;
+	 }
+ }
+
+ uint32_t M68000CPU::GetAddressRegister(int regNum) const {
+	 return (regNum >= 0 && regNum < 8) ? m_registers.a[regNum] : 0;
+ }
+
+ void M68000CPU::SetAddressRegister(int regNum, uint32_t value) {
+	 if (regNum >= 0 && regNum < 8) {
+		 m_registers.a[regNum] = value;
+	 }
+ }
+
+ uint16_t M68000CPU::GetSR() const {
+	 return (m_registers.sr & ~SR_CCR_MASK) | ComputeConditionCodes();
+ }
+
+ void M68000CPU::SetSR(uint16_t value) {
+	 // A lower mask may let a held-off interrupt in
+	 if ((value & SR_INTERRUPT_MASK) < (m_registers.sr & SR_INTERRUPT_MASK)) {
+		 m_attention = true;
+	 }
+	 SwitchPrivilegeMode((value & SR_S) ? PrivilegeMode::SUPERVISOR : PrivilegeMode::USER);
+	 m_registers.sr = value & SR_IMPLEMENTED_MASK;
+	 m_flags.op = FlagsOp::NONE;
+	 m_extendFlags.op = FlagsOp::NONE;
+ }
+
+ bool M68000CPU::IsFlagSet(StatusRegisterBits flag) const {
+	 return (GetSR() & flag) != 0;
+ }
+
+ void M68000CPU::SetFlag(StatusRegisterBits flag, bool value) {
+	 uint16_t sr = GetSR();
+	 SetSR(value ? (sr | flag) : (sr & ~flag));
+ }
+
+ uint64_t M68000CPU::GetCycleCount() const {
+	 return m_cycleCount + m_pendingCycles;
+ }
+
+ void M68000CPU::StealCycles(int cycles) {
+	 if (cycles > 0) {
+		 m_pendingCycles += cycles;
+	 }
+ }
+
+ uint32_t M68000CPU::GetClockSpeed() const {
+	 return m_clockSpeed;
+ }
+
+ void M68000CPU::SetClockSpeed(uint32_t clockSpeed) {
+	 m_clockSpeed = clockSpeed;
+ }
+
+ std::string M68000CPU::DisassembleInstruction(uint32_t address, int& instructionSize) {
+	 // Raw opcode word only; symbolic disassembly is left to the debugger
+	 char text[16];
+	 std::snprintf(text, sizeof(text), "dc.w $%04X", m_memoryManager.Read16(address));
+	 instructionSize = 2;
+	 return text;
+ }
+
+ bool M68000CPU::RegisterHook(uint32_t address, std::function<void()> callback) {
+	 if (!callback) {
+		 return false;
+	 }
+	 m_hooks[address] = std::move(callback);
+
+	 if (m_hookBitmap.empty()) {
+		 m_hookBitmap.assign(((MemoryManager::ADDRESS_MASK + 1) >> 1) / 64, 0);
+	 }
+	 uint32_t word = (address & MemoryManager::ADDRESS_MASK) >> 1;
+	 m_hookBitmap[word >> 6] |= uint64_t(1) << (word & 63);
+	 m_hasHooks = true;
+
+	 // Hooked addresses must start a block
+	 if (m_blockCache) {
+		 m_blockCache->Invalidate(address, 2);
+	 }
+	 return true;
+ }
+
+ bool M68000CPU::RemoveHook(uint32_t address) {
+	 if (m_hooks.erase(address) == 0) {
+		 return false;
+	 }
+
+	 // Other hooks may share the word, so rebuild the bits from the map
+	 std::fill(m_hookBitmap.begin(), m_hookBitmap.end(), 0);
+	 for (const auto& hook : m_hooks) {
+		 uint32_t word = (hook.first & MemoryManager::ADDRESS_MASK) >> 1;
+		 m_hookBitmap[word >> 6] |= uint64_t(1) << (word & 63);
+	 }
+	 m_hasHooks = !m_hooks.empty();
+	 return true;
+ }
+
+ void M68000CPU::CallHook() {
+	 auto hook = m_hooks.find(m_registers.pc);
+	 if (hook != m_hooks.end()) {
+		 hook->second();
+	 }
+ }
+
+ void M68000CPU::SetCore(M68000Core core) {
+	 if (core == GetCore()) {
+		 return;
+	 }
+	 if (core == M68000Core::BLOCK_CACHE && MEMORY_STATS_ENABLED) {
+		 // Replayed blocks skip instruction fetches, which would vanish from the counters
+		 m_logger.Warning("M68000CPU", "Block cache core is not available with memory access statistics, "
+						  "using interpreter core");
+	 } else if (core == M68000Core::BLOCK_CACHE) {
+		 m_blockCache = std::make_unique<M68000BlockCache>(*this, m_memoryManager);
+		 m_logger.Info("M68000CPU", "Using block cache core");
+	 } else {
+		 m_blockCache.reset();
+		 m_logger.Info("M68000CPU", "Using interpreter core");
+	 }
+ }
+
+ M68000Core M68000CPU::GetCore() const {
+	 return m_blockCache ? M68000Core::BLOCK_CACHE : M68000Core::INTERPRETER;
+ }
+
+ void M68000CPU::SetIdleLoopSkipping(bool enabled) {
+	 m_idleLoopSkipping = enabled;
+	 m_idleLoop.branchAddress = NO_LOOP;
+ }
+
+ int M68000CPU::SkipIdleLoop(int cycles) {
+	 uint32_t branchAddress = m_instructionAddress;
+	 uint32_t& busy = m_busyLoops[(branchAddress >> 1) & 63];
+	 if (busy == branchAddress) {
+		 return 0;
+	 }
+
+	 // First time round: check the body, then wait for one whole pass
+	 if (m_idleLoop.branchAddress != branchAddress) {
+		 int iterationCycles = IdleLoopCycles(m_registers.pc, branchAddress);
+		 if (iterationCycles == 0) {
+			 busy = branchAddress;
+			 return 0;
+		 }
+		 m_idleLoop = IdleLoop{ branchAddress, m_cycleCount, iterationCycles };
+		 return 0;
+	 }
+
+	 // Anything else run since the last pass (leaving the loop and coming
+	 // back, or an interrupted pass) shows up as a different cycle count
+	 uint64_t elapsed = m_cycleCount - m_idleLoop.cycleCount;
+	 m_idleLoop.cycleCount = m_cycleCount;
+	 if (cycles <= 0 || elapsed != static_cast<uint64_t>(m_idleLoop.iterationCycles)) {
+		 return 0;
+	 }
+
+	 // Hooks inside the loop still have to see every iteration
+	 if (m_hasHooks) {
+		 for (uint32_t address = m_registers.pc; address <= branchAddress; address += 2) {
+			 if (HasHook(address)) {
+				 return 0;
+			 }
+		 }
+	 }
+
+	 // Nothing the loop reads can change before the timeslice ends (its
+	 // memory operands are all plain memory), so every remaining whole
+	 // iteration would end in the same state
+	 int skipped = cycles - cycles % m_idleLoop.iterationCycles;
+	 m_cycleCount += skipped;
+	 m_idleLoop.cycleCount = m_cycleCount;
+	 return skipped;
+ }
+
+ int M68000CPU::SkipCopyLoop(int cycles) {
+	 // Only a one-word body with DBRA straight after it
+	 uint32_t bodyAddress = m_registers.pc;
+	 uint16_t branch = m_registers.prefetch[0];
+	 if ((branch & 0xFFF8) != DBRA_OPCODE || bodyAddress + 2 != m_instructionAddress || cycles <= 0 ||
+		 (m_hasHooks && (HasHook(bodyAddress) || HasHook(m_instructionAddress))) ||
+		 !m_memoryManager.IsPlainMemory(bodyAddress, 4, false)) {
+		 return 0;
+	 }
+
+	 uint16_t body = m_memoryManager.Read16(bodyAddress);
+	 int counterRegister = branch & 7;
+	 int source = body & 7;
+	 int destination = (body >> 9) & 7;
+	 int size = (body & 0x1000) ? 2 : 4;
+	 bool copy = (body & 0xE1F8) == 0x20D8;  // MOVE.L/W (An)+,(Am)+
+	 uint32_t value = 0;
+	 if ((body & 0xE1F8) == 0x20C0) {
+		 // MOVE.L/W Dn,(Am)+, unless Dn is the counter and changes every pass
+		 if (source == counterRegister) {
+			 return 0;
+		 }
+		 value = m_registers.d[source];
+	 } else if ((body & 0xFFF8) == 0x4298 || (body & 0xFFF8) == 0x4258) {
+		 // CLR.L/W (An)+
+		 destination = source;
+		 size = (body & 0x0080) ? 4 : 2;
+	 } else if (!copy || source == destination) {
+		 return 0;
+	 }
+
+	 // The pass where DBRA falls through is left to the interpreter, as is
+	 // the end of the budget, so execution stops where it always would
+	 int iterationCycles = s_opcodeTable[body].cycles + s_opcodeTable[branch].cycles;
+	 uint32_t& counter = m_registers.d[counterRegister];
+	 uint32_t iterations = std::min<uint32_t>(counter & 0xFFFF, static_cast<uint32_t>(cycles - 1) / iterationCycles);
+	 uint32_t bytes = iterations * size;
+	 uint32_t& to = m_registers.a[destination];
+	 uint32_t toAddress = to & MemoryManager::ADDRESS_MASK;
+	 uint32_t loopAddress = bodyAddress & MemoryManager::ADDRESS_MASK;
+	 uint32_t loopBytes = m_instructionAddress + 4 - bodyAddress;  // Body, DBRA and its displacement
+	 if (iterations == 0 || (toAddress & 1) != 0 || !m_memoryManager.IsPlainMemory(toAddress, bytes, true) ||
+		 loopAddress - toAddress < bytes || toAddress - loopAddress < loopBytes) {
+		 // Writing over the loop itself would change what runs next
+		 return 0;
+	 }
+
+	 uint8_t* target = m_memoryManager.GetDirectPointer(toAddress, bytes);
+	 uint32_t targetXor = m_memoryManager.GetByteAddressXor(toAddress);
+	 if (copy) {
+		 uint32_t& from = m_registers.a[source];
+		 uint32_t fromAddress = from & MemoryManager::ADDRESS_MASK;
+		 // A destination just above the source repeats elements instead of copying them
+		 if ((fromAddress & 1) != 0 || !m_memoryManager.IsPlainMemory(fromAddress, bytes, false) ||
+			 toAddress - fromAddress - 1 < bytes - 1) {
+			 return 0;
+		 }
+		 const uint8_t* origin = m_memoryManager.GetDirectPointer(fromAddress, bytes);
+		 if (m_memoryManager.GetByteAddressXor(fromAddress) == targetXor) {
+			 std::memmove(target, origin, bytes);
+		 } else {
+			 for (uint32_t i = 0; i < bytes; i++) {
+				 target[i ^ HOST_BYTE_XOR] = origin[i];
+			 }
+		 }
+		 from += bytes;
+		 value = (size == 4) ? M68000Ops::LoadDirect<4>(target + bytes - 4, targetXor)
+							 : M68000Ops::LoadDirect<2>(target + bytes - 2, targetXor);
+	 } else if (size == 4) {
+		 M68000Ops::FillDirect<4>(target, targetXor, bytes, value);
+	 } else {
+		 M68000Ops::FillDirect<2>(target, targetXor, bytes, value);
+	 }
+	 m_memoryManager.MarkWritten(toAddress, bytes);
+	 to += bytes;
+	 counter = (counter & 0xFFFF0000) | ((counter & 0xFFFF) - iterations);
+
+	 // Flags as left by the last MOVE or CLR
+	 if (size == 4) {
+		 M68000Ops::SetLogicFlags<4>(*this, value);
+	 } else {
+		 M68000Ops::SetLogicFlags<2>(*this, value);
+	 }
+
+	 int skipped = static_cast<int>(iterations) * iterationCycles;
+	 m_cycleCount += skipped;
+	 return skipped;
+ }
+
+ int M68000CPU::IdleLoopCycles(uint32_t start, uint32_t branchAddress) {
+	 // Registers read before the loop writes them must not be written at all.
+	 // Called after one whole pass, so memory operand addresses computed from
+	 // the current registers are the ones every later iteration reads.
+	 uint32_t readBeforeWrite = 0;
+	 uint32_t written = 0;
+	 bool reachedBranch = false;
+	 int cycles = 0;
+
+	 uint32_t address = start;
+	 while (address <= branchAddress) {
+		 reachedBranch = (address == branchAddress);
+		 uint16_t opcode = m_memoryManager.Read16(address);
+		 address += 2;
+
+		 int reg = opcode & 7;
+		 int dataReg = (opcode >> 9) & 7;
+		 int ea = DecodeEA((opcode >> 3) & 7, reg);
+		 int sizeField = (opcode >> 6) & 3;
+		 int size = sizeField == 0 ? 1 : sizeField == 1 ? 2 : 4;
+		 uint32_t reads = 0;
+		 uint32_t writes = 0;
+		 bool readOnly = false;
+		 cycles += s_opcodeTable[opcode].cycles;
+
+		 if ((opcode & 0xF000) == 0x6000) {
+			 // Bcc out of the loop (not taken while looping), or the loop branch itself (BSR never)
+			 int condition = (opcode >> 8) & 15;
+			 readOnly = condition != 1 && (condition != 0 || reachedBranch);
+			 reads = (condition != 0) ? LOOP_CCR : 0;
+			 bool wordDisplacement = (opcode & 0xFF) == 0;
+			 if (wordDisplacement) {
+				 address += 2;
+			 }
+			 if (!reachedBranch) {
+				 cycles += wordDisplacement ? 2 : -2;
+			 }
+		 } else if (opcode == 0x4E71) {
+			 // NOP
+			 readOnly = true;
+		 } else if ((opcode & 0xFF00) == 0x4A00 && sizeField != 3) {
+			 // TST <ea>
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, size, address, reads);
+			 writes = LOOP_CCR;
+		 } else if ((opcode & 0xF100) == 0xB000 && sizeField != 3) {
+			 // CMP <ea>,Dn
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, size, address, reads);
+			 reads |= 1u << dataReg;
+			 writes = LOOP_CCR;
+		 } else if ((opcode & 0xF0C0) == 0xB0C0) {
+			 // CMPA <ea>,An
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, (opcode & 0x0100) ? 4 : 2, address, reads);
+			 reads |= 1u << (8 + dataReg);
+			 writes = LOOP_CCR;
+		 } else if ((opcode & 0xFF00) == 0x0C00 && sizeField != 3 && ea != EA_AN && ea != EA_IMM) {
+			 // CMPI #imm,<ea>
+			 address += (size == 4) ? 4 : 2;
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, size, address, reads);
+			 writes = LOOP_CCR;
+		 } else if (((opcode & 0xFF00) == 0x0000 || (opcode & 0xFF00) == 0x0200 || (opcode & 0xFF00) == 0x0A00) &&
+					sizeField != 3 && ea == EA_DN) {
+			 // ORI/ANDI/EORI #imm,Dn
+			 address += (size == 4) ? 4 : 2;
+			 readOnly = true;
+			 reads = 1u << reg;
+			 writes = (1u << reg) | LOOP_CCR;
+		 } else if ((opcode & 0xF1C0) == 0x0100 && ea != EA_AN) {
+			 // BTST Dn,<ea> (only Z changes, so the other flags stay constant)
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, 1, address, reads);
+			 reads |= 1u << dataReg;
+			 writes = LOOP_CCR;
+		 } else if ((opcode & 0xFFC0) == 0x0800 && ea != EA_AN && ea != EA_IMM) {
+			 // BTST #n,<ea>
+			 address += 2;
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, 1, address, reads);
+			 writes = LOOP_CCR;
+		 } else if ((opcode & 0xC000) == 0 && (opcode & 0x3000) != 0 && ((opcode >> 6) & 7) <= 1) {
+			 // MOVE <ea>,Dn and MOVEA <ea>,An
+			 int moveSize = ((opcode >> 12) & 3) == 1 ? 1 : ((opcode >> 12) & 3) == 3 ? 2 : 4;
+			 bool toAddress = (opcode & 0x0040) != 0;
+			 readOnly = !(toAddress && moveSize == 1) &&
+						ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, moveSize, address, reads);
+			 writes = toAddress ? 1u << (8 + dataReg) : (1u << dataReg) | LOOP_CCR;
+		 } else if ((opcode & 0xF100) == 0xC000 && sizeField != 3 && ea != EA_AN) {
+			 // AND <ea>,Dn
+			 readOnly = ReadOnlyOperand(m_memoryManager, m_registers, ea, reg, size, address, reads);
+			 reads |= 1u << dataReg;
+			 writes = (1u << dataReg) | LOOP_CCR;
+		 }
+
+		 if (!readOnly) {
+			 return 0;
+		 }
+		 readBeforeWrite |= reads & ~written;
+		 written |= writes;
+	 }
+
+	 return (reachedBranch && (readBeforeWrite & written) == 0) ? cycles : 0;
+ }
+
+ void M68000CPU::RefillPrefetchQueue() {
+	 m_registers.prefetch[0] = m_memoryManager.Read16(m_registers.pc);
+	 m_registers.prefetch[1] = m_memoryManager.Read16(m_registers.pc + 2);
+ }
+
+ uint16_t M68000CPU::FetchNextInstruction() {
+	 uint16_t opcode = m_memoryManager.Read16(m_registers.pc);
+	 m_registers.prefetch[0] = opcode;
+	 m_registers.pc += 2;
+	 return opcode;
+ }
+
+ void M68000CPU::PushLong(uint32_t value) {
+	 m_registers.a[7] -= 4;
+	 m_memoryManager.Write32(m_registers.a[7], value);
+ }
+
+ void M68000CPU::PushWord(uint16_t value) {
+	 m_registers.a[7] -= 2;
+	 m_memoryManager.Write16(m_registers.a[7], value);
+ }
+
+ uint32_t M68000CPU::PopLong() {
+	 uint32_t value = m_memoryManager.Read32(m_registers.a[7]);
+	 m_registers.a[7] += 4;
+	 return value;
+ }
+
+ uint16_t M68000CPU::PopWord() {
+	 uint16_t value = m_memoryManager.Read16(m_registers.a[7]);
+	 m_registers.a[7] += 2;
+	 return value;
+ }
+
+ uint32_t M68000CPU::CalculateEffectiveAddress(uint16_t mode, uint16_t reg) {
+	 // Generic (non-specialised) address calculation, used outside the opcode handlers
+	 switch (DecodeEA(mode, reg)) {
+		 case EA_AI:   return M68000Ops::Address<EA_AI, 4>(*this, reg);
+		 case EA_PI:   return M68000Ops::Address<EA_PI, 4>(*this, reg);
+		 case EA_PD:   return M68000Ops::Address<EA_PD, 4>(*this, reg);
+		 case EA_DI:   return M68000Ops::Address<EA_DI, 4>(*this, reg);
+		 case EA_IX:   return M68000Ops::Address<EA_IX, 4>(*this, reg);
+		 case EA_AW:   return M68000Ops::Address<EA_AW, 4>(*this, reg);
+		 case EA_AL:   return M68000Ops::Address<EA_AL, 4>(*this, reg);
+		 case EA_PCDI: return M68000Ops::Address<EA_PCDI, 4>(*this, reg);
+		 case EA_PCIX: return M68000Ops::Address<EA_PCIX, 4>(*this, reg);
+		 default:      return 0;
+	 }
+ }
+
+ void M68000CPU::SwitchPrivilegeMode(PrivilegeMode newMode) {
+	 bool supervisor = (m_registers.sr & SR_S) != 0;
+	 if (newMode == PrivilegeMode::SUPERVISOR && !supervisor) {
+		 m_registers.usp = m_registers.a[7];
+		 m_registers.a[7] = m_registers.ssp;
+		 m_registers.sr |= SR_S;
+	 } else if (newMode == PrivilegeMode::USER && supervisor) {
+		 m_registers.ssp = m_registers.a[7];
+		 m_registers.a[7] = m_registers.usp;
+		 m_registers.sr &= ~SR_S;
+	 }
+ }
+
+ void M68000CPU::UpdateConditionCodes(uint32_t src, uint32_t dst, uint32_t result, uint16_t size, bool isAdd) {
+	 m_flags = { src, dst, result, size, isAdd ? FlagsOp::ADD : FlagsOp::SUB };
+	 m_extendFlags = m_flags;
+ }
+
+ namespace {
+
+ // Carry out of an ADD/SUB record (also the X flag)
+ bool LazyCarry(uint32_t src, uint32_t dst, uint32_t result, uint32_t msb, bool isAdd) {
+	 if (isAdd) {
+		 return (((src & dst) | (~result & (src | dst))) & msb) != 0;
+	 }
+	 return (((src & ~dst) | (result & ~dst) | (src & result)) & msb) != 0;
+ }
+
+ } // namespace
+
+ uint16_t M68000CPU::ComputeConditionCodes() const {
+	 uint16_t ccr = m_registers.sr & SR_CCR_MASK;
+
+	 if (m_extendFlags.op != FlagsOp::NONE) {
+		 const LazyFlags& f = m_extendFlags;
+		 uint32_t msb = 1u << (f.size * 8 - 1);
+		 bool carry = LazyCarry(f.src, f.dst, f.result, msb, f.op == FlagsOp::ADD);
+		 ccr = (ccr & ~SR_X) | (carry ? SR_X : 0);
+	 }
+
+	 if (m_flags.op == FlagsOp::NONE) {
+		 return ccr;
+	 }
+
+	 const LazyFlags& f = m_flags;
+	 uint32_t msb = 1u << (f.size * 8 - 1);
+	 ccr &= SR_X;
+	 if (f.result == 0) {
+		 ccr |= SR_Z;
+	 }
+	 if (f.result & msb) {
+		 ccr |= SR_N;
+	 }
+	 if (f.op == FlagsOp::LOGIC) {
+		 return ccr;
+	 }
+
+	 bool isAdd = f.op == FlagsOp::ADD;
+	 if (LazyCarry(f.src, f.dst, f.result, msb, isAdd)) {
+		 ccr |= SR_C;
+	 }
+	 uint32_t overflow = isAdd ? (f.src ^ f.result) & (f.dst ^ f.result)
+							   : (f.src ^ f.dst) & (f.result ^ f.dst);
+	 if (overflow & msb) {
+		 ccr |= SR_V;
+	 }
+	 return ccr;
+ }
+
+ void M68000CPU::MaterializeFlags() {
+	 if (m_flags.op != FlagsOp::NONE || m_extendFlags.op != FlagsOp::NONE) {
+		 m_registers.sr = (m_registers.sr & ~SR_CCR_MASK) | ComputeConditionCodes();
+		 m_flags.op = FlagsOp::NONE;
+		 m_extendFlags.op = FlagsOp::NONE;
+	 }
+ }
+
+ } // namespace NiXX32
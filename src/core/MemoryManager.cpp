@@ -0,0 +1,1482 @@
+/**
+ * MemoryManager.cpp
+ * Implementation of the memory management system for NiXX-32 arcade board emulation
+ *
+ * Address decoding is driven by a flat page table that covers the 24-bit
+ * 68000 address space. Plain RAM/ROM pages resolve to a host pointer with a
+ * single shift and load; I/O pages dispatch through a table of typed device
+ * handlers, and everything else falls back to the region list.
+ *
+ * ROM, MAIN_RAM and VIDEO_RAM can optionally be held as host-order 16-bit
+ * words. Word accesses are then native loads and byte accesses XOR the
+ * address with HOST_BYTE_XOR to find the right half of the word.
+ */
+
+ #include "MemoryManager.h"
+ #include "NiXX32System.h"
+
+ #include <algorithm>
+ #include <cstring>
+ #include <fstream>
+ #include <iomanip>
+ #include <sstream>
+ #include <stdexcept>
+
+ #ifndef _WIN32
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #endif
+
+ namespace NiXX32 {
+
+ // Value returned for reads from unmapped or prohibited memory (open bus)
+ constexpr uint8_t OPEN_BUS_BYTE = 0xFF;
+ constexpr uint16_t OPEN_BUS_WORD = 0xFFFF;
+
+ // DMA controller register offsets (the register block mirrors every 16 bytes)
+ constexpr uint32_t DMA_REGISTER_MASK = 0x0F;
+ constexpr uint32_t DMA_SOURCE_HI_REG = 0x00;
+ constexpr uint32_t DMA_SOURCE_LO_REG = 0x02;
+ constexpr uint32_t DMA_DEST_HI_REG = 0x04;
+ constexpr uint32_t DMA_DEST_LO_REG = 0x06;
+ constexpr uint32_t DMA_LENGTH_HI_REG = 0x08;
+ constexpr uint32_t DMA_LENGTH_LO_REG = 0x0A;
+ constexpr uint32_t DMA_CONTROL_REG = 0x0C;
+ constexpr uint32_t DMA_STATUS_REG = 0x0E;
+
+ // DMA control and status bits
+ constexpr uint16_t DMA_CONTROL_START = 0x0001;
+ constexpr uint16_t DMA_STATUS_DONE = 0x0001;
+ constexpr uint16_t DMA_STATUS_ERROR = 0x0002;
+
+ // Each word moved costs one read and one write bus cycle (4 clocks each)
+ constexpr int DMA_CYCLES_PER_WORD = 8;
+
+ /**
+  * Memory buffer
+  */
+ MemoryBuffer::~MemoryBuffer() {
+	 Release();
+ }
+
+ MemoryBuffer::MemoryBuffer(MemoryBuffer&& other) noexcept {
+	 *this = std::move(other);
+ }
+
+ MemoryBuffer& MemoryBuffer::operator=(MemoryBuffer&& other) noexcept {
+	 if (this != &other) {
+		 Release();
+		 m_storage = std::move(other.m_storage);
+		 m_data = other.m_mapped ? other.m_data : m_storage.data();
+		 m_size = other.m_size;
+		 m_mapped = other.m_mapped;
+
+		 other.m_data = nullptr;
+		 other.m_size = 0;
+		 other.m_mapped = false;
+	 }
+	 return *this;
+ }
+
+ void MemoryBuffer::assign(size_t size, uint8_t value) {
+	 Release();
+	 m_storage.assign(size, value);
+	 m_data = m_storage.data();
+	 m_size = size;
+ }
+
+ bool MemoryBuffer::MapFile(const std::string& path, size_t offset, size_t size) {
+ #ifdef _WIN32
+	 (void)path;
+	 (void)offset;
+	 (void)size;
+	 return false;
+ #else
+	 int fd = open(path.c_str(), O_RDONLY);
+	 if (fd < 0) {
+		 return false;
+	 }
+
+	 struct stat fileStat;
+	 if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+		 close(fd);
+		 return false;
+	 }
+
+	 size_t fileSize = static_cast<size_t>(fileStat.st_size);
+	 if (size == 0) {
+		 size = offset + fileSize;
+	 }
+
+	 long hostPageSize = sysconf(_SC_PAGESIZE);
+	 if (offset % static_cast<size_t>(hostPageSize) != 0 || fileSize > size || offset > size - fileSize) {
+		 close(fd);
+		 return false;
+	 }
+
+	 // Reuse the current mapping if it has the right size, otherwise reserve
+	 // an anonymous one and carry over the current contents
+	 uint8_t* base = m_data;
+	 bool newMapping = !m_mapped || m_size != size;
+	 if (newMapping) {
+		 void* reserved = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		 if (reserved == MAP_FAILED) {
+			 close(fd);
+			 return false;
+		 }
+		 base = static_cast<uint8_t*>(reserved);
+	 }
+
+	 // Place the file over the reserved range, writes stay private to this process
+	 void* mapped = mmap(base + offset, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+	 close(fd);
+	 if (mapped == MAP_FAILED) {
+		 if (newMapping) {
+			 munmap(base, size);
+		 }
+		 return false;
+	 }
+
+	 if (newMapping) {
+		 // Anonymous pages start zeroed, only copy chunks that hold data
+		 size_t keep = std::min(m_size, size);
+		 auto carryOver = [&](size_t from, size_t to) {
+			 for (size_t start = from; start < to; start += static_cast<size_t>(hostPageSize)) {
+				 size_t length = std::min(static_cast<size_t>(hostPageSize), to - start);
+				 const uint8_t* chunk = m_data + start;
+				 if (std::any_of(chunk, chunk + length, [](uint8_t b) { return b != 0; })) {
+					 std::memcpy(base + start, chunk, length);
+				 }
+			 }
+		 };
+		 carryOver(0, std::min(offset, keep));
+		 carryOver(std::min(offset + fileSize, keep), keep);
+
+		 Release();
+		 m_data = base;
+		 m_size = size;
+		 m_mapped = true;
+	 }
+
+	 return true;
+ #endif
+ }
+
+ void MemoryBuffer::Release() {
+ #ifndef _WIN32
+	 if (m_mapped && m_data) {
+		 munmap(m_data, m_size);
+	 }
+ #endif
+	 m_storage.clear();
+	 m_storage.shrink_to_fit();
+	 m_data = nullptr;
+	 m_size = 0;
+	 m_mapped = false;
+ }
+
+ MemoryManager::MemoryManager(System& system, Logger& logger)
+	 : m_system(system),
+	   m_logger(logger),
+	   m_configuredVariant(HardwareVariant::NIXX32_ORIGINAL),
+	   m_mainRamSize(0),
+	   m_videoRamSize(0),
+	   m_soundRamSize(0),
+	   m_maxRomSize(0),
+	   m_hostEndianStorage(false),
+	   m_accessStats(PAGE_COUNT),
+	   m_vramDirtyBase(0),
+	   m_vramDirtySize(0),
+	   m_codeWriteListener(nullptr),
+	   m_codeWriteContext(nullptr)
+ {
+	 std::memset(&m_dma, 0, sizeof(m_dma));
+
+	 m_pageTable.assign(PAGE_COUNT, MemoryPage{ nullptr, nullptr, -1, 0, 0, false, nullptr });
+	 m_snapshotDirty.assign(PAGE_COUNT / 64, ~uint64_t(0));
+	 m_codePages.assign(PAGE_COUNT / 64, 0);
+	 m_ioHandlers.resize(1);
+
+	 m_logger.Info("MemoryManager", "Memory manager constructed");
+ }
+
+ MemoryManager::~MemoryManager() {
+	 m_logger.Info("MemoryManager", "Memory manager destructed");
+ }
+
+ bool MemoryManager::Initialize(HardwareVariant variant) {
+	 m_logger.Info("MemoryManager", "Initializing memory manager");
+
+	 // Start from an empty address space, regions are defined by the system
+	 m_regions.clear();
+	 m_regionsByName.clear();
+	 m_ioHandlers.resize(1);
+	 m_snapshotBase.clear();
+	 RebuildPageTable();
+
+	 ConfigureMemoryMap(variant);
+
+	 m_logger.Info("MemoryManager", "Memory manager initialized");
+	 return true;
+ }
+
+ void MemoryManager::Reset() {
+	 // Clear all writable memory, ROM contents are preserved
+	 for (auto& region : m_regions) {
+		 if (region.access != MemoryAccess::READ_ONLY) {
+			 std::fill(region.data.begin(), region.data.end(), 0);
+		 }
+	 }
+
+	 std::memset(&m_dma, 0, sizeof(m_dma));
+
+	 // Cleared memory needs snapshotting and decoding again
+	 for (const auto& region : m_regions) {
+		 if (region.access != MemoryAccess::READ_ONLY) {
+			 MarkWritten(region.startAddress, region.size);
+		 }
+	 }
+
+	 m_logger.Info("MemoryManager", "Memory reset");
+ }
+
+ /**
+  * Memory reads
+  */
+ uint8_t MemoryManager::Read8(uint32_t address) {
+	 address &= ADDRESS_MASK;
+	 const MemoryPage& page = m_pageTable[address >> PAGE_SHIFT];
+	 m_accessStats.RecordPageRead(address >> PAGE_SHIFT);
+
+	 if (page.readPointer) {
+		 return page.readPointer[(address & PAGE_MASK) ^ page.byteXor];
+	 }
+
+	 if (page.ioHandlerIndex) {
+		 const IOHandler& io = m_ioHandlers[page.ioHandlerIndex];
+		 m_accessStats.RecordIORead(address);
+		 return io.read8(io.context, address);
+	 }
+
+	 return ReadSlow8(address, page.regionIndex);
+ }
+
+ uint16_t MemoryManager::Read16(uint32_t address) {
+	 address &= ADDRESS_MASK;
+	 const MemoryPage& page = m_pageTable[address >> PAGE_SHIFT];
+	 m_accessStats.RecordPageRead(address >> PAGE_SHIFT);
+
+	 // Even addresses never straddle a page boundary
+	 if (page.readPointer && (address & 1) == 0) {
+		 const uint8_t* p = page.readPointer + (address & PAGE_MASK);
+		 if (page.byteXor) {
+			 // Host-order word storage, a single native load
+			 uint16_t value;
+			 std::memcpy(&value, p, sizeof(value));
+			 return value;
+		 }
+		 return static_cast<uint16_t>((p[0] << 8) | p[1]);
+	 }
+
+	 if (page.ioHandlerIndex && (address & 1) == 0) {
+		 const IOHandler& io = m_ioHandlers[page.ioHandlerIndex];
+		 m_accessStats.RecordIORead(address);
+		 return io.read16(io.context, address);
+	 }
+
+	 return ReadSlow16(address, page.regionIndex);
+ }
+
+ uint32_t MemoryManager::Read32(uint32_t address) {
+	 // Split into two word accesses, the second word may live on the next page
+	 uint32_t high = Read16(address);
+	 uint32_t low = Read16(address + 2);
+	 return (high << 16) | low;
+ }
+
+ /**
+  * Memory writes
+  */
+ void MemoryManager::Write8(uint32_t address, uint8_t value) {
+	 address &= ADDRESS_MASK;
+	 const MemoryPage& page = m_pageTable[address >> PAGE_SHIFT];
+	 m_accessStats.RecordPageWrite(address >> PAGE_SHIFT);
+
+	 if (page.writePointer) {
+		 page.writePointer[(address & PAGE_MASK) ^ page.byteXor] = value;
+		 if (page.trackDirty) {
+			 MarkVideoRamDirtyBlock(address);
+		 }
+		 return;
+	 }
+
+	 if (page.ioHandlerIndex) {
+		 const IOHandler& io = m_ioHandlers[page.ioHandlerIndex];
+		 m_accessStats.RecordIOWrite(address);
+		 io.write8(io.context, address, value);
+		 return;
+	 }
+
+	 WriteSlow8(address, value, page.regionIndex);
+ }
+
+ void MemoryManager::Write16(uint32_t address, uint16_t value) {
+	 address &= ADDRESS_MASK;
+	 const MemoryPage& page = m_pageTable[address >> PAGE_SHIFT];
+	 m_accessStats.RecordPageWrite(address >> PAGE_SHIFT);
+
+	 if (page.writePointer && (address & 1) == 0) {
+		 uint8_t* p = page.writePointer + (address & PAGE_MASK);
+		 if (page.byteXor) {
+			 std::memcpy(p, &value, sizeof(value));
+		 } else {
+			 p[0] = static_cast<uint8_t>(value >> 8);
+			 p[1] = static_cast<uint8_t>(value & 0xFF);
+		 }
+		 // An even word never straddles a dirty block
+		 if (page.trackDirty) {
+			 MarkVideoRamDirtyBlock(address);
+		 }
+		 return;
+	 }
+
+	 if (page.ioHandlerIndex && (address & 1) == 0) {
+		 const IOHandler& io = m_ioHandlers[page.ioHandlerIndex];
+		 m_accessStats.RecordIOWrite(address);
+		 io.write16(io.context, address, value);
+		 return;
+	 }
+
+	 WriteSlow16(address, value, page.regionIndex);
+ }
+
+ void MemoryManager::Write32(uint32_t address, uint32_t value) {
+	 Write16(address, static_cast<uint16_t>(value >> 16));
+	 Write16(address + 2, static_cast<uint16_t>(value & 0xFFFF));
+ }
+
+ bool MemoryManager::LoadROM(const std::vector<uint8_t>& romData, uint32_t baseAddress) {
+	 return LoadROM(romData.data(), romData.size(), baseAddress);
+ }
+
+ bool MemoryManager::LoadROM(const uint8_t* romData, size_t size, uint32_t baseAddress) {
+	 int regionIndex = FindRegionIndex(baseAddress, true);
+	 if (regionIndex < 0) {
+		 m_logger.Error("MemoryManager", "No memory region at ROM load address " +
+						std::to_string(baseAddress));
+		 return false;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 uint32_t offset = GetRegionRelativeAddress(baseAddress, regionIndex);
+
+	 if (size > region.size - offset) {
+		 m_logger.Error("MemoryManager", "ROM data (" + std::to_string(size) +
+						" bytes) does not fit in region " + region.name);
+		 return false;
+	 }
+
+	 if (region.wordSwapped) {
+		 // Store pre-swapped so word fetches need no conversion
+		 for (size_t i = 0; i < size; i++) {
+			 region.data[region.ByteIndex(offset + static_cast<uint32_t>(i))] = romData[i];
+		 }
+	 } else {
+		 std::copy(romData, romData + size, region.data.begin() + offset);
+	 }
+
+	 MarkWritten(baseAddress, static_cast<uint32_t>(size));
+
+	 m_logger.Info("MemoryManager", "Loaded " + std::to_string(size) +
+				   " bytes into " + region.name);
+	 return true;
+ }
+
+ bool MemoryManager::MapROMFile(const std::string& path, uint32_t baseAddress) {
+	 int regionIndex = FindRegionIndex(baseAddress, true);
+	 if (regionIndex < 0) {
+		 m_logger.Error("MemoryManager", "No memory region at ROM load address " +
+						std::to_string(baseAddress));
+		 return false;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 uint32_t offset = GetRegionRelativeAddress(baseAddress, regionIndex);
+
+	 // Host-endian storage has to rewrite every word, which defeats the mapping.
+	 // Off-bus data is held in another CPU's page table, so it must not move.
+	 if (region.type != MemoryRegionType::ROM || region.wordSwapped || !region.onMainBus) {
+		 return false;
+	 }
+
+	 if (!region.data.MapFile(path, offset, region.size)) {
+		 m_logger.Debug("MemoryManager", "Could not map " + path + ", copying instead");
+		 return false;
+	 }
+
+	 // The backing store moved, refresh the direct pointers
+	 RebuildPageTable();
+
+	 m_logger.Info("MemoryManager", "Mapped " + path + " into " + region.name);
+	 return true;
+ }
+
+ MemoryRegion* MemoryManager::DefineRegion(const std::string& name, uint32_t startAddress,
+										   uint32_t size, MemoryAccess access,
+										   MemoryRegionType type, bool onMainBus) {
+	 if (m_regionsByName.find(name) != m_regionsByName.end()) {
+		 m_logger.Error("MemoryManager", "Memory region already defined: " + name);
+		 return nullptr;
+	 }
+
+	 if (size == 0 || startAddress > ADDRESS_MASK || size - 1 > ADDRESS_MASK - startAddress) {
+		 m_logger.Error("MemoryManager", "Invalid memory region bounds for " + name);
+		 return nullptr;
+	 }
+
+	 MemoryRegion region;
+	 region.name = name;
+	 region.startAddress = startAddress;
+	 region.size = size;
+	 region.access = access;
+	 region.type = type;
+	 region.data.assign(size, 0);
+	 region.onMainBus = onMainBus;
+	 region.wordSwapped = m_hostEndianStorage && IsWordStorageEligible(region);
+
+	 m_regions.push_back(std::move(region));
+	 int regionIndex = static_cast<int>(m_regions.size() - 1);
+	 m_regionsByName[name] = regionIndex;
+
+	 if (type == MemoryRegionType::VIDEO_RAM && m_vramDirtySize == 0) {
+		 ResetVideoRamDirtyTracking();
+	 }
+
+	 MapRegionPages(regionIndex);
+	 MarkWritten(startAddress, size);
+
+	 m_logger.Debug("MemoryManager", "Defined region " + name + " (" +
+					std::to_string(size) + " bytes)");
+
+	 return &m_regions[regionIndex];
+ }
+
+ MemoryRegion* MemoryManager::GetRegionByAddress(uint32_t address) {
+	 int regionIndex = FindRegionIndex(address, true);
+	 return (regionIndex >= 0) ? &m_regions[regionIndex] : nullptr;
+ }
+
+ MemoryRegion* MemoryManager::GetRegionByName(const std::string& name) {
+	 auto it = m_regionsByName.find(name);
+	 return (it != m_regionsByName.end()) ? &m_regions[it->second] : nullptr;
+ }
+
+ bool MemoryManager::SetReadHandlers(const std::string& regionName,
+									 std::function<uint8_t(uint32_t)> handler8,
+									 std::function<uint16_t(uint32_t)> handler16) {
+	 MemoryRegion* region = GetRegionByName(regionName);
+	 if (!region) {
+		 m_logger.Error("MemoryManager", "Cannot set read handlers, unknown region: " + regionName);
+		 return false;
+	 }
+
+	 region->readHandler8 = handler8;
+	 region->readHandler16 = handler16;
+
+	 // Handler regions must not be served from direct pointers
+	 RebuildPageTable();
+	 return true;
+ }
+
+ bool MemoryManager::SetWriteHandlers(const std::string& regionName,
+									  std::function<void(uint32_t, uint8_t)> handler8,
+									  std::function<void(uint32_t, uint16_t)> handler16) {
+	 MemoryRegion* region = GetRegionByName(regionName);
+	 if (!region) {
+		 m_logger.Error("MemoryManager", "Cannot set write handlers, unknown region: " + regionName);
+		 return false;
+	 }
+
+	 region->writeHandler8 = handler8;
+	 region->writeHandler16 = handler16;
+
+	 RebuildPageTable();
+	 return true;
+ }
+
+ uint8_t* MemoryManager::GetDirectPointer(uint32_t address, uint32_t size) {
+	 int regionIndex = FindRegionIndex(address);
+	 if (regionIndex < 0) {
+		 return nullptr;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 uint32_t offset = GetRegionRelativeAddress(address, regionIndex);
+	 if (size > region.size - offset) {
+		 return nullptr;
+	 }
+
+	 // Byte offsets inside word-swapped storage are only meaningful from a word boundary
+	 if (region.wordSwapped && (offset & 1) != 0) {
+		 return nullptr;
+	 }
+
+	 return region.data.data() + offset;
+ }
+
+ uint32_t MemoryManager::GetByteAddressXor(uint32_t address) {
+	 int regionIndex = FindRegionIndex(address);
+	 return (regionIndex >= 0 && m_regions[regionIndex].wordSwapped) ? HOST_BYTE_XOR : 0;
+ }
+
+ bool MemoryManager::IsPlainMemory(uint32_t address, uint32_t size, bool writable) const {
+	 address &= ADDRESS_MASK;
+	 if (MEMORY_STATS_ENABLED || size == 0 || size > ADDRESS_MASK + 1 - address) {
+		 return false;
+	 }
+
+	 uint32_t firstPage = address >> PAGE_SHIFT;
+	 uint32_t lastPage = (address + size - 1) >> PAGE_SHIFT;
+	 int regionIndex = m_pageTable[firstPage].regionIndex;
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 // Direct read pointers are only set on pages without handlers
+		 const MemoryPage& entry = m_pageTable[page];
+		 if (!entry.readPointer || entry.regionIndex != regionIndex) {
+			 return false;
+		 }
+		 // A held-back write pointer still means plain, writable memory
+		 if (writable && !entry.writePointer && !entry.protectedWritePointer) {
+			 return false;
+		 }
+	 }
+	 return true;
+ }
+
+ void MemoryManager::SetHostEndianStorage(bool enabled) {
+	 if (m_hostEndianStorage == enabled) {
+		 return;
+	 }
+
+	 m_hostEndianStorage = enabled;
+
+	 for (auto& region : m_regions) {
+		 if (IsWordStorageEligible(region)) {
+			 ConvertRegionStorage(region, enabled);
+		 }
+	 }
+
+	 RebuildPageTable();
+
+	 m_logger.Info("MemoryManager", std::string("Host-endian word storage ") +
+				   (enabled ? "enabled" : "disabled"));
+ }
+
+ bool MemoryManager::IsHostEndianStorageEnabled() const {
+	 return m_hostEndianStorage;
+ }
+
+ uint8_t MemoryManager::Peek8(uint32_t address) {
+	 int regionIndex = FindRegionIndex(address, true);
+	 if (regionIndex < 0) {
+		 return OPEN_BUS_BYTE;
+	 }
+
+	 const MemoryRegion& region = m_regions[regionIndex];
+	 return region.data[region.ByteIndex(GetRegionRelativeAddress(address, regionIndex))];
+ }
+
+ bool MemoryManager::Poke8(uint32_t address, uint8_t value) {
+	 int regionIndex = FindRegionIndex(address, true);
+	 if (regionIndex < 0) {
+		 return false;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 region.data[region.ByteIndex(GetRegionRelativeAddress(address, regionIndex))] = value;
+	 MarkWritten(address, 1);
+	 return true;
+ }
+
+ void MemoryManager::MarkWritten(uint32_t address, uint32_t size) {
+	 if (size == 0) {
+		 return;
+	 }
+
+	 address &= ADDRESS_MASK;
+	 uint32_t firstPage = address >> PAGE_SHIFT;
+	 uint32_t lastPage = static_cast<uint32_t>(
+		 std::min<uint64_t>(uint64_t(address) + size - 1, ADDRESS_MASK) >> PAGE_SHIFT);
+
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 uint64_t bit = uint64_t(1) << (page & 63);
+		 m_snapshotDirty[page >> 6] |= bit;
+
+		 // Page is dirty now, further writes can go direct
+		 MemoryPage& entry = m_pageTable[page];
+		 if (entry.protectedWritePointer) {
+			 entry.writePointer = entry.protectedWritePointer;
+			 entry.protectedWritePointer = nullptr;
+		 }
+
+		 // Code translated from this page is stale
+		 if (m_codePages[page >> 6] & bit) {
+			 m_codePages[page >> 6] &= ~bit;
+			 if (m_codeWriteListener) {
+				 m_codeWriteListener(m_codeWriteContext, page << PAGE_SHIFT, PAGE_SIZE);
+			 }
+		 }
+	 }
+
+	 MarkVideoRamDirty(address, size);
+ }
+
+ bool MemoryManager::WatchCodePage(uint32_t address) {
+	 uint32_t page = (address & ADDRESS_MASK) >> PAGE_SHIFT;
+	 MemoryPage& entry = m_pageTable[page];
+	 if (!entry.readPointer) {
+		 return false;
+	 }
+
+	 m_codePages[page >> 6] |= uint64_t(1) << (page & 63);
+	 if (entry.writePointer) {
+		 entry.protectedWritePointer = entry.writePointer;
+		 entry.writePointer = nullptr;
+	 }
+	 return true;
+ }
+
+ void MemoryManager::SetCodeWriteListener(CodeWriteListener listener, void* context) {
+	 m_codeWriteListener = listener;
+	 m_codeWriteContext = context;
+ }
+
+ std::shared_ptr<const MemorySnapshot> MemoryManager::TakeSnapshot() {
+	 auto snapshot = std::make_shared<MemorySnapshot>();
+	 m_snapshotBase.resize(m_regions.size());
+
+	 for (size_t i = 0; i < m_regions.size(); i++) {
+		 const MemoryRegion& region = m_regions[i];
+		 if (!IsSnapshotRegion(region)) {
+			 continue;
+		 }
+
+		 auto& base = m_snapshotBase[i];
+		 uint32_t pageCount = (region.size + PAGE_SIZE - 1) >> PAGE_SHIFT;
+		 base.resize(pageCount);
+
+		 // Copy pages written since the last snapshot, share the rest
+		 for (uint32_t k = 0; k < pageCount; k++) {
+			 if (!base[k] || IsSnapshotPageDirty(region, k)) {
+				 uint32_t offset = k << PAGE_SHIFT;
+				 uint32_t length = std::min(PAGE_SIZE, region.size - offset);
+				 const uint8_t* contents = region.data.data() + offset;
+
+				 // Off-bus pages are always dirty, keep the old copy if nothing changed
+				 if (base[k] && !region.onMainBus && std::equal(contents, contents + length, base[k]->begin())) {
+					 continue;
+				 }
+				 base[k] = std::make_shared<const SnapshotPage>(contents, contents + length);
+			 }
+		 }
+
+		 snapshot->regions.push_back({ region.name, region.startAddress, region.size,
+									   region.wordSwapped, base });
+	 }
+
+	 // Regions can share pages, so only clear dirty state once every region is captured
+	 for (const auto& captured : snapshot->regions) {
+		 ProtectSnapshotPages(captured.startAddress, captured.size);
+	 }
+
+	 return snapshot;
+ }
+
+ bool MemoryManager::RestoreSnapshot(const MemorySnapshot& snapshot) {
+	 // Check the whole snapshot first so a mismatch leaves memory untouched
+	 for (const auto& captured : snapshot.regions) {
+		 auto it = m_regionsByName.find(captured.name);
+		 if (it == m_regionsByName.end() ||
+			 m_regions[it->second].startAddress != captured.startAddress ||
+			 m_regions[it->second].size != captured.size ||
+			 captured.pages.size() != ((captured.size + PAGE_SIZE - 1) >> PAGE_SHIFT)) {
+			 m_logger.Error("MemoryManager", "Snapshot does not match memory region " + captured.name);
+			 return false;
+		 }
+	 }
+
+	 m_snapshotBase.resize(m_regions.size());
+
+	 for (const auto& captured : snapshot.regions) {
+		 size_t regionIndex = m_regionsByName[captured.name];
+		 MemoryRegion& region = m_regions[regionIndex];
+		 auto& base = m_snapshotBase[regionIndex];
+		 base.resize(captured.pages.size());
+
+		 bool sameLayout = captured.wordSwapped == region.wordSwapped;
+
+		 for (uint32_t k = 0; k < captured.pages.size(); k++) {
+			 const auto& page = captured.pages[k];
+
+			 // Memory still holds exactly this page
+			 if (sameLayout && base[k] == page && !IsSnapshotPageDirty(region, k)) {
+				 continue;
+			 }
+
+			 uint32_t offset = k << PAGE_SHIFT;
+			 uint8_t* to = region.data.data() + offset;
+			 if (sameLayout) {
+				 std::memcpy(to, page->data(), page->size());
+			 } else {
+				 // Captured in the other storage layout, both sides are whole words
+				 for (size_t j = 0; j < page->size(); j++) {
+					 to[j ^ HOST_BYTE_XOR] = (*page)[j];
+				 }
+			 }
+
+			 MarkWritten(region.startAddress + offset, static_cast<uint32_t>(page->size()));
+			 base[k] = sameLayout ? page : nullptr;
+		 }
+	 }
+
+	 for (const auto& captured : snapshot.regions) {
+		 if (captured.wordSwapped == m_regions[m_regionsByName[captured.name]].wordSwapped) {
+			 ProtectSnapshotPages(captured.startAddress, captured.size);
+		 }
+	 }
+
+	 return true;
+ }
+
+ bool MemoryManager::IsVideoRamDirty(uint32_t address, uint32_t size) const {
+	 address &= ADDRESS_MASK;
+	 if (size == 0 || address - m_vramDirtyBase >= m_vramDirtySize) {
+		 return false;
+	 }
+
+	 uint32_t offset = address - m_vramDirtyBase;
+	 uint32_t end = offset + std::min(size, m_vramDirtySize - offset);
+	 uint32_t firstBlock = offset >> VRAM_DIRTY_SHIFT;
+	 uint32_t lastBlock = (end - 1) >> VRAM_DIRTY_SHIFT;
+
+	 for (uint32_t block = firstBlock; block <= lastBlock; block++) {
+		 if (m_vramDirty[block >> 6] & (uint64_t(1) << (block & 63))) {
+			 return true;
+		 }
+	 }
+
+	 return false;
+ }
+
+ bool MemoryManager::IsAnyVideoRamDirty() const {
+	 return std::any_of(m_vramDirty.begin(), m_vramDirty.end(),
+						[](uint64_t bits) { return bits != 0; });
+ }
+
+ std::vector<uint32_t> MemoryManager::GetDirtyVideoRamBlocks() const {
+	 std::vector<uint32_t> blocks;
+
+	 for (size_t word = 0; word < m_vramDirty.size(); word++) {
+		 uint64_t bits = m_vramDirty[word];
+		 for (uint32_t bit = 0; bits != 0; bit++, bits >>= 1) {
+			 if (bits & 1) {
+				 uint32_t block = static_cast<uint32_t>(word * 64 + bit);
+				 blocks.push_back(m_vramDirtyBase + (block << VRAM_DIRTY_SHIFT));
+			 }
+		 }
+	 }
+
+	 return blocks;
+ }
+
+ void MemoryManager::MarkVideoRamDirty(uint32_t address, uint32_t size) {
+	 SetVideoRamDirtyRange(address, size, true);
+ }
+
+ void MemoryManager::ClearVideoRamDirty(uint32_t address, uint32_t size) {
+	 SetVideoRamDirtyRange(address, size, false);
+ }
+
+ void MemoryManager::ClearVideoRamDirty() {
+	 std::fill(m_vramDirty.begin(), m_vramDirty.end(), 0);
+ }
+
+ const MemoryAccessStats<MEMORY_STATS_ENABLED>& MemoryManager::GetAccessStats() const {
+	 return m_accessStats;
+ }
+
+ void MemoryManager::ResetAccessStats() {
+	 m_accessStats.Reset();
+ }
+
+ bool MemoryManager::ExportAccessStats(const std::string& filePath, MemoryStatsFormat format) {
+	 if (!m_accessStats.IsEnabled()) {
+		 m_logger.Warning("MemoryManager", "Access statistics are not compiled in (NIXX32_MEMORY_STATS)");
+		 return false;
+	 }
+
+	 std::ofstream file(filePath);
+	 if (!file) {
+		 m_logger.Error("MemoryManager", "Failed to open access statistics file: " + filePath);
+		 return false;
+	 }
+
+	 auto hex = [](uint32_t value) {
+		 std::ostringstream ss;
+		 ss << "0x" << std::hex << std::uppercase << std::setw(6) << std::setfill('0') << value;
+		 return ss.str();
+	 };
+
+	 auto regionName = [this](uint32_t page) -> std::string {
+		 int regionIndex = m_pageTable[page].regionIndex;
+		 return regionIndex >= 0 ? m_regions[regionIndex].name : "UNMAPPED";
+	 };
+
+	 auto ioName = [this](uint32_t address) -> std::string {
+		 uint16_t handlerIndex = m_pageTable[address >> PAGE_SHIFT].ioHandlerIndex;
+		 return handlerIndex ? m_ioHandlers[handlerIndex].name : "UNMAPPED";
+	 };
+
+	 const auto& ioRegisters = m_accessStats.GetIORegisterCounts();
+
+	 if (format == MemoryStatsFormat::CSV) {
+		 file << "kind,address,name,reads,writes\n";
+
+		 for (uint32_t page = 0; page < m_accessStats.GetPageCount(); page++) {
+			 MemoryAccessCounts counts = m_accessStats.GetPageCounts(page);
+			 if (counts.reads || counts.writes) {
+				 file << "page," << hex(page << PAGE_SHIFT) << "," << regionName(page) << ","
+					  << counts.reads << "," << counts.writes << "\n";
+			 }
+		 }
+
+		 for (const auto& entry : ioRegisters) {
+			 file << "io," << hex(entry.first) << "," << ioName(entry.first) << ","
+				  << entry.second.reads << "," << entry.second.writes << "\n";
+		 }
+	 } else {
+		 file << "{\n  \"pageSize\": " << PAGE_SIZE << ",\n  \"pages\": [";
+
+		 bool first = true;
+		 for (uint32_t page = 0; page < m_accessStats.GetPageCount(); page++) {
+			 MemoryAccessCounts counts = m_accessStats.GetPageCounts(page);
+			 if (counts.reads || counts.writes) {
+				 file << (first ? "\n" : ",\n")
+					  << "    { \"address\": \"" << hex(page << PAGE_SHIFT) << "\", \"region\": \""
+					  << regionName(page) << "\", \"reads\": " << counts.reads
+					  << ", \"writes\": " << counts.writes << " }";
+				 first = false;
+			 }
+		 }
+
+		 file << "\n  ],\n  \"ioRegisters\": [";
+
+		 first = true;
+		 for (const auto& entry : ioRegisters) {
+			 file << (first ? "\n" : ",\n")
+				  << "    { \"address\": \"" << hex(entry.first) << "\", \"device\": \""
+				  << ioName(entry.first) << "\", \"reads\": " << entry.second.reads
+				  << ", \"writes\": " << entry.second.writes << " }";
+			 first = false;
+		 }
+
+		 file << "\n  ]\n}\n";
+	 }
+
+	 m_logger.Info("MemoryManager", "Access statistics exported to " + filePath);
+	 return true;
+ }
+
+ int MemoryManager::ExecuteDMA(uint32_t source, uint32_t destination, uint32_t words) {
+	 source &= ADDRESS_MASK;
+	 destination &= ADDRESS_MASK;
+
+	 if (words == 0) {
+		 return 0;
+	 }
+
+	 if ((source & 1) != 0 || (destination & 1) != 0) {
+		 m_logger.Warning("MemoryManager", "Unaligned DMA transfer rejected");
+		 return -1;
+	 }
+
+	 int sourceIndex = FindRegionIndex(source);
+	 int destinationIndex = FindRegionIndex(destination);
+	 if (sourceIndex < 0 || destinationIndex < 0) {
+		 m_logger.Warning("MemoryManager", "DMA transfer to or from unmapped memory rejected");
+		 return -1;
+	 }
+
+	 MemoryRegion& sourceRegion = m_regions[sourceIndex];
+	 MemoryRegion& destinationRegion = m_regions[destinationIndex];
+
+	 if (!IsDMAPathSupported(sourceRegion.type, destinationRegion.type)) {
+		 m_logger.Warning("MemoryManager", "Unsupported DMA path " + sourceRegion.name +
+						  " -> " + destinationRegion.name);
+		 return -1;
+	 }
+
+	 uint32_t bytes = words * 2;
+	 uint32_t sourceOffset = GetRegionRelativeAddress(source, sourceIndex);
+	 uint32_t destinationOffset = GetRegionRelativeAddress(destination, destinationIndex);
+
+	 // A transfer running past its region would reach whatever follows it,
+	 // e.g. the I/O registers (including DMA_CONTROL_REG) after VIDEO_RAM
+	 bool inBounds = words <= ADDRESS_MASK / 2 &&
+					 bytes <= sourceRegion.size - sourceOffset &&
+					 bytes <= destinationRegion.size - destinationOffset;
+	 if (!inBounds) {
+		 m_logger.Warning("MemoryManager", "DMA transfer past the end of " + sourceRegion.name +
+						  " or " + destinationRegion.name + " rejected");
+		 return -1;
+	 }
+
+	 bool plainMemory = !sourceRegion.hasHandlers() && !destinationRegion.hasHandlers();
+
+	 if (plainMemory) {
+		 const uint8_t* from = sourceRegion.data.data() + sourceOffset;
+		 uint8_t* to = destinationRegion.data.data() + destinationOffset;
+
+		 if (sourceRegion.wordSwapped == destinationRegion.wordSwapped) {
+			 // Same storage layout on both sides, one bulk copy
+			 std::memmove(to, from, bytes);
+		 } else {
+			 // Word-aligned copy between layouts only swaps each byte pair
+			 for (uint32_t i = 0; i < bytes; i++) {
+				 to[i ^ HOST_BYTE_XOR] = from[i];
+			 }
+		 }
+
+		 MarkWritten(destination, bytes);
+	 } else {
+		 // Fall back to bus accesses for regions with handlers
+		 for (uint32_t i = 0; i < words; i++) {
+			 Write16(destination + i * 2, Read16(source + i * 2));
+		 }
+	 }
+
+	 // The CPU is held off the bus for the duration of the transfer
+	 int cycles = static_cast<int>(words) * DMA_CYCLES_PER_WORD;
+	 m_system.GetMainCPU().StealCycles(cycles);
+
+	 return cycles;
+ }
+
+ void MemoryManager::HandleDMARegisterWrite(uint32_t address, uint16_t value) {
+	 switch (address & DMA_REGISTER_MASK) {
+		 case DMA_SOURCE_HI_REG:
+			 m_dma.source = (m_dma.source & 0x0000FFFF) | (static_cast<uint32_t>(value & 0xFF) << 16);
+			 break;
+
+		 case DMA_SOURCE_LO_REG:
+			 m_dma.source = (m_dma.source & 0x00FF0000) | value;
+			 break;
+
+		 case DMA_DEST_HI_REG:
+			 m_dma.destination = (m_dma.destination & 0x0000FFFF) | (static_cast<uint32_t>(value & 0xFF) << 16);
+			 break;
+
+		 case DMA_DEST_LO_REG:
+			 m_dma.destination = (m_dma.destination & 0x00FF0000) | value;
+			 break;
+
+		 case DMA_LENGTH_HI_REG:
+			 m_dma.length = (m_dma.length & 0x0000FFFF) | (static_cast<uint32_t>(value & 0xFF) << 16);
+			 break;
+
+		 case DMA_LENGTH_LO_REG:
+			 m_dma.length = (m_dma.length & 0x00FF0000) | value;
+			 break;
+
+		 case DMA_CONTROL_REG:
+			 m_dma.control = value;
+			 if (value & DMA_CONTROL_START) {
+				 int cycles = ExecuteDMA(m_dma.source, m_dma.destination, m_dma.length);
+				 m_dma.status = (cycles < 0) ? DMA_STATUS_ERROR : DMA_STATUS_DONE;
+				 m_dma.control &= ~DMA_CONTROL_START;
+			 }
+			 break;
+
+		 case DMA_STATUS_REG:
+			 // Writing to the status register acknowledges completion/error
+			 m_dma.status &= ~value;
+			 break;
+
+		 default:
+			 m_logger.Warning("MemoryManager", "Write to unknown DMA register: " + std::to_string(address));
+			 break;
+	 }
+ }
+
+ uint16_t MemoryManager::HandleDMARegisterRead(uint32_t address) {
+	 switch (address & DMA_REGISTER_MASK) {
+		 case DMA_SOURCE_HI_REG:
+			 return static_cast<uint16_t>(m_dma.source >> 16);
+
+		 case DMA_SOURCE_LO_REG:
+			 return static_cast<uint16_t>(m_dma.source & 0xFFFF);
+
+		 case DMA_DEST_HI_REG:
+			 return static_cast<uint16_t>(m_dma.destination >> 16);
+
+		 case DMA_DEST_LO_REG:
+			 return static_cast<uint16_t>(m_dma.destination & 0xFFFF);
+
+		 case DMA_LENGTH_HI_REG:
+			 return static_cast<uint16_t>(m_dma.length >> 16);
+
+		 case DMA_LENGTH_LO_REG:
+			 return static_cast<uint16_t>(m_dma.length & 0xFFFF);
+
+		 case DMA_CONTROL_REG:
+			 return m_dma.control;
+
+		 case DMA_STATUS_REG:
+			 return m_dma.status;
+
+		 default:
+			 m_logger.Warning("MemoryManager", "Read from unknown DMA register: " + std::to_string(address));
+			 return OPEN_BUS_WORD;
+	 }
+ }
+
+ void MemoryManager::ConfigureMemoryMap(HardwareVariant variant) {
+	 m_configuredVariant = variant;
+
+	 if (variant == HardwareVariant::NIXX32_ORIGINAL) {
+		 ConfigureOriginalHardware();
+	 } else {
+		 ConfigurePlusHardware();
+	 }
+ }
+
+ void MemoryManager::ConfigureOriginalHardware() {
+	 m_mainRamSize = 0x100000;   // 1MB
+	 m_videoRamSize = 0x080000;  // 512KB
+	 m_soundRamSize = 0x020000;  // 128KB
+	 m_maxRomSize = 0x200000;    // 2MB
+
+	 m_logger.Info("MemoryManager", "Configured for original NiXX-32 hardware");
+ }
+
+ void MemoryManager::ConfigurePlusHardware() {
+	 m_mainRamSize = 0x200000;   // 2MB
+	 m_videoRamSize = 0x100000;  // 1MB
+	 m_soundRamSize = 0x040000;  // 256KB
+	 m_maxRomSize = 0x400000;    // 4MB
+
+	 m_logger.Info("MemoryManager", "Configured for enhanced NiXX-32+ hardware");
+ }
+
+ // Private helper methods
+
+ void MemoryManager::RebuildPageTable() {
+	 std::fill(m_pageTable.begin(), m_pageTable.end(), MemoryPage{ nullptr, nullptr, -1, 0, 0, false, nullptr });
+
+	 // Write protection is gone with the old table, the next snapshot copies everything
+	 std::fill(m_snapshotDirty.begin(), m_snapshotDirty.end(), ~uint64_t(0));
+	 ResetVideoRamDirtyTracking();
+
+	 // Code watches went with the old table too
+	 std::fill(m_codePages.begin(), m_codePages.end(), 0);
+	 if (m_codeWriteListener) {
+		 m_codeWriteListener(m_codeWriteContext, 0, ADDRESS_MASK + 1);
+	 }
+
+	 for (size_t i = 0; i < m_regions.size(); i++) {
+		 MapRegionPages(static_cast<int>(i));
+	 }
+
+	 for (size_t i = 1; i < m_ioHandlers.size(); i++) {
+		 MapIOHandlerPages(static_cast<uint16_t>(i));
+	 }
+ }
+
+ void MemoryManager::MapRegionPages(int regionIndex) {
+	 MemoryRegion& region = m_regions[regionIndex];
+	 if (!region.onMainBus) {
+		 return;
+	 }
+
+	 uint32_t firstPage = region.startAddress >> PAGE_SHIFT;
+	 uint32_t lastPage = (region.startAddress + region.size - 1) >> PAGE_SHIFT;
+
+	 // I/O registers are never plain memory, they go through handlers
+	 bool isIO = (region.type == MemoryRegionType::IO_REGISTERS);
+	 bool directRead = !isIO && !region.readHandler8 && !region.readHandler16 &&
+					   (region.access == MemoryAccess::READ_ONLY || region.access == MemoryAccess::READ_WRITE);
+	 bool directWrite = !isIO && !region.writeHandler8 && !region.writeHandler16 &&
+						(region.access == MemoryAccess::WRITE_ONLY || region.access == MemoryAccess::READ_WRITE);
+
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 MemoryPage& entry = m_pageTable[page];
+
+		 // Regions defined first keep ownership of shared pages (first match wins)
+		 if (entry.regionIndex >= 0) {
+			 continue;
+		 }
+
+		 entry.regionIndex = regionIndex;
+
+		 // Only pages fully covered by the region can be served directly
+		 uint32_t pageStart = page << PAGE_SHIFT;
+		 bool fullPage = pageStart >= region.startAddress &&
+						 pageStart + PAGE_SIZE <= region.startAddress + region.size;
+		 if (!fullPage) {
+			 continue;
+		 }
+
+		 uint8_t* host = region.data.data() + (pageStart - region.startAddress);
+		 entry.readPointer = directRead ? host : nullptr;
+		 entry.writePointer = directWrite ? host : nullptr;
+		 entry.byteXor = region.wordSwapped ? HOST_BYTE_XOR : 0;
+		 entry.trackDirty = directWrite && region.type == MemoryRegionType::VIDEO_RAM &&
+							region.startAddress == m_vramDirtyBase;
+	 }
+ }
+
+ bool MemoryManager::IsWordStorageEligible(const MemoryRegion& region) const {
+	 // Off-bus regions are read by another CPU one byte at a time
+	 if (!region.onMainBus) {
+		 return false;
+	 }
+
+	 bool eligibleType = region.type == MemoryRegionType::ROM ||
+						 region.type == MemoryRegionType::MAIN_RAM ||
+						 region.type == MemoryRegionType::VIDEO_RAM;
+
+	 return eligibleType && (region.startAddress & 1) == 0 && (region.size & 1) == 0;
+ }
+
+ void MemoryManager::ConvertRegionStorage(MemoryRegion& region, bool wordSwapped) {
+	 if (region.wordSwapped == wordSwapped) {
+		 return;
+	 }
+
+	 // Both directions are the same byte swap within each word
+	 if (HOST_BYTE_XOR) {
+		 for (size_t i = 0; i + 1 < region.data.size(); i += 2) {
+			 std::swap(region.data[i], region.data[i + 1]);
+		 }
+	 }
+
+	 region.wordSwapped = wordSwapped;
+ }
+
+ bool MemoryManager::IsSnapshotRegion(const MemoryRegion& region) const {
+	 return region.type != MemoryRegionType::IO_REGISTERS &&
+			(region.access == MemoryAccess::READ_WRITE || region.access == MemoryAccess::WRITE_ONLY);
+ }
+
+ bool MemoryManager::IsSnapshotPageDirty(const MemoryRegion& region, uint32_t regionPage) const {
+	 // Another CPU writes off-bus regions directly, so nothing tracks their pages
+	 if (!region.onMainBus) {
+		 return true;
+	 }
+
+	 uint32_t start = region.startAddress + (regionPage << PAGE_SHIFT);
+	 uint32_t end = start + std::min(PAGE_SIZE, region.size - (regionPage << PAGE_SHIFT)) - 1;
+
+	 // A region that is not page aligned spans two table pages per snapshot page
+	 for (uint32_t page = start >> PAGE_SHIFT; page <= (end >> PAGE_SHIFT); page++) {
+		 if (m_snapshotDirty[page >> 6] & (uint64_t(1) << (page & 63))) {
+			 return true;
+		 }
+	 }
+
+	 return false;
+ }
+
+ void MemoryManager::ProtectSnapshotPages(uint32_t address, uint32_t size) {
+	 // Partial pages may hold other, unsnapshotted data, leave them dirty
+	 if ((address & PAGE_MASK) != 0 || (size & PAGE_MASK) != 0) {
+		 return;
+	 }
+
+	 uint32_t firstPage = address >> PAGE_SHIFT;
+	 uint32_t lastPage = (address + size - 1) >> PAGE_SHIFT;
+
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 uint64_t bit = uint64_t(1) << (page & 63);
+		 if (!(m_snapshotDirty[page >> 6] & bit)) {
+			 continue;
+		 }
+		 m_snapshotDirty[page >> 6] &= ~bit;
+
+		 // Hold back direct writes so the next write marks the page dirty again
+		 MemoryPage& entry = m_pageTable[page];
+		 if (entry.writePointer && entry.regionIndex >= 0 && IsSnapshotRegion(m_regions[entry.regionIndex])) {
+			 entry.protectedWritePointer = entry.writePointer;
+			 entry.writePointer = nullptr;
+		 }
+	 }
+ }
+
+ void MemoryManager::ResetVideoRamDirtyTracking() {
+	 m_vramDirty.clear();
+	 m_vramDirtyBase = 0;
+	 m_vramDirtySize = 0;
+
+	 for (const auto& region : m_regions) {
+		 if (region.type == MemoryRegionType::VIDEO_RAM) {
+			 m_vramDirtyBase = region.startAddress;
+			 m_vramDirtySize = region.size;
+			 break;
+		 }
+	 }
+
+	 // New backing store, nothing the graphics side decoded is valid any more
+	 uint32_t blocks = (m_vramDirtySize + VRAM_DIRTY_BLOCK_SIZE - 1) >> VRAM_DIRTY_SHIFT;
+	 m_vramDirty.assign((blocks + 63) / 64, 0);
+	 MarkVideoRamDirty(m_vramDirtyBase, m_vramDirtySize);
+ }
+
+ void MemoryManager::MarkVideoRamDirtyBlock(uint32_t address) {
+	 uint32_t block = (address - m_vramDirtyBase) >> VRAM_DIRTY_SHIFT;
+	 m_vramDirty[block >> 6] |= uint64_t(1) << (block & 63);
+ }
+
+ void MemoryManager::SetVideoRamDirtyRange(uint32_t address, uint32_t size, bool dirty) {
+	 address &= ADDRESS_MASK;
+	 if (size == 0 || address - m_vramDirtyBase >= m_vramDirtySize) {
+		 return;
+	 }
+
+	 uint32_t offset = address - m_vramDirtyBase;
+	 uint32_t end = offset + std::min(size, m_vramDirtySize - offset);
+	 uint32_t firstBlock = offset >> VRAM_DIRTY_SHIFT;
+	 uint32_t lastBlock = (end - 1) >> VRAM_DIRTY_SHIFT;
+
+	 for (uint32_t block = firstBlock; block <= lastBlock; block++) {
+		 uint64_t bit = uint64_t(1) << (block & 63);
+		 if (dirty) {
+			 m_vramDirty[block >> 6] |= bit;
+		 } else {
+			 m_vramDirty[block >> 6] &= ~bit;
+		 }
+	 }
+ }
+
+ bool MemoryManager::IsDMAPathSupported(MemoryRegionType sourceType,
+										  MemoryRegionType destinationType) const {
+	 switch (destinationType) {
+		 case MemoryRegionType::VIDEO_RAM:
+			 return sourceType == MemoryRegionType::ROM || sourceType == MemoryRegionType::MAIN_RAM;
+
+		 case MemoryRegionType::SOUND_RAM:
+			 return sourceType == MemoryRegionType::MAIN_RAM;
+
+		 default:
+			 return false;
+	 }
+ }
+
+ bool MemoryManager::AddIOHandler(const IOHandler& handler) {
+	 if (handler.size == 0 || handler.startAddress > ADDRESS_MASK ||
+		 handler.size - 1 > ADDRESS_MASK - handler.startAddress) {
+		 m_logger.Error("MemoryManager", "Invalid I/O window bounds for " + handler.name);
+		 return false;
+	 }
+
+	 if (m_ioHandlers.size() > UINT16_MAX) {
+		 m_logger.Error("MemoryManager", "I/O dispatch table full, cannot map " + handler.name);
+		 return false;
+	 }
+
+	 // Windows are bound per page, so two devices cannot share a page
+	 uint32_t firstPage = handler.startAddress >> PAGE_SHIFT;
+	 uint32_t lastPage = (handler.startAddress + handler.size - 1) >> PAGE_SHIFT;
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 if (m_pageTable[page].ioHandlerIndex) {
+			 m_logger.Error("MemoryManager", "I/O window " + handler.name + " overlaps " +
+							m_ioHandlers[m_pageTable[page].ioHandlerIndex].name);
+			 return false;
+		 }
+	 }
+
+	 m_ioHandlers.push_back(handler);
+	 MapIOHandlerPages(static_cast<uint16_t>(m_ioHandlers.size() - 1));
+
+	 m_logger.Debug("MemoryManager", "Mapped I/O window " + handler.name);
+	 return true;
+ }
+
+ void MemoryManager::MapIOHandlerPages(uint16_t handlerIndex) {
+	 const IOHandler& handler = m_ioHandlers[handlerIndex];
+
+	 uint32_t firstPage = handler.startAddress >> PAGE_SHIFT;
+	 uint32_t lastPage = (handler.startAddress + handler.size - 1) >> PAGE_SHIFT;
+
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 MemoryPage& entry = m_pageTable[page];
+		 entry.readPointer = nullptr;
+		 entry.writePointer = nullptr;
+		 entry.ioHandlerIndex = handlerIndex;
+	 }
+ }
+
+ uint8_t MemoryManager::ReadSlow8(uint32_t address, int regionIndex) {
+	 if (regionIndex < 0 || address - m_regions[regionIndex].startAddress >= m_regions[regionIndex].size) {
+		 regionIndex = FindRegionIndex(address);
+	 }
+
+	 if (regionIndex < 0) {
+		 HandleIllegalAccess(address, false, 8);
+		 return OPEN_BUS_BYTE;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 if (region.readHandler8) {
+		 return region.readHandler8(address);
+	 }
+
+	 if (region.type == MemoryRegionType::IO_REGISTERS ||
+		 region.access == MemoryAccess::WRITE_ONLY || region.access == MemoryAccess::NONE) {
+		 HandleIllegalAccess(address, false, 8);
+		 return OPEN_BUS_BYTE;
+	 }
+
+	 return region.data[region.ByteIndex(GetRegionRelativeAddress(address, regionIndex))];
+ }
+
+ uint16_t MemoryManager::ReadSlow16(uint32_t address, int regionIndex) {
+	 if ((address & 1) != 0) {
+		 // The 68000 raises an address error for this, let the CPU decide
+		 HandleIllegalAccess(address, false, 16);
+		 return OPEN_BUS_WORD;
+	 }
+
+	 if (regionIndex < 0 || address - m_regions[regionIndex].startAddress >= m_regions[regionIndex].size) {
+		 regionIndex = FindRegionIndex(address);
+	 }
+
+	 if (regionIndex < 0) {
+		 HandleIllegalAccess(address, false, 16);
+		 return OPEN_BUS_WORD;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 if (region.readHandler16) {
+		 return region.readHandler16(address);
+	 }
+
+	 if (region.readHandler8) {
+		 return static_cast<uint16_t>((region.readHandler8(address) << 8) | region.readHandler8(address + 1));
+	 }
+
+	 if (region.type == MemoryRegionType::IO_REGISTERS ||
+		 region.access == MemoryAccess::WRITE_ONLY || region.access == MemoryAccess::NONE) {
+		 HandleIllegalAccess(address, false, 16);
+		 return OPEN_BUS_WORD;
+	 }
+
+	 uint32_t offset = GetRegionRelativeAddress(address, regionIndex);
+	 if (offset + 1 >= region.size) {
+		 HandleIllegalAccess(address, false, 16);
+		 return OPEN_BUS_WORD;
+	 }
+
+	 return static_cast<uint16_t>((region.data[region.ByteIndex(offset)] << 8) |
+								  region.data[region.ByteIndex(offset + 1)]);
+ }
+
+ void MemoryManager::WriteSlow8(uint32_t address, uint8_t value, int regionIndex) {
+	 if (regionIndex < 0 || address - m_regions[regionIndex].startAddress >= m_regions[regionIndex].size) {
+		 regionIndex = FindRegionIndex(address);
+	 }
+
+	 if (regionIndex < 0) {
+		 HandleIllegalAccess(address, true, 8);
+		 return;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 if (region.writeHandler8) {
+		 region.writeHandler8(address, value);
+		 return;
+	 }
+
+	 if (region.type == MemoryRegionType::IO_REGISTERS ||
+		 region.access == MemoryAccess::READ_ONLY || region.access == MemoryAccess::NONE) {
+		 HandleIllegalAccess(address, true, 8);
+		 return;
+	 }
+
+	 region.data[region.ByteIndex(GetRegionRelativeAddress(address, regionIndex))] = value;
+	 MarkWritten(address, 1);
+ }
+
+ void MemoryManager::WriteSlow16(uint32_t address, uint16_t value, int regionIndex) {
+	 if ((address & 1) != 0) {
+		 HandleIllegalAccess(address, true, 16);
+		 return;
+	 }
+
+	 if (regionIndex < 0 || address - m_regions[regionIndex].startAddress >= m_regions[regionIndex].size) {
+		 regionIndex = FindRegionIndex(address);
+	 }
+
+	 if (regionIndex < 0) {
+		 HandleIllegalAccess(address, true, 16);
+		 return;
+	 }
+
+	 MemoryRegion& region = m_regions[regionIndex];
+	 if (region.writeHandler16) {
+		 region.writeHandler16(address, value);
+		 return;
+	 }
+
+	 if (region.writeHandler8) {
+		 region.writeHandler8(address, static_cast<uint8_t>(value >> 8));
+		 region.writeHandler8(address + 1, static_cast<uint8_t>(value & 0xFF));
+		 return;
+	 }
+
+	 if (region.type == MemoryRegionType::IO_REGISTERS ||
+		 region.access == MemoryAccess::READ_ONLY || region.access == MemoryAccess::NONE) {
+		 HandleIllegalAccess(address, true, 16);
+		 return;
+	 }
+
+	 uint32_t offset = GetRegionRelativeAddress(address, regionIndex);
+	 if (offset + 1 >= region.size) {
+		 HandleIllegalAccess(address, true, 16);
+		 return;
+	 }
+
+	 region.data[region.ByteIndex(offset)] = static_cast<uint8_t>(value >> 8);
+	 region.data[region.ByteIndex(offset + 1)] = static_cast<uint8_t>(value & 0xFF);
+	 MarkWritten(address, 2);
+ }
+
+ int MemoryManager::FindRegionIndex(uint32_t address, bool includeOffBus) {
+	 address &= ADDRESS_MASK;
+
+	 // The page table gives the answer directly unless the page is shared
+	 int hint = m_pageTable[address >> PAGE_SHIFT].regionIndex;
+	 if (hint >= 0 && address - m_regions[hint].startAddress < m_regions[hint].size) {
+		 return hint;
+	 }
+
+	 for (size_t i = 0; i < m_regions.size(); i++) {
+		 if ((includeOffBus || m_regions[i].onMainBus) &&
+			 address - m_regions[i].startAddress < m_regions[i].size) {
+			 return static_cast<int>(i);
+		 }
+	 }
+
+	 return -1;
+ }
+
+ uint32_t MemoryManager::GetRegionRelativeAddress(uint32_t address, int regionIndex) {
+	 return (address & ADDRESS_MASK) - m_regions[regionIndex].startAddress;
+ }
+
+ void MemoryManager::HandleIllegalAccess(uint32_t address, bool isWrite, int size) {
+	 m_logger.Warning("MemoryManager", std::string("Illegal ") + std::to_string(size) + "-bit " +
+					  (isWrite ? "write to" : "read from") + " address " + std::to_string(address));
+ }
+
+ } // namespace NiXX32
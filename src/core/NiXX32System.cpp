@@ -5,7 +5,9 @@
 
 #include "NiXX32System.h"
 #include "Debugger.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <chrono>
 #include <thread>
 #include <stdexcept>
@@ -49,8 +51,27 @@ namespace {
         static constexpr uint16_t ROM_SIZE  = 0x8000; // 32KB
         static constexpr uint16_t RAM_BASE  = 0x8000;
         static constexpr uint16_t RAM_SIZE  = 0x8000; // 32KB
+        
+        // Optional view of the first 16KB of SOUND_RAM over the top of work
+        // RAM (memory.z80SoundRamWindow)
+        static constexpr uint16_t SOUND_RAM_WINDOW_BASE = 0xC000;
+        static constexpr uint32_t SOUND_RAM_WINDOW_SIZE = 0x4000;
+        
+        // Where MemoryManager keeps the Z80's ROM and RAM, off the 68000 bus
+        static constexpr uint32_t REGION_BASE = 0xFF0000;
+    };
+    
+    // Video timing (same for both variants)
+    struct VideoTiming {
+        static constexpr int VISIBLE_LINES = 224;
+        static constexpr int TOTAL_LINES   = 262;
+        static constexpr int FRAME_RATE    = 60;  // Hz
     };
     
+    // Audio chip timers are stepped this many times per frame, each time
+    // after the audio CPU has been caught up
+    constexpr int AUDIO_STEPS_PER_FRAME = 16;
+    
     // IO Register address ranges
     struct IORegisters {
         static constexpr uint32_t GRAPHICS_BASE = 0x000000; // Offset from IO_REGISTERS_BASE
@@ -59,6 +80,8 @@ namespace {
         static constexpr uint32_t INPUT_SIZE    = 0x000100; // 256 bytes
         static constexpr uint32_t AUDIO_BASE    = 0x002000; // Offset from IO_REGISTERS_BASE
         static constexpr uint32_t AUDIO_SIZE    = 0x000100; // 256 bytes
+        static constexpr uint32_t DMA_BASE      = 0x003000; // Offset from IO_REGISTERS_BASE
+        static constexpr uint32_t DMA_SIZE      = 0x000010; // 16 bytes
     };
 
 }
@@ -69,6 +92,20 @@ System::System(HardwareVariant variant, const std::string& configPath)
     : m_variant(variant),
       m_initialized(false),
       m_paused(false),
+      m_sleepAccumulator(0.0f),
+      m_sharedSoundRam(nullptr),
+      m_sharedSoundRamBase(0),
+      m_audioSyncMainCycles(0),
+      m_audioCycleBalance(0),
+      m_audioSyncRemainder(0),
+      m_runTarget(0),
+      m_cycleFraction(0.0),
+      m_frameStartTime(0),
+      m_frameCycles(0),
+      m_nextScanline(0),
+      m_audioStep(0),
+      m_frameCount(0),
+      m_scanlineRendering(false),
       m_debugger(nullptr)
 {
     try {
@@ -221,6 +258,15 @@ bool System::Initialize(const std::string& romPath) {
             throw std::runtime_error("Failed to initialize main CPU");
         }
         
+        // Optionally run the main CPU through the block cache core
+        if (m_config->HasOption("cpu.mainCore") &&
+            m_config->GetString("cpu.mainCore") == "blockCache") {
+            m_mainCPU->SetCore(M68000Core::BLOCK_CACHE);
+        }
+        if (m_config->HasOption("cpu.idleLoopSkipping")) {
+            m_mainCPU->SetIdleLoopSkipping(m_config->GetBool("cpu.idleLoopSkipping"));
+        }
+        
         // Initialize audio system
         AudioHardwareVariant audioVariant = (m_variant == HardwareVariant::NIXX32_ORIGINAL) ?
                                            AudioHardwareVariant::NIXX32_ORIGINAL :
@@ -282,9 +328,20 @@ bool System::Initialize(const std::string& romPath) {
                 throw std::runtime_error("Failed to load ROM: " + romPath);
             }
             
+            // Release the sound CPU only if the set had a program for it
+            const std::vector<ROMFileInfo>& romFiles = m_romLoader->GetLoadedROMFiles();
+            bool audioProgramLoaded = std::any_of(romFiles.begin(), romFiles.end(),
+                                                  [](const ROMFileInfo& file) { return file.region == "Z80_ROM"; });
+            m_audioCPU->SetResetLine(!audioProgramLoaded);
+            if (!audioProgramLoaded) {
+                m_logger->Warning("System", "ROM set has no Z80_ROM file, holding the sound CPU in reset");
+            }
+            
             m_logger->Info("System", "Successfully loaded ROM: " + romPath);
         }
         
+        StartEventTiming();
+        
         m_initialized = true;
         m_logger->Info("System", "System initialization complete");
         
@@ -323,22 +380,17 @@ void System::RunCycle(float deltaTime) {
 		if (m_powerState == PowerState::SLEEP) {
 			// In sleep mode, we can actually reduce update frequency
 			// to save host CPU resources too (not just emulated hardware)
-			static float sleepAccumulator = 0.0f;
-			sleepAccumulator += deltaTime;
+			m_sleepAccumulator += deltaTime;
 			
 			// Only process updates at 1/10th the normal rate in sleep mode
-			if (sleepAccumulator < 0.1f) {
+			if (m_sleepAccumulator < 0.1f) {
 				return; // Skip this update cycle
 			}
 			
-			adjustedDeltaTime = sleepAccumulator;
-			sleepAccumulator = 0.0f;
+			adjustedDeltaTime = m_sleepAccumulator;
+			m_sleepAccumulator = 0.0f;
 		}
 
-		// Calculate CPU cycles based on elapsed time and clock speeds
-        uint32_t mainCpuCycles = static_cast<uint32_t>(m_mainCPU->GetClockSpeed() * 1000 * adjustedDeltaTime);
-        uint32_t audioCpuCycles = static_cast<uint32_t>(m_audioCPU->GetClockSpeed() * 1000 * adjustedDeltaTime);
-        
         // Allow debugger to control execution if attached
         if (m_debugger) {
             m_debugger->Update();
@@ -349,25 +401,16 @@ void System::RunCycle(float deltaTime) {
             }
         }
         
-        // Execute main CPU cycles
-        int executedMainCycles = m_mainCPU->Execute(mainCpuCycles);
+        // Convert elapsed host time to master clock cycles, carrying the
+        // fraction so no time is lost between calls
+        double cycles = m_mainCPU->GetClockSpeed() * (adjustedDeltaTime / 1000.0) + m_cycleFraction;
+        uint64_t wholeCycles = static_cast<uint64_t>(cycles);
+        m_cycleFraction = cycles - static_cast<double>(wholeCycles);
         
-        // Execute audio CPU cycles - keep in sync with main CPU
-        float mainCpuRatio = static_cast<float>(executedMainCycles) / mainCpuCycles;
-        int adjustedAudioCycles = static_cast<int>(audioCpuCycles * mainCpuRatio);
-        int executedAudioCycles = m_audioCPU->Execute(adjustedAudioCycles);
-        
-        // Update subsystems - they need to know the actual time elapsed
-        // which might be different from adjustedDeltaTime if CPU execution was slower than expected
-        float actualDeltaTime = adjustedDeltaTime * (static_cast<float>(executedMainCycles) / mainCpuCycles);
-        
-        // Update subsystems with the calculated actual time
-        m_graphicsSystem->Update(actualDeltaTime);
-        m_audioSystem->Update(actualDeltaTime);
-        m_inputSystem->Update(actualDeltaTime);
-
-
-
+        // Subsystems are updated by timing events as the target is reached,
+        // so the emulated result does not depend on how time was sliced
+        m_runTarget = std::max(m_runTarget, m_mainCPU->GetCycleCount()) + wholeCycles;
+        RunUntil(m_runTarget);
 	}
     catch (const std::exception& e) {
         m_logger->Error("System", std::string("Error during cycle execution: ") + e.what());
@@ -383,6 +426,10 @@ void System::Reset() {
         // Reset CPUs
         m_mainCPU->Reset();
         m_audioCPU->Reset();
+        ResetAudioSync();
+        StartEventTiming();
+        m_runTarget = 0;
+        m_cycleFraction = 0.0;
         
         // Reset subsystems
         m_memoryManager->Reset();
@@ -481,6 +528,10 @@ InputSystem& System::GetInputSystem() {
     return *m_inputSystem;
 }
 
+HostProfiler& System::GetProfiler() {
+    return m_profiler;
+}
+
 void System::AttachDebugger(std::shared_ptr<Debugger> debugger) {
     m_debugger = debugger;
     if (m_debugger) {
@@ -572,19 +623,8 @@ void System::ConnectSubsystems() {
         uint32_t audioRegionStart = ioRegBase + IORegisters::AUDIO_BASE;
         
         // Register port I/O handlers for audio CPU
-        for (uint8_t port = 0x00; port <= 0x0F; ++port) {
-            uint8_t finalPort = port; // Make a copy for the lambda capture
-            m_audioCPU->RegisterPortHooks(finalPort,
-                // Read handler
-                [this, finalPort]() -> uint8_t { 
-                    return m_audioSystem->HandleRegisterRead(finalPort); 
-                },
-                // Write handler
-                [this, finalPort](uint8_t value) { 
-                    m_audioSystem->HandleRegisterWrite(finalPort, value); 
-                }
-            );
-        }
+        m_audioCPU->MapPortHandlers<&AudioSystem::HandleRegisterRead, &AudioSystem::HandleRegisterWrite>(
+            0x00, 0x10, *m_audioSystem);
         
         // Set up audio command/status communication between main CPU and audio CPU
         // These handlers allow the main CPU to send commands to the audio CPU
@@ -602,19 +642,7 @@ void System::ConnectSubsystems() {
             m_mainCPU->SetInterruptLevel(InterruptLevel::IPL_4);
         });
         
-        // Set up VBLANK interrupt handler
-        // This interrupt occurs at the vertical blanking interval of the display
-        // (typically 60Hz) and is used for timing-critical operations
-        m_mainCPU->RegisterHook(0x00000068, [this]() {
-            // VBLANK interrupt handler (Exception vector 0x68)
-            // Update graphics system with frame timing
-            const float frameTime = 1.0f / 60.0f; // 60Hz refresh rate
-            m_graphicsSystem->Update(frameTime);
-            
-            // Signal audio CPU about VBLANK
-            // Write to a shared memory location or trigger Z80 interrupt
-            m_audioCPU->TriggerInterrupt(Z80InterruptType::INT);
-        });
+        // VBLANK is raised by the event scheduler (see DispatchEvent)
         
         // Connect input system to interrupt handlers
         // When input events occur (e.g., coins inserted, buttons pressed),
@@ -689,6 +717,11 @@ void System::SetupMemoryMap() {
             romSize = m_config->GetInt("memory.maxRomSize") * 1024;
         }
         
+        // Optionally keep the 68000's ROM/RAM/VRAM as host-order words for faster fetches
+        if (m_config->HasOption("memory.hostEndianWords")) {
+            m_memoryManager->SetHostEndianStorage(m_config->GetBool("memory.hostEndianWords"));
+        }
+        
         // Define memory regions for 68000 main CPU
         
         // ROM area
@@ -711,15 +744,42 @@ void System::SetupMemoryMap() {
         m_memoryManager->DefineRegion("SOUND_RAM", soundRamBase, soundRamSize, 
                                       MemoryAccess::READ_WRITE, MemoryRegionType::SOUND_RAM);
         
-        // Define memory regions for Z80 audio CPU
+        // Z80 program ROM and work RAM, kept off the 68000 bus so only the
+        // Z80's own page table reaches them
+        m_memoryManager->DefineRegion("Z80_ROM", Z80Memory::REGION_BASE + Z80Memory::ROM_BASE, Z80Memory::ROM_SIZE,
+                                      MemoryAccess::READ_ONLY, MemoryRegionType::ROM, false);
+        m_memoryManager->DefineRegion("Z80_RAM", Z80Memory::REGION_BASE + Z80Memory::RAM_BASE, Z80Memory::RAM_SIZE,
+                                      MemoryAccess::READ_WRITE, MemoryRegionType::SOUND_RAM, false);
         
-        // Z80 Program ROM
-        m_memoryManager->DefineRegion("Z80_ROM", Z80Memory::ROM_BASE, Z80Memory::ROM_SIZE, 
-                                      MemoryAccess::READ_ONLY, MemoryRegionType::ROM);
+        MemoryRegion* audioRom = m_memoryManager->GetRegionByName("Z80_ROM");
+        MemoryRegion* audioRam = m_memoryManager->GetRegionByName("Z80_RAM");
+        MemoryRegion* soundRam = m_memoryManager->GetRegionByName("SOUND_RAM");
+        if (!audioRom || !audioRam || !soundRam) {
+            throw std::runtime_error("Failed to define Z80 memory regions");
+        }
         
-        // Z80 RAM
-        m_memoryManager->DefineRegion("Z80_RAM", Z80Memory::RAM_BASE, Z80Memory::RAM_SIZE, 
-                                      MemoryAccess::READ_WRITE, MemoryRegionType::SOUND_RAM);
+        bool soundRamWindow = m_config->HasOption("memory.z80SoundRamWindow") &&
+                              m_config->GetBool("memory.z80SoundRamWindow");
+        if (soundRamWindow && soundRam->size < Z80Memory::SOUND_RAM_WINDOW_SIZE) {
+            throw std::runtime_error("SOUND_RAM is too small for the Z80 window");
+        }
+        
+        m_sharedSoundRam = soundRam->data.data();
+        m_sharedSoundRamBase = soundRamBase;
+        
+        bool audioMapped =
+            m_audioCPU->MapMemory(Z80Memory::ROM_BASE, Z80Memory::ROM_SIZE, audioRom->data.data(), false) &&
+            m_audioCPU->MapMemory(Z80Memory::RAM_BASE, Z80Memory::RAM_SIZE, audioRam->data.data(), true) &&
+            (!soundRamWindow ||
+             m_audioCPU->MapMemoryWriteHandler<&System::HandleAudioSoundRamWrite>(
+                 Z80Memory::SOUND_RAM_WINDOW_BASE, Z80Memory::SOUND_RAM_WINDOW_SIZE, m_sharedSoundRam, *this));
+        
+        if (!audioMapped) {
+            throw std::runtime_error("Failed to map Z80 memory");
+        }
+        
+        // Z80_ROM is empty until a ROM set supplies a sound program
+        m_audioCPU->SetResetLine(true);
         
         // Set up memory-mapped I/O handlers
         auto graphicsRegion = m_memoryManager->GetRegionByName("IO_REGISTERS");
@@ -727,116 +787,30 @@ void System::SetupMemoryMap() {
             throw std::runtime_error("Failed to get IO_REGISTERS region");
         }
         
-        // Calculate actual address ranges for I/O handlers
-        uint32_t graphicsRegionStart = ioRegBase + IORegisters::GRAPHICS_BASE;
-        uint32_t graphicsRegionEnd = graphicsRegionStart + IORegisters::GRAPHICS_SIZE - 1;
-        uint32_t inputRegionStart = ioRegBase + IORegisters::INPUT_BASE;
-        uint32_t inputRegionEnd = inputRegionStart + IORegisters::INPUT_SIZE - 1;
-        uint32_t audioRegionStart = ioRegBase + IORegisters::AUDIO_BASE;
-        uint32_t audioRegionEnd = audioRegionStart + IORegisters::AUDIO_SIZE - 1;
-        
-        m_memoryManager->SetReadHandlers("IO_REGISTERS",
-            // 8-bit read handler
-            [this, graphicsRegionStart, graphicsRegionEnd, inputRegionStart, inputRegionEnd, 
-             audioRegionStart, audioRegionEnd](uint32_t address) -> uint8_t {
-                // Check if address is within valid ranges
-                if (address >= graphicsRegionStart && address <= graphicsRegionEnd) {
-                    // Graphics system registers
-                    return m_graphicsSystem->HandleRegisterRead(address) & 0xFF;
-                } else if (address >= inputRegionStart && address <= inputRegionEnd) {
-                    // Input system registers
-                    return m_inputSystem->HandleRegisterRead(address) & 0xFF;
-                } else if (address >= audioRegionStart && address <= audioRegionEnd) {
-                    // Audio system registers (main CPU side)
-                    return m_audioSystem->HandleRegisterRead(address) & 0xFF;
-                }
-                
-                // Log unhandled reads
-                m_logger->Warning("System", "Unhandled I/O read at address: " + 
-                                 std::to_string(address));
-                                 
-                // Default for unhandled addresses
-                return 0xFF;
-            },
-            // 16-bit read handler
-            [this, graphicsRegionStart, graphicsRegionEnd, inputRegionStart, inputRegionEnd,
-             audioRegionStart, audioRegionEnd](uint32_t address) -> uint16_t {
-                // Check if address is within valid ranges (ensure it's 16-bit aligned)
-                if ((address & 1) != 0) {
-                    m_logger->Warning("System", "Unaligned 16-bit I/O read at address: " +
-                                     std::to_string(address));
-                    return 0xFFFF;
-                }
-                
-                if (address >= graphicsRegionStart && address <= graphicsRegionEnd) {
-                    // Graphics system registers
-                    return m_graphicsSystem->HandleRegisterRead(address);
-                } else if (address >= inputRegionStart && address <= inputRegionEnd) {
-                    // Input system registers
-                    return static_cast<uint16_t>(m_inputSystem->HandleRegisterRead(address));
-                } else if (address >= audioRegionStart && address <= audioRegionEnd) {
-                    // Audio system registers (main CPU side)
-                    return static_cast<uint16_t>(m_audioSystem->HandleRegisterRead(address));
-                }
-                
-                // Log unhandled reads
-                m_logger->Warning("System", "Unhandled 16-bit I/O read at address: " + 
-                                 std::to_string(address));
-                                 
-                // Default for unhandled addresses
-                return 0xFFFF;
-            }
-        );
-        
-        m_memoryManager->SetWriteHandlers("IO_REGISTERS",
-            // 8-bit write handler
-            [this, graphicsRegionStart, graphicsRegionEnd, inputRegionStart, inputRegionEnd,
-				audioRegionStart, audioRegionEnd](uint32_t address, uint8_t value) {
-				   // Check if address is within valid ranges
-				   if (address >= graphicsRegionStart && address <= graphicsRegionEnd) {
-					   // Graphics system registers
-					   m_graphicsSystem->HandleRegisterWrite(address, value);
-				   } else if (address >= inputRegionStart && address <= inputRegionEnd) {
-					   // Input system registers
-					   m_inputSystem->HandleRegisterWrite(address, value);
-				   } else if (address >= audioRegionStart && address <= audioRegionEnd) {
-					   // Audio system registers (main CPU side)
-					   m_audioSystem->HandleRegisterWrite(address, value);
-				   } else {
-					   // Log unhandled writes
-					   m_logger->Warning("System", "Unhandled I/O write at address: " + 
-										std::to_string(address) + ", value: " + 
-										std::to_string(value));
-				   }
-			   },
-			   // 16-bit write handler
-			[this, graphicsRegionStart, graphicsRegionEnd, inputRegionStart, inputRegionEnd,
-				audioRegionStart, audioRegionEnd](uint32_t address, uint16_t value) {
-				   // Check if address is 16-bit aligned
-				   if ((address & 1) != 0) {
-					   m_logger->Warning("System", "Unaligned 16-bit I/O write at address: " +
-										std::to_string(address) + ", value: " + 
-										std::to_string(value));
-					   return;
-				   }
-				   
-				   if (address >= graphicsRegionStart && address <= graphicsRegionEnd) {
-					   // Graphics system registers
-					   m_graphicsSystem->HandleRegisterWrite(address, value);
-				   } else if (address >= inputRegionStart && address <= inputRegionEnd) {
-					   // Input system registers
-					   m_inputSystem->HandleRegisterWrite(address, static_cast<uint8_t>(value));
-				   } else if (address >= audioRegionStart && address <= audioRegionEnd) {
-					   // Audio system registers (main CPU side)
-					   m_audioSystem->HandleRegisterWrite(address, static_cast<uint8_t>(value));
-				   } else {
-					   // Log unhandled writes
-					   m_logger->Warning("System", "Unhandled 16-bit I/O write at address: " + 
-										std::to_string(address) + ", value: " + 
-										std::to_string(value));
-				   }
-			   }
-		   );
+        // Bind each subsystem's register window straight to its typed handlers,
+        // so an I/O access is one table lookup and one call with no range checks.
+        // Windows the Z80 can observe go through System to catch it up first.
+        bool ioMapped =
+            m_memoryManager->MapIOHandlers<&GraphicsSystem::HandleRegisterRead, &GraphicsSystem::HandleRegisterWrite>(
+                "GRAPHICS_REGISTERS", ioRegBase + IORegisters::GRAPHICS_BASE, IORegisters::GRAPHICS_SIZE,
+                *m_graphicsSystem) &&
+            m_memoryManager->MapIOHandlers<&InputSystem::HandleRegisterRead, &InputSystem::HandleRegisterWrite>(
+                "INPUT_REGISTERS", ioRegBase + IORegisters::INPUT_BASE, IORegisters::INPUT_SIZE,
+                *m_inputSystem) &&
+            m_memoryManager->MapIOHandlers<&System::HandleAudioRegisterRead, &System::HandleAudioRegisterWrite>(
+                "AUDIO_REGISTERS", ioRegBase + IORegisters::AUDIO_BASE, IORegisters::AUDIO_SIZE,
+                *this) &&
+            m_memoryManager->MapIOHandlers<&System::HandleDMARegisterRead, &System::HandleDMARegisterWrite>(
+                "DMA_REGISTERS", ioRegBase + IORegisters::DMA_BASE, IORegisters::DMA_SIZE,
+                *this) &&
+            (!soundRamWindow ||
+             m_memoryManager->MapIOHandlers<&System::HandleSharedSoundRamRead8, &System::HandleSharedSoundRamRead16,
+                                            &System::HandleSharedSoundRamWrite8, &System::HandleSharedSoundRamWrite16>(
+                 "SHARED_SOUND_RAM", soundRamBase, Z80Memory::SOUND_RAM_WINDOW_SIZE, *this));
+        
+        if (!ioMapped) {
+            throw std::runtime_error("Failed to map I/O register handlers");
+        }
 		   
 		   m_logger->Info("System", "Memory map setup complete");
 	   }
@@ -846,6 +820,227 @@ void System::SetupMemoryMap() {
 	   }
    }
 
+void System::SyncAudioCPU() {
+    uint64_t mainCycles = m_mainCPU->GetCycleCount();
+    uint32_t mainClock = m_mainCPU->GetClockSpeed();
+    if (mainCycles < m_audioSyncMainCycles || mainClock == 0) {
+        ResetAudioSync();
+        return;
+    }
+    
+    // Convert only the time elapsed since the last sync, so clock changes
+    // from power management apply from now on
+    uint64_t scaled = (mainCycles - m_audioSyncMainCycles) * m_audioCPU->GetClockSpeed() + m_audioSyncRemainder;
+    m_audioSyncMainCycles = mainCycles;
+    m_audioSyncRemainder = scaled % mainClock;
+    m_audioCycleBalance += static_cast<int64_t>(scaled / mainClock);
+    
+    if (m_audioCycleBalance <= 0) {
+        return;
+    }
+    
+    int cycles = static_cast<int>(std::min<int64_t>(m_audioCycleBalance, std::numeric_limits<int>::max()));
+    ProfileScope profile(m_profiler, ProfileCategory::AUDIO_CPU);
+    int executed = m_audioCPU->IsWaitingForInterrupt() ?
+                   m_audioCPU->SkipHaltedCycles(cycles) :
+                   m_audioCPU->Execute(cycles);
+    m_audioCycleBalance -= executed;
+}
+
+void System::ResetAudioSync() {
+    m_audioSyncMainCycles = m_mainCPU->GetCycleCount();
+    m_audioCycleBalance = 0;
+    m_audioSyncRemainder = 0;
+}
+
+void System::StartEventTiming() {
+    m_scheduler.Clear();
+    
+    // Both events start a frame at the current time; the next RunUntil()
+    // dispatches them before any code runs
+    uint64_t now = m_mainCPU->GetCycleCount();
+    m_frameStartTime = now;
+    m_frameCycles = std::max<uint64_t>(m_mainCPU->GetClockSpeed() / VideoTiming::FRAME_RATE, 1);
+    m_nextScanline = 0;
+    m_audioStep = AUDIO_STEPS_PER_FRAME - 1;
+    m_scheduler.Schedule(SchedulerEvent::SCANLINE, now);
+    m_scheduler.Schedule(SchedulerEvent::AUDIO_TIMER, now);
+}
+
+void System::RunUntil(uint64_t endTime) {
+    ProfileScope profile(m_profiler, ProfileCategory::SYSTEM);
+    for (;;) {
+        uint64_t now = m_mainCPU->GetCycleCount();
+        
+        SchedulerEvent event;
+        uint64_t eventTime;
+        while (m_scheduler.PopDueEvent(now, event, eventTime)) {
+            DispatchEvent(event, eventTime);
+        }
+        
+        if (now >= endTime) {
+            break;
+        }
+        
+        // Run exactly to the next event (a CPU waiting in STOP just idles there)
+        uint64_t stopTime = std::min(endTime, m_scheduler.GetNextEventTime());
+        int cycles = static_cast<int>(std::min<uint64_t>(stopTime - now, std::numeric_limits<int>::max()));
+        ProfileScope cpuProfile(m_profiler, ProfileCategory::MAIN_CPU);
+        if (m_mainCPU->IsWaitingForInterrupt()) {
+            m_mainCPU->SkipHaltedCycles(cycles);
+        } else {
+            m_mainCPU->Execute(cycles);
+        }
+    }
+}
+
+void System::RunFrame() {
+    if (!m_initialized) {
+        m_logger->Warning("System", "Attempt to run frame on uninitialized system");
+        return;
+    }
+    
+    uint64_t frame = m_frameCount;
+    while (m_frameCount == frame) {
+        RunUntil(m_scheduler.GetNextEventTime());
+    }
+}
+
+void System::SetScanlineRendering(bool enabled) {
+    m_scanlineRendering = enabled;
+    if (m_graphicsSystem) {
+        m_graphicsSystem->SetScanlineRendering(enabled);
+    }
+}
+
+bool System::IsScanlineRendering() const {
+    return m_scanlineRendering;
+}
+
+void System::DispatchEvent(SchedulerEvent event, uint64_t time) {
+    switch (event) {
+        case SchedulerEvent::SCANLINE: {
+            int line = m_nextScanline;
+            if (line == 0) {
+                // Frame length is fixed at its start so every event in the
+                // frame lines up, even if power management changes the clock
+                m_frameStartTime = time;
+                m_frameCycles = std::max<uint64_t>(m_mainCPU->GetClockSpeed() / VideoTiming::FRAME_RATE, 1);
+                m_scheduler.Schedule(SchedulerEvent::VBLANK,
+                                     GetFrameTime(VideoTiming::VISIBLE_LINES, VideoTiming::TOTAL_LINES));
+            }
+            
+            // Only visible lines need to stop the CPUs; otherwise the next
+            // stop is the start of the next frame
+            int nextLine = VideoTiming::TOTAL_LINES;
+            if (m_scanlineRendering && line < VideoTiming::VISIBLE_LINES) {
+                ProfileScope profile(m_profiler, ProfileCategory::GRAPHICS);
+                m_graphicsSystem->RenderScanline(line);
+                if (line + 1 < VideoTiming::VISIBLE_LINES) {
+                    nextLine = line + 1;
+                }
+            }
+            m_scheduler.Schedule(SchedulerEvent::SCANLINE, GetFrameTime(nextLine, VideoTiming::TOTAL_LINES));
+            m_nextScanline = nextLine % VideoTiming::TOTAL_LINES;
+            break;
+        }
+        
+        case SchedulerEvent::VBLANK: {
+            const float frameTime = 1000.0f / VideoTiming::FRAME_RATE;
+            m_frameCount++;
+            
+            // The Z80 sees the frame interrupt at the same point the 68000 does
+            SyncAudioCPU();
+            {
+                ProfileScope profile(m_profiler, ProfileCategory::GRAPHICS);
+                m_graphicsSystem->Update(frameTime);
+            }
+            {
+                ProfileScope profile(m_profiler, ProfileCategory::INPUT);
+                m_inputSystem->Update(frameTime);
+            }
+            
+            // Level 4 autovector (vector 28 -> 0x68), and the Z80 frame interrupt
+            m_mainCPU->SetInterruptLevel(InterruptLevel::IPL_4);
+            m_audioCPU->TriggerInterrupt(Z80InterruptType::INT);
+            break;
+        }
+        
+        case SchedulerEvent::AUDIO_TIMER: {
+            const float stepTime = 1000.0f / (VideoTiming::FRAME_RATE * AUDIO_STEPS_PER_FRAME);
+            m_audioStep = (m_audioStep + 1) % AUDIO_STEPS_PER_FRAME;
+            
+            // Timer interrupts from the audio chips must land on a Z80 that
+            // has run up to now
+            SyncAudioCPU();
+            {
+                ProfileScope profile(m_profiler, ProfileCategory::AUDIO);
+                m_audioSystem->Update(stepTime);
+            }
+            m_scheduler.Schedule(SchedulerEvent::AUDIO_TIMER, GetFrameTime(m_audioStep + 1, AUDIO_STEPS_PER_FRAME));
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
+
+uint64_t System::GetFrameTime(int step, int steps) const {
+    return m_frameStartTime + static_cast<uint64_t>(step) * m_frameCycles / steps;
+}
+
+uint8_t System::HandleAudioRegisterRead(uint32_t address) {
+    SyncAudioCPU();
+    return m_audioSystem->HandleRegisterRead(address);
+}
+
+void System::HandleAudioRegisterWrite(uint32_t address, uint8_t value) {
+    SyncAudioCPU();
+    m_audioSystem->HandleRegisterWrite(address, value);
+}
+
+uint16_t System::HandleDMARegisterRead(uint32_t address) {
+    return m_memoryManager->HandleDMARegisterRead(address);
+}
+
+void System::HandleDMARegisterWrite(uint32_t address, uint16_t value) {
+    // A transfer may land in SOUND_RAM
+    SyncAudioCPU();
+    m_memoryManager->HandleDMARegisterWrite(address, value);
+}
+
+uint8_t System::HandleSharedSoundRamRead8(uint32_t address) {
+    SyncAudioCPU();
+    return m_sharedSoundRam[address - m_sharedSoundRamBase];
+}
+
+uint16_t System::HandleSharedSoundRamRead16(uint32_t address) {
+    SyncAudioCPU();
+    const uint8_t* data = m_sharedSoundRam + (address - m_sharedSoundRamBase);
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+void System::HandleSharedSoundRamWrite8(uint32_t address, uint8_t value) {
+    SyncAudioCPU();
+    m_sharedSoundRam[address - m_sharedSoundRamBase] = value;
+    m_memoryManager->MarkWritten(address, 1);
+}
+
+void System::HandleSharedSoundRamWrite16(uint32_t address, uint16_t value) {
+    SyncAudioCPU();
+    uint8_t* data = m_sharedSoundRam + (address - m_sharedSoundRamBase);
+    data[0] = static_cast<uint8_t>(value >> 8);
+    data[1] = static_cast<uint8_t>(value);
+    m_memoryManager->MarkWritten(address, 2);
+}
+
+void System::HandleAudioSoundRamWrite(uint16_t address, uint8_t value) {
+    uint32_t offset = address - Z80Memory::SOUND_RAM_WINDOW_BASE;
+    m_sharedSoundRam[offset] = value;
+    m_memoryManager->MarkWritten(m_sharedSoundRamBase + offset, 1);
+}
+
 void System::SetupInterruptVectorTable() {
 	m_logger->Info("System", "Setting up 68000 interrupt vector table");
 
@@ -941,10 +1136,10 @@ void System::SetupInterruptVectorTable() {
 				((vectorTable[i] & 0xFF000000) >> 24);
 				
 			uint32_t addr = i * 4;
-			romRegion->data[addr] = (bigEndianValue >> 24) & 0xFF;
-			romRegion->data[addr+1] = (bigEndianValue >> 16) & 0xFF;
-			romRegion->data[addr+2] = (bigEndianValue >> 8) & 0xFF;
-			romRegion->data[addr+3] = bigEndianValue & 0xFF;
+			romRegion->data[romRegion->ByteIndex(addr)] = (bigEndianValue >> 24) & 0xFF;
+			romRegion->data[romRegion->ByteIndex(addr+1)] = (bigEndianValue >> 16) & 0xFF;
+			romRegion->data[romRegion->ByteIndex(addr+2)] = (bigEndianValue >> 8) & 0xFF;
+			romRegion->data[romRegion->ByteIndex(addr+3)] = bigEndianValue & 0xFF;
 		}
 			
 		// Install default exception handlers
@@ -1017,13 +1212,13 @@ void System::InstallDefaultExceptionHandlers() {
 		// if not VBLANK (which has a custom handler)
 		if (handler.address != 0x000068) {
 			uint32_t addr = handler.address - 0x000000; // Convert to ROM-relative address
-			romRegion->data[addr] = (RTE_INSTRUCTION >> 8) & 0xFF;
-			romRegion->data[addr+1] = RTE_INSTRUCTION & 0xFF;
+			romRegion->data[romRegion->ByteIndex(addr)] = (RTE_INSTRUCTION >> 8) & 0xFF;
+			romRegion->data[romRegion->ByteIndex(addr+1)] = RTE_INSTRUCTION & 0xFF;
 		}
 	}
 		
 	// Special case for VBLANK
-	// The hook is installed in ConnectSubsystems()
+	// The interrupt is raised by the VBLANK event in DispatchEvent()
 }
 
 void System::UpdatePowerState(float deltaTime) {
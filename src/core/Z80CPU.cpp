@@ -0,0 +1,1211 @@
+/**
+ * Z80CPU.cpp
+ * Implementation of the Zilog Z80 CPU emulation for NiXX-32 arcade board
+ *
+ * This file holds the execution loop, interrupt handling and the bus and
+ * port helpers shared by the instruction handlers. The sound driver spends
+ * most of every frame in HALT waiting for the next interrupt, so a halted
+ * CPU with nothing pending skips the rest of its timeslice in one step.
+ *
+ * Instructions dispatch through 256-entry handler tables, one per prefix
+ * (main, CB, DD, ED, FD and DDCB/FDCB), built at compile time from handler
+ * templates instantiated per opcode. Flags of 8-bit results come from
+ * precomputed lookup tables rather than being derived bit by bit.
+ */
+
+ #include "Z80CPU.h"
+ #include "MemoryManager.h"
+ #include "NiXX32System.h"
+
+ #include <algorithm>
+ #include <array>
+ #include <cstdio>
+ #include <utility>
+
+ namespace NiXX32 {
+
+ // Value read from ports with no device attached (open bus)
+ constexpr uint8_t OPEN_BUS_PORT = 0xFF;
+
+ // Value read from unmapped memory (open bus)
+ constexpr uint8_t OPEN_BUS_MEMORY = 0xFF;
+
+ // Length of the NOP that HALT repeats while waiting
+ constexpr int HALT_NOP_CYCLES = 4;
+
+ // Interrupt entry points and acknowledge timings
+ constexpr uint16_t NMI_VECTOR = 0x0066;
+ constexpr uint16_t IM1_VECTOR = 0x0038;
+ constexpr int NMI_CYCLES = 11;
+ constexpr int IM0_CYCLES = 13;
+ constexpr int IM1_CYCLES = 13;
+ constexpr int IM2_CYCLES = 19;
+
+ namespace {
+
+ // Register standing in for HL: plain, or IX/IY after a DD/FD prefix
+ enum IndexRegister { INDEX_HL, INDEX_IX, INDEX_IY };
+
+ // 8-bit ALU operations, in opcode order
+ enum AluOp { ALU_ADD, ALU_ADC, ALU_SUB, ALU_SBC, ALU_AND, ALU_XOR, ALU_OR, ALU_CP };
+
+ // CB rotate and shift operations, in opcode order
+ enum ShiftOp { SHIFT_RLC, SHIFT_RRC, SHIFT_RL, SHIFT_RR, SHIFT_SLA, SHIFT_SRA, SHIFT_SLL, SHIFT_SRL };
+
+ // Undocumented flag bits copied from results
+ constexpr uint8_t FLAG_XY = FLAG_X | FLAG_Y;
+
+ /**
+  * Flags of an 8-bit result, so that most flag updates are one load
+  */
+ struct FlagTables {
+	 uint8_t sz[256];       // S, Z, and Y/X copied from the value
+	 uint8_t szp[256];      // sz plus even parity in P/V
+	 uint8_t szBit[256];    // BIT of a masked value: Z and P/V if clear, S for bit 7
+	 uint8_t szhvInc[256];  // INC: sz plus H and V for the incremented value
+	 uint8_t szhvDec[256];  // DEC: sz plus N, H and V for the decremented value
+ };
+
+ constexpr FlagTables MakeFlagTables() {
+	 FlagTables tables{};
+	 for (int value = 0; value < 256; value++) {
+		 int bits = 0;
+		 for (int bit = 0; bit < 8; bit++) {
+			 bits += (value >> bit) & 1;
+		 }
+		 uint8_t sz = static_cast<uint8_t>((value == 0 ? FLAG_Z : 0) | (value & (FLAG_S | FLAG_XY)));
+		 tables.sz[value] = sz;
+		 tables.szp[value] = static_cast<uint8_t>(sz | ((bits & 1) ? 0 : FLAG_P));
+		 tables.szBit[value] = static_cast<uint8_t>(value ? (value & FLAG_S) : (FLAG_Z | FLAG_P));
+		 tables.szhvInc[value] = static_cast<uint8_t>(sz | (value == 0x80 ? FLAG_P : 0) |
+													  ((value & 0x0F) == 0x00 ? FLAG_H : 0));
+		 tables.szhvDec[value] = static_cast<uint8_t>(sz | FLAG_N | (value == 0x7F ? FLAG_P : 0) |
+													  ((value & 0x0F) == 0x0F ? FLAG_H : 0));
+	 }
+	 return tables;
+ }
+
+ constexpr FlagTables FLAGS = MakeFlagTables();
+
+ } // namespace
+
+ /**
+  * Instruction handlers
+  *
+  * Every handler is a template instantiated for one opcode, so the
+  * register and operation decoding happens at compile time. The main
+  * table is instantiated three times: as is, and with HL replaced by IX
+  * and IY for the DD and FD prefixes. Handlers add their own cycles.
+  */
+ struct Z80Ops {
+	 using Handler = void (*)(Z80CPU& cpu);
+	 using IndexedHandler = void (*)(Z80CPU& cpu, uint16_t address);
+	 using HandlerTable = std::array<Handler, 256>;
+	 using IndexedHandlerTable = std::array<IndexedHandler, 256>;
+
+	 // ----- Registers and operands -----
+
+	 template <int Index> static uint16_t& HL(Z80CPU& cpu) {
+		 if constexpr (Index == INDEX_IX) {
+			 return cpu.m_registers.ix;
+		 } else if constexpr (Index == INDEX_IY) {
+			 return cpu.m_registers.iy;
+		 } else {
+			 return cpu.m_registers.hl;
+		 }
+	 }
+
+	 // 8-bit register by opcode field (B, C, D, E, H, L, -, A); H and L
+	 // become the halves of IX/IY under a prefix
+	 template <int Index, int R> static uint8_t& Reg8(Z80CPU& cpu) {
+		 static_assert(R != 6, "field 6 is the memory operand");
+		 Z80Registers& r = cpu.m_registers;
+		 if constexpr (R == 0) {
+			 return r.b;
+		 } else if constexpr (R == 1) {
+			 return r.c;
+		 } else if constexpr (R == 2) {
+			 return r.d;
+		 } else if constexpr (R == 3) {
+			 return r.e;
+		 } else if constexpr (R == 4) {
+			 return Index == INDEX_IX ? r.ixh : Index == INDEX_IY ? r.iyh : r.h;
+		 } else if constexpr (R == 5) {
+			 return Index == INDEX_IX ? r.ixl : Index == INDEX_IY ? r.iyl : r.l;
+		 } else {
+			 return r.a;
+		 }
+	 }
+
+	 // 16-bit register pair by opcode field (BC, DE, HL, SP, or AF if WithAF)
+	 template <int Index, int P, bool WithAF = false> static uint16_t& Reg16(Z80CPU& cpu) {
+		 Z80Registers& r = cpu.m_registers;
+		 if constexpr (P == 0) {
+			 return r.bc;
+		 } else if constexpr (P == 1) {
+			 return r.de;
+		 } else if constexpr (P == 2) {
+			 return HL<Index>(cpu);
+		 } else if constexpr (WithAF) {
+			 return r.af;
+		 } else {
+			 return r.sp;
+		 }
+	 }
+
+	 // Address of the memory operand: (HL), or (IX+d)/(IY+d) with the
+	 // displacement fetched and its 8 cycles charged
+	 template <int Index> static uint16_t MemoryAddress(Z80CPU& cpu) {
+		 if constexpr (Index == INDEX_HL) {
+			 return cpu.m_registers.hl;
+		 } else {
+			 int8_t displacement = static_cast<int8_t>(cpu.FetchByte());
+			 cpu.m_pendingCycles += 8;
+			 return static_cast<uint16_t>(HL<Index>(cpu) + displacement);
+		 }
+	 }
+
+	 // NZ, Z, NC, C, PO, PE, P, M
+	 template <int Condition> static bool TestCondition(const Z80CPU& cpu) {
+		 constexpr uint8_t flag = (Condition >> 1) == 0 ? FLAG_Z : (Condition >> 1) == 1 ? FLAG_C :
+								  (Condition >> 1) == 2 ? FLAG_P : FLAG_S;
+		 return ((cpu.m_registers.f & flag) != 0) == ((Condition & 1) != 0);
+	 }
+
+	 static void RelativeJump(Z80CPU& cpu, uint8_t displacement) {
+		 cpu.m_registers.pc = static_cast<uint16_t>(cpu.m_registers.pc + static_cast<int8_t>(displacement));
+	 }
+
+	 // ----- Arithmetic and logic -----
+
+	 template <int Op> static void Alu(Z80CPU& cpu, uint8_t value) {
+		 Z80Registers& r = cpu.m_registers;
+		 int carry = (Op == ALU_ADC || Op == ALU_SBC) ? (r.f & FLAG_C) : 0;
+		 if constexpr (Op == ALU_ADD || Op == ALU_ADC) {
+			 int result = r.a + value + carry;
+			 r.f = static_cast<uint8_t>(FLAGS.sz[result & 0xFF] | ((result >> 8) & FLAG_C) |
+										((r.a ^ result ^ value) & FLAG_H) |
+										(((value ^ r.a ^ 0x80) & (value ^ result) & 0x80) >> 5));
+			 r.a = static_cast<uint8_t>(result);
+		 } else if constexpr (Op == ALU_SUB || Op == ALU_SBC || Op == ALU_CP) {
+			 int result = r.a - value - carry;
+			 uint8_t flags = static_cast<uint8_t>(FLAG_N | ((result >> 8) & FLAG_C) |
+												  ((r.a ^ result ^ value) & FLAG_H) |
+												  (((value ^ r.a) & (r.a ^ result) & 0x80) >> 5));
+			 if constexpr (Op == ALU_CP) {
+				 // CP copies Y and X from the operand, not the result
+				 r.f = static_cast<uint8_t>(flags | (FLAGS.sz[result & 0xFF] & ~FLAG_XY) | (value & FLAG_XY));
+			 } else {
+				 r.f = static_cast<uint8_t>(flags | FLAGS.sz[result & 0xFF]);
+				 r.a = static_cast<uint8_t>(result);
+			 }
+		 } else if constexpr (Op == ALU_AND) {
+			 r.a &= value;
+			 r.f = FLAGS.szp[r.a] | FLAG_H;
+		 } else if constexpr (Op == ALU_XOR) {
+			 r.a ^= value;
+			 r.f = FLAGS.szp[r.a];
+		 } else {
+			 r.a |= value;
+			 r.f = FLAGS.szp[r.a];
+		 }
+	 }
+
+	 static uint8_t Inc(Z80CPU& cpu, uint8_t value) {
+		 value++;
+		 cpu.m_registers.f = static_cast<uint8_t>((cpu.m_registers.f & FLAG_C) | FLAGS.szhvInc[value]);
+		 return value;
+	 }
+
+	 static uint8_t Dec(Z80CPU& cpu, uint8_t value) {
+		 value--;
+		 cpu.m_registers.f = static_cast<uint8_t>((cpu.m_registers.f & FLAG_C) | FLAGS.szhvDec[value]);
+		 return value;
+	 }
+
+	 static void Add16(Z80CPU& cpu, uint16_t& destination, uint16_t value) {
+		 uint32_t result = destination + value;
+		 uint8_t& f = cpu.m_registers.f;
+		 f = static_cast<uint8_t>((f & (FLAG_S | FLAG_Z | FLAG_P)) | (((destination ^ result ^ value) >> 8) & FLAG_H) |
+								  ((result >> 16) & FLAG_C) | ((result >> 8) & FLAG_XY));
+		 destination = static_cast<uint16_t>(result);
+	 }
+
+	 template <bool Subtract> static void AddWithCarry16(Z80CPU& cpu, uint16_t value) {
+		 uint16_t& hl = cpu.m_registers.hl;
+		 uint8_t& f = cpu.m_registers.f;
+		 int carry = f & FLAG_C;
+		 int result = Subtract ? hl - value - carry : hl + value + carry;
+		 int overflow = Subtract ? ((value ^ hl) & (hl ^ result) & 0x8000) : ((value ^ hl ^ 0x8000) & (value ^ result) & 0x8000);
+		 f = static_cast<uint8_t>((((hl ^ result ^ value) >> 8) & FLAG_H) | ((result >> 16) & FLAG_C) |
+								  ((result >> 8) & (FLAG_S | FLAG_XY)) | ((result & 0xFFFF) ? 0 : FLAG_Z) |
+								  (overflow >> 13) | (Subtract ? FLAG_N : 0));
+		 hl = static_cast<uint16_t>(result);
+	 }
+
+	 template <int Op> static uint8_t Shift(Z80CPU& cpu, uint8_t value) {
+		 uint8_t& f = cpu.m_registers.f;
+		 uint8_t carry = (Op == SHIFT_RLC || Op == SHIFT_RL || Op == SHIFT_SLA || Op == SHIFT_SLL) ? (value >> 7) : (value & 1);
+		 uint8_t result;
+		 if constexpr (Op == SHIFT_RLC) {
+			 result = static_cast<uint8_t>((value << 1) | carry);
+		 } else if constexpr (Op == SHIFT_RRC) {
+			 result = static_cast<uint8_t>((value >> 1) | (carry << 7));
+		 } else if constexpr (Op == SHIFT_RL) {
+			 result = static_cast<uint8_t>((value << 1) | (f & FLAG_C));
+		 } else if constexpr (Op == SHIFT_RR) {
+			 result = static_cast<uint8_t>((value >> 1) | ((f & FLAG_C) << 7));
+		 } else if constexpr (Op == SHIFT_SLA) {
+			 result = static_cast<uint8_t>(value << 1);
+		 } else if constexpr (Op == SHIFT_SRA) {
+			 result = static_cast<uint8_t>((value >> 1) | (value & 0x80));
+		 } else if constexpr (Op == SHIFT_SLL) {
+			 result = static_cast<uint8_t>((value << 1) | 1);
+		 } else {
+			 result = static_cast<uint8_t>(value >> 1);
+		 }
+		 f = static_cast<uint8_t>(FLAGS.szp[result] | carry);
+		 return result;
+	 }
+
+	 // Y and X come from the value for registers and from the address
+	 // (the internal MEMPTR) for memory operands
+	 template <int Bit> static void TestBit(Z80CPU& cpu, uint8_t value, uint8_t xy) {
+		 uint8_t& f = cpu.m_registers.f;
+		 f = static_cast<uint8_t>((f & FLAG_C) | FLAG_H | (FLAGS.szBit[value & (1 << Bit)] & ~FLAG_XY) | (xy & FLAG_XY));
+	 }
+
+	 // RLCA, RRCA, RLA, RRA, DAA, CPL, SCF, CCF
+	 template <int Op> static void Accumulator(Z80CPU& cpu) {
+		 Z80Registers& r = cpu.m_registers;
+		 constexpr uint8_t keep = FLAG_S | FLAG_Z | FLAG_P;
+		 if constexpr (Op == 0) {
+			 r.a = static_cast<uint8_t>((r.a << 1) | (r.a >> 7));
+			 r.f = static_cast<uint8_t>((r.f & keep) | (r.a & (FLAG_XY | FLAG_C)));
+		 } else if constexpr (Op == 1) {
+			 uint8_t carry = r.a & FLAG_C;
+			 r.a = static_cast<uint8_t>((r.a >> 1) | (r.a << 7));
+			 r.f = static_cast<uint8_t>((r.f & keep) | carry | (r.a & FLAG_XY));
+		 } else if constexpr (Op == 2) {
+			 uint8_t carry = r.a >> 7;
+			 r.a = static_cast<uint8_t>((r.a << 1) | (r.f & FLAG_C));
+			 r.f = static_cast<uint8_t>((r.f & keep) | carry | (r.a & FLAG_XY));
+		 } else if constexpr (Op == 3) {
+			 uint8_t carry = r.a & FLAG_C;
+			 r.a = static_cast<uint8_t>((r.a >> 1) | (r.f << 7));
+			 r.f = static_cast<uint8_t>((r.f & keep) | carry | (r.a & FLAG_XY));
+		 } else if constexpr (Op == 4) {
+			 uint8_t result = r.a;
+			 uint8_t adjust = (r.a > 0x99 || (r.f & FLAG_C)) ? 0x60 : 0x00;
+			 if ((r.a & 0x0F) > 9 || (r.f & FLAG_H)) {
+				 adjust |= 0x06;
+			 }
+			 result = (r.f & FLAG_N) ? result - adjust : result + adjust;
+			 r.f = static_cast<uint8_t>((r.f & (FLAG_C | FLAG_N)) | (r.a > 0x99 ? FLAG_C : 0) |
+										((r.a ^ result) & FLAG_H) | FLAGS.szp[result]);
+			 r.a = result;
+		 } else if constexpr (Op == 5) {
+			 r.a = static_cast<uint8_t>(~r.a);
+			 r.f = static_cast<uint8_t>((r.f & (keep | FLAG_C)) | FLAG_H | FLAG_N | (r.a & FLAG_XY));
+		 } else if constexpr (Op == 6) {
+			 r.f = static_cast<uint8_t>((r.f & keep) | FLAG_C | (r.a & FLAG_XY));
+		 } else {
+			 r.f = static_cast<uint8_t>(((r.f & (keep | FLAG_C)) | ((r.f & FLAG_C) << 4) | (r.a & FLAG_XY)) ^ FLAG_C);
+		 }
+	 }
+
+	 // ----- Handlers: unprefixed, DD and FD -----
+
+	 template <int Index, int Opcode> static void Main(Z80CPU& cpu) {
+		 constexpr int x = Opcode >> 6;
+		 constexpr int y = (Opcode >> 3) & 7;
+		 constexpr int z = Opcode & 7;
+		 constexpr int p = y >> 1;
+		 constexpr int q = y & 1;
+		 int& cycles = cpu.m_pendingCycles;
+
+		 if constexpr (x == 1 && y == 6 && z == 6) {
+			 // HALT: the CPU runs internal NOPs until an interrupt
+			 cpu.m_state = Z80State::HALTED;
+			 cycles += 4;
+		 } else if constexpr (x == 1 && y == 6) {
+			 // LD (HL),r keeps the real H and L under a prefix
+			 uint16_t address = MemoryAddress<Index>(cpu);
+			 cpu.WriteByte(address, Reg8<INDEX_HL, z>(cpu));
+			 cycles += 7;
+		 } else if constexpr (x == 1 && z == 6) {
+			 Reg8<INDEX_HL, y>(cpu) = cpu.ReadByte(MemoryAddress<Index>(cpu));
+			 cycles += 7;
+		 } else if constexpr (x == 1) {
+			 Reg8<Index, y>(cpu) = Reg8<Index, z>(cpu);
+			 cycles += 4;
+		 } else if constexpr (x == 2 && z == 6) {
+			 Alu<y>(cpu, cpu.ReadByte(MemoryAddress<Index>(cpu)));
+			 cycles += 7;
+		 } else if constexpr (x == 2) {
+			 Alu<y>(cpu, Reg8<Index, z>(cpu));
+			 cycles += 4;
+		 } else if constexpr (x == 0) {
+			 Group0<Index, y, z, p, q>(cpu);
+		 } else {
+			 Group3<Index, y, z, p, q>(cpu);
+		 }
+	 }
+
+	 template <int Index, int y, int z, int p, int q> static void Group0(Z80CPU& cpu) {
+		 Z80Registers& r = cpu.m_registers;
+		 int& cycles = cpu.m_pendingCycles;
+
+		 if constexpr (z == 0 && y == 0) {
+			 cycles += 4;  // NOP
+		 } else if constexpr (z == 0 && y == 1) {
+			 std::swap(r.af, r.af_);
+			 cycles += 4;
+		 } else if constexpr (z == 0 && y == 2) {
+			 // DJNZ
+			 uint8_t displacement = cpu.FetchByte();
+			 if (--r.b != 0) {
+				 RelativeJump(cpu, displacement);
+				 cycles += 13;
+			 } else {
+				 cycles += 8;
+			 }
+		 } else if constexpr (z == 0 && y == 3) {
+			 RelativeJump(cpu, cpu.FetchByte());
+			 cycles += 12;
+		 } else if constexpr (z == 0) {
+			 // JR cc (NZ, Z, NC, C only)
+			 uint8_t displacement = cpu.FetchByte();
+			 if (TestCondition<y - 4>(cpu)) {
+				 RelativeJump(cpu, displacement);
+				 cycles += 12;
+			 } else {
+				 cycles += 7;
+			 }
+		 } else if constexpr (z == 1 && q == 0) {
+			 Reg16<Index, p>(cpu) = cpu.FetchWord();
+			 cycles += 10;
+		 } else if constexpr (z == 1) {
+			 Add16(cpu, HL<Index>(cpu), Reg16<Index, p>(cpu));
+			 cycles += 11;
+		 } else if constexpr (z == 2 && p < 2) {
+			 // LD (BC),A / LD (DE),A / LD A,(BC) / LD A,(DE)
+			 uint16_t address = p == 0 ? r.bc : r.de;
+			 if constexpr (q == 0) {
+				 cpu.WriteByte(address, r.a);
+			 } else {
+				 r.a = cpu.ReadByte(address);
+			 }
+			 cycles += 7;
+		 } else if constexpr (z == 2 && p == 2) {
+			 uint16_t address = cpu.FetchWord();
+			 if constexpr (q == 0) {
+				 cpu.WriteWord(address, HL<Index>(cpu));
+			 } else {
+				 HL<Index>(cpu) = cpu.ReadWord(address);
+			 }
+			 cycles += 16;
+		 } else if constexpr (z == 2) {
+			 uint16_t address = cpu.FetchWord();
+			 if constexpr (q == 0) {
+				 cpu.WriteByte(address, r.a);
+			 } else {
+				 r.a = cpu.ReadByte(address);
+			 }
+			 cycles += 13;
+		 } else if constexpr (z == 3) {
+			 uint16_t& pair = Reg16<Index, p>(cpu);
+			 pair = static_cast<uint16_t>(q == 0 ? pair + 1 : pair - 1);
+			 cycles += 6;
+		 } else if constexpr ((z == 4 || z == 5) && y == 6) {
+			 uint16_t address = MemoryAddress<Index>(cpu);
+			 uint8_t value = cpu.ReadByte(address);
+			 cpu.WriteByte(address, z == 4 ? Inc(cpu, value) : Dec(cpu, value));
+			 cycles += 11;
+		 } else if constexpr (z == 4 || z == 5) {
+			 uint8_t& reg = Reg8<Index, y>(cpu);
+			 reg = z == 4 ? Inc(cpu, reg) : Dec(cpu, reg);
+			 cycles += 4;
+		 } else if constexpr (z == 6 && y == 6) {
+			 // The immediate is read while (IX+d) is being computed
+			 uint16_t address = MemoryAddress<Index>(cpu);
+			 cpu.WriteByte(address, cpu.FetchByte());
+			 cycles += Index == INDEX_HL ? 10 : 7;
+		 } else if constexpr (z == 6) {
+			 Reg8<Index, y>(cpu) = cpu.FetchByte();
+			 cycles += 7;
+		 } else {
+			 Accumulator<y>(cpu);
+			 cycles += 4;
+		 }
+	 }
+
+	 template <int Index, int y, int z, int p, int q> static void Group3(Z80CPU& cpu) {
+		 Z80Registers& r = cpu.m_registers;
+		 int& cycles = cpu.m_pendingCycles;
+
+		 if constexpr (z == 0) {
+			 // RET cc
+			 if (TestCondition<y>(cpu)) {
+				 r.pc = cpu.Pop();
+				 cycles += 11;
+			 } else {
+				 cycles += 5;
+			 }
+		 } else if constexpr (z == 1 && q == 0) {
+			 Reg16<Index, p, true>(cpu) = cpu.Pop();
+			 cycles += 10;
+		 } else if constexpr (z == 1 && p == 0) {
+			 r.pc = cpu.Pop();
+			 cycles += 10;
+		 } else if constexpr (z == 1 && p == 1) {
+			 // EXX
+			 std::swap(r.bc, r.bc_);
+			 std::swap(r.de, r.de_);
+			 std::swap(r.hl, r.hl_);
+			 cycles += 4;
+		 } else if constexpr (z == 1 && p == 2) {
+			 r.pc = HL<Index>(cpu);
+			 cycles += 4;
+		 } else if constexpr (z == 1) {
+			 r.sp = HL<Index>(cpu);
+			 cycles += 6;
+		 } else if constexpr (z == 2) {
+			 // JP cc,nn
+			 uint16_t address = cpu.FetchWord();
+			 if (TestCondition<y>(cpu)) {
+				 r.pc = address;
+			 }
+			 cycles += 10;
+		 } else if constexpr (z == 3 && y == 0) {
+			 r.pc = cpu.FetchWord();
+			 cycles += 10;
+		 } else if constexpr (z == 3 && y == 1) {
+			 if constexpr (Index == INDEX_HL) {
+				 PrefixCB(cpu);
+			 } else {
+				 PrefixIndexCB<Index>(cpu);
+			 }
+		 } else if constexpr (z == 3 && y == 2) {
+			 cpu.OutPort(cpu.FetchByte(), r.a);
+			 cycles += 11;
+		 } else if constexpr (z == 3 && y == 3) {
+			 r.a = cpu.InPort(cpu.FetchByte());
+			 cycles += 11;
+		 } else if constexpr (z == 3 && y == 4) {
+			 // EX (SP),HL
+			 uint16_t value = cpu.ReadWord(r.sp);
+			 cpu.WriteWord(r.sp, HL<Index>(cpu));
+			 HL<Index>(cpu) = value;
+			 cycles += 19;
+		 } else if constexpr (z == 3 && y == 5) {
+			 // EX DE,HL is never affected by a prefix
+			 std::swap(r.de, r.hl);
+			 cycles += 4;
+		 } else if constexpr (z == 3 && y == 6) {
+			 cpu.m_iff1 = false;
+			 cpu.m_iff2 = false;
+			 cycles += 4;
+		 } else if constexpr (z == 3) {
+			 cpu.m_iff1 = true;
+			 cpu.m_iff2 = true;
+			 cpu.m_afterEI = true;
+			 cycles += 4;
+		 } else if constexpr (z == 4) {
+			 // CALL cc,nn
+			 uint16_t address = cpu.FetchWord();
+			 if (TestCondition<y>(cpu)) {
+				 cpu.Push(r.pc);
+				 r.pc = address;
+				 cycles += 17;
+			 } else {
+				 cycles += 10;
+			 }
+		 } else if constexpr (z == 5 && q == 0) {
+			 cpu.Push(Reg16<Index, p, true>(cpu));
+			 cycles += 11;
+		 } else if constexpr (z == 5 && p == 0) {
+			 uint16_t address = cpu.FetchWord();
+			 cpu.Push(r.pc);
+			 r.pc = address;
+			 cycles += 17;
+		 } else if constexpr (z == 5 && p == 1) {
+			 PrefixIndex<INDEX_IX>(cpu);
+		 } else if constexpr (z == 5 && p == 2) {
+			 PrefixED(cpu);
+		 } else if constexpr (z == 5) {
+			 PrefixIndex<INDEX_IY>(cpu);
+		 } else if constexpr (z == 6) {
+			 Alu<y>(cpu, cpu.FetchByte());
+			 cycles += 7;
+		 } else {
+			 // RST
+			 cpu.Push(r.pc);
+			 r.pc = y * 8;
+			 cycles += 11;
+		 }
+	 }
+
+	 // ----- Handlers: CB, DDCB and FDCB -----
+
+	 template <int Opcode> static void Cb(Z80CPU& cpu) {
+		 constexpr int x = Opcode >> 6;
+		 constexpr int y = (Opcode >> 3) & 7;
+		 constexpr int z = Opcode & 7;
+
+		 if constexpr (z == 6) {
+			 uint16_t address = cpu.m_registers.hl;
+			 uint8_t value = cpu.ReadByte(address);
+			 if constexpr (x == 1) {
+				 TestBit<y>(cpu, value, static_cast<uint8_t>(address >> 8));
+				 cpu.m_pendingCycles += 12;
+			 } else {
+				 cpu.WriteByte(address, BitOperation<x, y>(cpu, value));
+				 cpu.m_pendingCycles += 15;
+			 }
+		 } else {
+			 uint8_t& reg = Reg8<INDEX_HL, z>(cpu);
+			 if constexpr (x == 1) {
+				 TestBit<y>(cpu, reg, reg);
+			 } else {
+				 reg = BitOperation<x, y>(cpu, reg);
+			 }
+			 cpu.m_pendingCycles += 8;
+		 }
+	 }
+
+	 // (IX+d) forms; the undocumented register forms also copy the result.
+	 // The DD/FD prefix has already been charged 4 cycles
+	 template <int Opcode> static void IndexedCb(Z80CPU& cpu, uint16_t address) {
+		 constexpr int x = Opcode >> 6;
+		 constexpr int y = (Opcode >> 3) & 7;
+		 constexpr int z = Opcode & 7;
+
+		 uint8_t value = cpu.ReadByte(address);
+		 if constexpr (x == 1) {
+			 TestBit<y>(cpu, value, static_cast<uint8_t>(address >> 8));
+			 cpu.m_pendingCycles += 16;
+		 } else {
+			 uint8_t result = BitOperation<x, y>(cpu, value);
+			 cpu.WriteByte(address, result);
+			 if constexpr (z != 6) {
+				 Reg8<INDEX_HL, z>(cpu) = result;
+			 }
+			 cpu.m_pendingCycles += 19;
+		 }
+	 }
+
+	 // Rotate/shift, RES or SET (everything in the CB page but BIT)
+	 template <int x, int y> static uint8_t BitOperation(Z80CPU& cpu, uint8_t value) {
+		 if constexpr (x == 0) {
+			 return Shift<y>(cpu, value);
+		 } else if constexpr (x == 2) {
+			 return static_cast<uint8_t>(value & ~(1 << y));
+		 } else {
+			 return static_cast<uint8_t>(value | (1 << y));
+		 }
+	 }
+
+	 // ----- Handlers: ED -----
+
+	 template <int Opcode> static void Ed(Z80CPU& cpu) {
+		 constexpr int x = Opcode >> 6;
+		 constexpr int y = (Opcode >> 3) & 7;
+		 constexpr int z = Opcode & 7;
+		 constexpr int p = y >> 1;
+		 constexpr int q = y & 1;
+		 Z80Registers& r = cpu.m_registers;
+		 int& cycles = cpu.m_pendingCycles;
+
+		 if constexpr (x == 1 && z == 0) {
+			 // IN r,(C); IN (C) only sets the flags
+			 uint8_t value = cpu.InPort(r.c);
+			 r.f = static_cast<uint8_t>((r.f & FLAG_C) | FLAGS.szp[value]);
+			 if constexpr (y != 6) {
+				 Reg8<INDEX_HL, y>(cpu) = value;
+			 }
+			 cycles += 12;
+		 } else if constexpr (x == 1 && z == 1) {
+			 // OUT (C),r; OUT (C),0 for field 6
+			 if constexpr (y != 6) {
+				 cpu.OutPort(r.c, Reg8<INDEX_HL, y>(cpu));
+			 } else {
+				 cpu.OutPort(r.c, 0);
+			 }
+			 cycles += 12;
+		 } else if constexpr (x == 1 && z == 2) {
+			 AddWithCarry16<q == 0>(cpu, Reg16<INDEX_HL, p>(cpu));
+			 cycles += 15;
+		 } else if constexpr (x == 1 && z == 3) {
+			 uint16_t address = cpu.FetchWord();
+			 if constexpr (q == 0) {
+				 cpu.WriteWord(address, Reg16<INDEX_HL, p>(cpu));
+			 } else {
+				 Reg16<INDEX_HL, p>(cpu) = cpu.ReadWord(address);
+			 }
+			 cycles += 20;
+		 } else if constexpr (x == 1 && z == 4) {
+			 // NEG
+			 uint8_t value = r.a;
+			 r.a = 0;
+			 Alu<ALU_SUB>(cpu, value);
+			 cycles += 8;
+		 } else if constexpr (x == 1 && z == 5) {
+			 // RETN and RETI both restore IFF1 from IFF2
+			 cpu.m_iff1 = cpu.m_iff2;
+			 r.pc = cpu.Pop();
+			 cycles += 14;
+		 } else if constexpr (x == 1 && z == 6) {
+			 constexpr int mode = y & 3;
+			 cpu.m_interruptMode = mode == 3 ? InterruptMode::IM2 : mode == 2 ? InterruptMode::IM1 : InterruptMode::IM0;
+			 cycles += 8;
+		 } else if constexpr (x == 1 && z == 7 && y < 4) {
+			 // LD I,A / LD R,A / LD A,I / LD A,R
+			 if constexpr (y == 0) {
+				 r.i = r.a;
+			 } else if constexpr (y == 1) {
+				 r.r = r.a;
+			 } else {
+				 r.a = y == 2 ? r.i : r.r;
+				 r.f = static_cast<uint8_t>((r.f & FLAG_C) | FLAGS.sz[r.a] | (cpu.m_iff2 ? FLAG_P : 0));
+			 }
+			 cycles += 9;
+		 } else if constexpr (x == 1 && z == 7 && y < 6) {
+			 // RRD / RLD
+			 uint8_t value = cpu.ReadByte(r.hl);
+			 if constexpr (y == 4) {
+				 cpu.WriteByte(r.hl, static_cast<uint8_t>((r.a << 4) | (value >> 4)));
+				 r.a = static_cast<uint8_t>((r.a & 0xF0) | (value & 0x0F));
+			 } else {
+				 cpu.WriteByte(r.hl, static_cast<uint8_t>((value << 4) | (r.a & 0x0F)));
+				 r.a = static_cast<uint8_t>((r.a & 0xF0) | (value >> 4));
+			 }
+			 r.f = static_cast<uint8_t>((r.f & FLAG_C) | FLAGS.szp[r.a]);
+			 cycles += 18;
+		 } else if constexpr (x == 2 && y >= 4 && z <= 3) {
+			 Block<y, z>(cpu);
+		 } else {
+			 // Undefined ED opcodes act as two NOPs
+			 cycles += 8;
+		 }
+	 }
+
+	 // LDI/CPI/INI/OUTI and their decrementing and repeating forms
+	 template <int y, int z> static void Block(Z80CPU& cpu) {
+		 constexpr int step = (y & 1) ? -1 : 1;
+		 constexpr bool repeat = y >= 6;
+		 Z80Registers& r = cpu.m_registers;
+		 bool again;
+
+		 if constexpr (z == 0) {
+			 uint8_t value = cpu.ReadByte(r.hl);
+			 cpu.WriteByte(r.de, value);
+			 r.hl = static_cast<uint16_t>(r.hl + step);
+			 r.de = static_cast<uint16_t>(r.de + step);
+			 r.bc--;
+			 uint8_t n = static_cast<uint8_t>(r.a + value);
+			 r.f = static_cast<uint8_t>((r.f & (FLAG_S | FLAG_Z | FLAG_C)) | (n & FLAG_X) | ((n << 4) & FLAG_Y) |
+										(r.bc ? FLAG_P : 0));
+			 again = r.bc != 0;
+		 } else if constexpr (z == 1) {
+			 uint8_t value = cpu.ReadByte(r.hl);
+			 uint8_t result = static_cast<uint8_t>(r.a - value);
+			 r.hl = static_cast<uint16_t>(r.hl + step);
+			 r.bc--;
+			 r.f = static_cast<uint8_t>((r.f & FLAG_C) | (FLAGS.sz[result] & ~FLAG_XY) | ((r.a ^ value ^ result) & FLAG_H) | FLAG_N);
+			 if (r.f & FLAG_H) {
+				 result--;
+			 }
+			 r.f |= static_cast<uint8_t>((result & FLAG_X) | ((result << 4) & FLAG_Y) | (r.bc ? FLAG_P : 0));
+			 again = r.bc != 0 && !(r.f & FLAG_Z);
+		 } else {
+			 uint8_t value;
+			 unsigned sum;
+			 if constexpr (z == 2) {
+				 value = cpu.InPort(r.c);
+				 cpu.WriteByte(r.hl, value);
+				 r.b--;
+				 sum = ((r.c + step) & 0xFF) + value;
+			 } else {
+				 value = cpu.ReadByte(r.hl);
+				 r.b--;
+				 cpu.OutPort(r.c, value);
+				 sum = static_cast<uint8_t>(r.l + step) + value;
+			 }
+			 r.hl = static_cast<uint16_t>(r.hl + step);
+			 r.f = static_cast<uint8_t>(FLAGS.sz[r.b] | ((value & 0x80) ? FLAG_N : 0) | ((sum & 0x100) ? (FLAG_H | FLAG_C) : 0) |
+										(FLAGS.szp[(sum & 7) ^ r.b] & FLAG_P));
+			 again = r.b != 0;
+		 }
+
+		 cpu.m_pendingCycles += 16;
+		 if (repeat && again) {
+			 // Repeat by running the instruction again
+			 r.pc -= 2;
+			 cpu.m_pendingCycles += 5;
+		 }
+	 }
+
+	 // ----- Prefixes -----
+
+	 static void PrefixCB(Z80CPU& cpu);
+	 static void PrefixED(Z80CPU& cpu);
+	 template <int Index> static void PrefixIndex(Z80CPU& cpu);
+	 template <int Index> static void PrefixIndexCB(Z80CPU& cpu);
+
+	 // ----- Table construction -----
+
+	 template <int Index, size_t... Opcodes> static constexpr HandlerTable MainTable(std::index_sequence<Opcodes...>) {
+		 return {{ &Main<Index, Opcodes>... }};
+	 }
+
+	 template <size_t... Opcodes> static constexpr HandlerTable CbTable(std::index_sequence<Opcodes...>) {
+		 return {{ &Cb<Opcodes>... }};
+	 }
+
+	 template <size_t... Opcodes> static constexpr HandlerTable EdTable(std::index_sequence<Opcodes...>) {
+		 return {{ &Ed<Opcodes>... }};
+	 }
+
+	 template <size_t... Opcodes> static constexpr IndexedHandlerTable IndexedCbTable(std::index_sequence<Opcodes...>) {
+		 return {{ &IndexedCb<Opcodes>... }};
+	 }
+ };
+
+ namespace {
+
+ // Handler tables, one per prefix
+ constexpr auto OPCODES = std::make_index_sequence<256>();
+ constexpr Z80Ops::HandlerTable MAIN_HANDLERS = Z80Ops::MainTable<INDEX_HL>(OPCODES);
+ constexpr Z80Ops::HandlerTable CB_HANDLERS = Z80Ops::CbTable(OPCODES);
+ constexpr Z80Ops::HandlerTable DD_HANDLERS = Z80Ops::MainTable<INDEX_IX>(OPCODES);
+ constexpr Z80Ops::HandlerTable ED_HANDLERS = Z80Ops::EdTable(OPCODES);
+ constexpr Z80Ops::HandlerTable FD_HANDLERS = Z80Ops::MainTable<INDEX_IY>(OPCODES);
+ constexpr Z80Ops::IndexedHandlerTable INDEXED_CB_HANDLERS = Z80Ops::IndexedCbTable(OPCODES);
+
+ } // namespace
+
+ void Z80Ops::PrefixCB(Z80CPU& cpu) {
+	 CB_HANDLERS[cpu.FetchOpcode()](cpu);
+ }
+
+ void Z80Ops::PrefixED(Z80CPU& cpu) {
+	 ED_HANDLERS[cpu.FetchOpcode()](cpu);
+ }
+
+ // DD and FD cost 4 cycles and otherwise run the main opcode with HL replaced
+ template <int Index> void Z80Ops::PrefixIndex(Z80CPU& cpu) {
+	 cpu.m_pendingCycles += 4;
+	 const HandlerTable& handlers = Index == INDEX_IX ? DD_HANDLERS : FD_HANDLERS;
+	 handlers[cpu.FetchOpcode()](cpu);
+ }
+
+ // DD CB d op and FD CB d op: the displacement and opcode are plain reads
+ template <int Index> void Z80Ops::PrefixIndexCB(Z80CPU& cpu) {
+	 int8_t displacement = static_cast<int8_t>(cpu.FetchByte());
+	 uint16_t address = static_cast<uint16_t>(HL<Index>(cpu) + displacement);
+	 INDEXED_CB_HANDLERS[cpu.FetchByte()](cpu, address);
+ }
+
+ /**
+  * Z80 CPU
+  */
+ Z80CPU::Z80CPU(System& system, MemoryManager& memoryManager, Logger& logger, AudioSystem& audioSystem)
+	 : m_system(system),
+	   m_memoryManager(memoryManager),
+	   m_logger(logger),
+	   m_audioSystem(audioSystem),
+	   m_registers{},
+	   m_state(Z80State::RESET),
+	   m_resetHeld(false),
+	   m_interruptMode(InterruptMode::IM0),
+	   m_iff1(false),
+	   m_iff2(false),
+	   m_afterEI(false),
+	   m_pendingInterrupt(Z80InterruptType::NONE),
+	   m_interruptData(0),
+	   m_clockSpeed(0),
+	   m_cycleCount(0),
+	   m_pendingCycles(0),
+	   m_pages{},
+	   m_portHandlers{},
+	   m_executionHookBitmap{},
+	   m_hasExecutionHooks(false) {
+	 UnmapMemory(0x0000, 0x10000);
+	 for (unsigned port = 0; port < PORT_COUNT; port++) {
+		 RemovePortHandler(static_cast<uint8_t>(port));
+	 }
+ }
+
+ Z80CPU::~Z80CPU() {
+ }
+
+ bool Z80CPU::Initialize(uint32_t clockSpeed) {
+	 m_clockSpeed = clockSpeed;
+	 Reset();
+
+	 m_logger.Info("Z80CPU", "Z80 initialized at " + std::to_string(clockSpeed) + " Hz");
+	 return true;
+ }
+
+ void Z80CPU::Reset() {
+	 // Reset clears PC, I, R, the interrupt flip-flops and the mode;
+	 // AF and SP come up all ones on real parts
+	 m_registers = Z80Registers{};
+	 m_registers.af = 0xFFFF;
+	 m_registers.sp = 0xFFFF;
+
+	 m_state = m_resetHeld ? Z80State::RESET : Z80State::RUNNING;
+	 m_interruptMode = InterruptMode::IM0;
+	 m_iff1 = false;
+	 m_iff2 = false;
+	 m_afterEI = false;
+	 m_pendingInterrupt = Z80InterruptType::NONE;
+	 m_interruptData = 0;
+	 m_cycleCount = 0;
+	 m_pendingCycles = 0;
+ }
+
+ void Z80CPU::SetResetLine(bool held) {
+	 m_resetHeld = held;
+	 Reset();
+ }
+
+ int Z80CPU::Execute(int cycles) {
+	 // Held in reset: nothing runs, but the time still passes
+	 if (m_state == Z80State::RESET) {
+		 int idle = std::max(cycles, 0);
+		 m_cycleCount += idle;
+		 return idle;
+	 }
+
+	 int executed = 0;
+
+	 while (executed < cycles) {
+		 CheckPendingInterrupts();
+
+		 if (m_state == Z80State::HALTED) {
+			 // Only an interrupt ends HALT, and none can arrive before
+			 // this timeslice ends
+			 executed += SkipHaltedCycles(cycles - executed);
+			 break;
+		 }
+
+		 uint16_t pc = m_registers.pc;
+		 if (m_hasExecutionHooks && ((m_executionHookBitmap[pc >> 6] >> (pc & 63)) & 1)) {
+			 m_executionHooks[pc]();
+		 }
+
+		 executed += ExecuteInstruction();
+	 }
+
+	 return executed;
+ }
+
+ int Z80CPU::ExecuteInstruction() {
+	 m_afterEI = false;
+	 MAIN_HANDLERS[FetchOpcode()](*this);
+
+	 int executed = m_pendingCycles;
+	 m_pendingCycles = 0;
+	 m_cycleCount += executed;
+	 return executed;
+ }
+
+ bool Z80CPU::TriggerInterrupt(Z80InterruptType type, uint8_t data) {
+	 if (type == Z80InterruptType::NONE || m_state == Z80State::RESET) {
+		 return false;
+	 }
+
+	 // NMI wins over a maskable request still waiting to be taken
+	 if (type == Z80InterruptType::INT && m_pendingInterrupt == Z80InterruptType::NMI) {
+		 return false;
+	 }
+
+	 m_pendingInterrupt = type;
+	 m_interruptData = data;
+	 return true;
+ }
+
+ bool Z80CPU::IsWaitingForInterrupt() const {
+	 if (m_state != Z80State::HALTED) {
+		 return false;
+	 }
+	 return m_pendingInterrupt == Z80InterruptType::NONE ||
+			(m_pendingInterrupt == Z80InterruptType::INT && !m_iff1);
+ }
+
+ int Z80CPU::SkipHaltedCycles(int cycles) {
+	 int nops = (cycles > 0) ? (cycles + HALT_NOP_CYCLES - 1) / HALT_NOP_CYCLES : 0;
+
+	 // Each NOP is an opcode fetch, so R keeps counting (bit 7 is never touched)
+	 m_registers.r = static_cast<uint8_t>((m_registers.r & 0x80) | ((m_registers.r + nops) & 0x7F));
+
+	 int idle = nops * HALT_NOP_CYCLES + m_pendingCycles;
+	 m_pendingCycles = 0;
+	 m_cycleCount += idle;
+	 return idle;
+ }
+
+ bool Z80CPU::CheckPendingInterrupts() {
+	 if (m_pendingInterrupt == Z80InterruptType::NMI) {
+		 m_pendingInterrupt = Z80InterruptType::NONE;
+		 HandleNMI();
+		 return true;
+	 }
+
+	 // The instruction after EI always runs before INT is taken
+	 if (m_pendingInterrupt == Z80InterruptType::INT && m_iff1 && !m_afterEI) {
+		 m_pendingInterrupt = Z80InterruptType::NONE;
+		 HandleInterrupt();
+		 return true;
+	 }
+
+	 return false;
+ }
+
+ void Z80CPU::HandleNMI() {
+	 m_state = Z80State::INTERRUPT;
+	 m_registers.r = static_cast<uint8_t>((m_registers.r & 0x80) | ((m_registers.r + 1) & 0x7F));
+
+	 // IFF2 remembers whether maskable interrupts were on, for RETN
+	 m_iff2 = m_iff1;
+	 m_iff1 = false;
+
+	 Push(m_registers.pc);
+	 m_registers.pc = NMI_VECTOR;
+	 m_pendingCycles += NMI_CYCLES;
+	 m_state = Z80State::RUNNING;
+ }
+
+ void Z80CPU::HandleInterrupt() {
+	 m_state = Z80State::INTERRUPT;
+	 m_registers.r = static_cast<uint8_t>((m_registers.r & 0x80) | ((m_registers.r + 1) & 0x7F));
+
+	 m_iff1 = false;
+	 m_iff2 = false;
+
+	 Push(m_registers.pc);
+	 switch (m_interruptMode) {
+		 case InterruptMode::IM0:
+			 // The device puts an instruction on the bus; in practice an RST
+			 m_registers.pc = ((m_interruptData & 0xC7) == 0xC7) ? (m_interruptData & 0x38) : IM1_VECTOR;
+			 m_pendingCycles += IM0_CYCLES;
+			 break;
+		 case InterruptMode::IM1:
+			 m_registers.pc = IM1_VECTOR;
+			 m_pendingCycles += IM1_CYCLES;
+			 break;
+		 case InterruptMode::IM2:
+			 m_registers.pc = ReadWord(static_cast<uint16_t>((m_registers.i << 8) | (m_interruptData & 0xFE)));
+			 m_pendingCycles += IM2_CYCLES;
+			 break;
+	 }
+
+	 m_state = Z80State::RUNNING;
+ }
+
+ Z80State Z80CPU::GetState() const {
+	 return m_state;
+ }
+
+ InterruptMode Z80CPU::GetInterruptMode() const {
+	 return m_interruptMode;
+ }
+
+ bool Z80CPU::AreInterruptsEnabled() const {
+	 return m_iff1;
+ }
+
+ uint16_t Z80CPU::GetPC() const {
+	 return m_registers.pc;
+ }
+
+ void Z80CPU::SetPC(uint16_t newPC) {
+	 m_registers.pc = newPC;
+ }
+
+ Z80Registers Z80CPU::GetRegisters() const {
+	 return m_registers;
+ }
+
+ void Z80CPU::SetRegisters(const Z80Registers& registers) {
+	 m_registers = registers;
+ }
+
+ bool Z80CPU::IsFlagSet(Z80FlagBits flag) const {
+	 return (m_registers.f & flag) != 0;
+ }
+
+ void Z80CPU::SetFlag(Z80FlagBits flag, bool value) {
+	 if (value) {
+		 m_registers.f |= flag;
+	 } else {
+		 m_registers.f &= ~flag;
+	 }
+ }
+
+ uint64_t Z80CPU::GetCycleCount() const {
+	 return m_cycleCount;
+ }
+
+ uint32_t Z80CPU::GetClockSpeed() const {
+	 return m_clockSpeed;
+ }
+
+ void Z80CPU::SetClockSpeed(uint32_t clockSpeed) {
+	 m_clockSpeed = clockSpeed;
+ }
+
+ std::string Z80CPU::DisassembleInstruction(uint16_t address, int& instructionSize) {
+	 // Raw opcode byte only; symbolic disassembly is left to the debugger
+	 char text[16];
+	 std::snprintf(text, sizeof(text), "db $%02X", ReadByte(address));
+	 instructionSize = 1;
+	 return text;
+ }
+
+ void Z80CPU::SetPortHandler(uint8_t port, const Z80PortHandler& handler) {
+	 Z80PortHandler& slot = m_portHandlers[port];
+	 slot.context = handler.context;
+	 slot.read = handler.read ? handler.read : &Z80CPU::OpenBusRead;
+	 slot.write = handler.write ? handler.write : &Z80CPU::OpenBusWrite;
+ }
+
+ bool Z80CPU::RemovePortHandler(uint8_t port) {
+	 Z80PortHandler& slot = m_portHandlers[port];
+	 bool bound = slot.read != &Z80CPU::OpenBusRead || slot.write != &Z80CPU::OpenBusWrite;
+	 slot = Z80PortHandler{ nullptr, &Z80CPU::OpenBusRead, &Z80CPU::OpenBusWrite };
+	 return bound;
+ }
+
+ bool Z80CPU::MapMemory(uint16_t address, uint32_t size, uint8_t* data, bool writable) {
+	 if (!data) {
+		 return false;
+	 }
+	 return MapPages(address, size, data, writable, nullptr, &Z80CPU::OpenBusMemoryRead, &Z80CPU::OpenBusMemoryWrite);
+ }
+
+ bool Z80CPU::UnmapMemory(uint16_t address, uint32_t size) {
+	 return MapPages(address, size, nullptr, false, nullptr, &Z80CPU::OpenBusMemoryRead, &Z80CPU::OpenBusMemoryWrite);
+ }
+
+ bool Z80CPU::MapPages(uint16_t address, uint32_t size, uint8_t* data, bool writable, void* context,
+					   uint8_t (*read)(void*, uint16_t), void (*write)(void*, uint16_t, uint8_t)) {
+	 if (size == 0 || (address & PAGE_MASK) != 0 || (size & PAGE_MASK) != 0 || address + size > 0x10000) {
+		 m_logger.Error("Z80CPU", "Invalid memory mapping at " + std::to_string(address) +
+						" (" + std::to_string(size) + " bytes)");
+		 return false;
+	 }
+
+	 for (uint32_t offset = 0; offset < size; offset += PAGE_SIZE) {
+		 Z80MemoryPage& page = m_pages[(address + offset) >> PAGE_SHIFT];
+		 page.readPointer = data ? data + offset : nullptr;
+		 page.writePointer = (data && writable) ? data + offset : nullptr;
+		 page.context = context;
+		 page.read = read;
+		 page.write = write;
+	 }
+	 return true;
+ }
+
+ bool Z80CPU::RegisterExecutionHook(uint16_t address, std::function<void()> callback) {
+	 if (!callback) {
+		 return false;
+	 }
+	 m_executionHooks[address] = std::move(callback);
+	 m_executionHookBitmap[address >> 6] |= uint64_t(1) << (address & 63);
+	 m_hasExecutionHooks = true;
+	 return true;
+ }
+
+ bool Z80CPU::RemoveExecutionHook(uint16_t address) {
+	 if (m_executionHooks.erase(address) == 0) {
+		 return false;
+	 }
+	 m_executionHookBitmap[address >> 6] &= ~(uint64_t(1) << (address & 63));
+	 m_hasExecutionHooks = !m_executionHooks.empty();
+	 return true;
+ }
+
+ uint8_t Z80CPU::ReadByte(uint16_t address) {
+	 const Z80MemoryPage& page = m_pages[address >> PAGE_SHIFT];
+	 if (page.readPointer) {
+		 return page.readPointer[address & PAGE_MASK];
+	 }
+	 return page.read(page.context, address);
+ }
+
+ void Z80CPU::WriteByte(uint16_t address, uint8_t value) {
+	 const Z80MemoryPage& page = m_pages[address >> PAGE_SHIFT];
+	 if (page.writePointer) {
+		 page.writePointer[address & PAGE_MASK] = value;
+		 return;
+	 }
+	 page.write(page.context, address, value);
+ }
+
+ uint8_t Z80CPU::OpenBusMemoryRead(void*, uint16_t) {
+	 return OPEN_BUS_MEMORY;
+ }
+
+ void Z80CPU::OpenBusMemoryWrite(void*, uint16_t, uint8_t) {
+ }
+
+ uint16_t Z80CPU::ReadWord(uint16_t address) {
+	 // Little-endian, wrapping at the top of the 64 KB space
+	 uint8_t low = ReadByte(address);
+	 uint8_t high = ReadByte(static_cast<uint16_t>(address + 1));
+	 return static_cast<uint16_t>(low | (high << 8));
+ }
+
+ void Z80CPU::WriteWord(uint16_t address, uint16_t value) {
+	 WriteByte(address, static_cast<uint8_t>(value & 0xFF));
+	 WriteByte(static_cast<uint16_t>(address + 1), static_cast<uint8_t>(value >> 8));
+ }
+
+ uint8_t Z80CPU::InPort(uint8_t port) {
+	 const Z80PortHandler& handler = m_portHandlers[port];
+	 return handler.read(handler.context, port);
+ }
+
+ void Z80CPU::OutPort(uint8_t port, uint8_t value) {
+	 const Z80PortHandler& handler = m_portHandlers[port];
+	 handler.write(handler.context, port, value);
+ }
+
+ uint8_t Z80CPU::OpenBusRead(void*, uint8_t) {
+	 return OPEN_BUS_PORT;
+ }
+
+ void Z80CPU::OpenBusWrite(void*, uint8_t, uint8_t) {
+ }
+
+ void Z80CPU::Push(uint16_t value) {
+	 m_registers.sp -= 2;
+	 WriteWord(m_registers.sp, value);
+ }
+
+ uint16_t Z80CPU::Pop() {
+	 uint16_t value = ReadWord(m_registers.sp);
+	 m_registers.sp += 2;
+	 return value;
+ }
+
+ uint8_t Z80CPU::FetchOpcode() {
+	 // Every opcode fetch (prefixes included) refreshes R; bit 7 is never touched
+	 m_registers.r = static_cast<uint8_t>((m_registers.r & 0x80) | ((m_registers.r + 1) & 0x7F));
+	 return ReadByte(m_registers.pc++);
+ }
+
+ uint8_t Z80CPU::FetchByte() {
+	 return ReadByte(m_registers.pc++);
+ }
+
+ uint16_t Z80CPU::FetchWord() {
+	 uint16_t value = ReadWord(m_registers.pc);
+	 m_registers.pc += 2;
+	 return value;
+ }
+
+ } // namespace NiXX32
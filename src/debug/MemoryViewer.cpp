@@ -0,0 +1,68 @@
+/**
+ * MemoryViewer.cpp
+ * Implementation of the memory inspection and debugging system for NiXX-32 arcade board emulation
+ */
+
+ #include "MemoryViewer.h"
+
+ #include <algorithm>
+ #include <cmath>
+ #include <iomanip>
+ #include <sstream>
+
+ namespace NiXX32 {
+
+ std::string MemoryViewer::RenderAccessHeatmap(uint32_t startAddress, uint32_t size,
+											   uint32_t pagesPerRow) const {
+	 const auto& stats = m_memoryManager.GetAccessStats();
+	 if (!stats.IsEnabled()) {
+		 return "Access statistics not available (build with NIXX32_MEMORY_STATS)\n";
+	 }
+
+	 if (size == 0 || pagesPerRow == 0) {
+		 return "";
+	 }
+
+	 static const char shades[] = " .:-=+*#%@";
+	 constexpr int shadeCount = sizeof(shades) - 1;
+
+	 startAddress &= MemoryManager::ADDRESS_MASK;
+	 uint64_t endAddress = std::min<uint64_t>(uint64_t(startAddress) + size - 1, MemoryManager::ADDRESS_MASK);
+	 uint32_t firstPage = startAddress >> MemoryManager::PAGE_SHIFT;
+	 uint32_t lastPage = static_cast<uint32_t>(endAddress >> MemoryManager::PAGE_SHIFT);
+
+	 // Scale against the hottest page in the range
+	 uint64_t maxCount = 0;
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 MemoryAccessCounts counts = stats.GetPageCounts(page);
+		 maxCount = std::max(maxCount, counts.reads + counts.writes);
+	 }
+
+	 std::ostringstream ss;
+	 double scale = maxCount ? std::log2(static_cast<double>(maxCount) + 1.0) : 1.0;
+
+	 for (uint32_t page = firstPage; page <= lastPage; page++) {
+		 uint32_t column = (page - firstPage) % pagesPerRow;
+		 if (column == 0) {
+			 ss << std::hex << std::uppercase << std::setw(6) << std::setfill('0')
+				<< (page << MemoryManager::PAGE_SHIFT) << " |";
+		 }
+
+		 MemoryAccessCounts counts = stats.GetPageCounts(page);
+		 uint64_t total = counts.reads + counts.writes;
+		 int shade = 0;
+		 if (total) {
+			 double level = std::log2(static_cast<double>(total) + 1.0) / scale;
+			 shade = std::clamp(1 + static_cast<int>(level * (shadeCount - 2) + 0.5), 1, shadeCount - 1);
+		 }
+		 ss << shades[shade];
+
+		 if (column == pagesPerRow - 1 || page == lastPage) {
+			 ss << "|\n";
+		 }
+	 }
+
+	 return ss.str();
+ }
+
+ } // namespace NiXX32
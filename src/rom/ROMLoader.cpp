@@ -132,39 +132,53 @@
 		 return false;
 	 }
 	 
-	 // Read file into memory
-	 file.seekg(0, std::ios::end);
-	 size_t fileSize = file.tellg();
-	 file.seekg(0, std::ios::beg);
+	 // Uncompressed ROMs are viewed through a file mapping instead of being
+	 // read, so they can be mapped into the ROM region without any copies
+	 MemoryBuffer mappedFile;
+	 std::vector<uint8_t> fileData;
+	 ROMFormat format = DetectFormatFromFile(path);
+	 if (format == ROMFormat::BIN && mappedFile.MapFile(path)) {
+		 file.close();
+	 } else {
+		 // Read file into memory
+		 file.seekg(0, std::ios::end);
+		 size_t fileSize = file.tellg();
+		 file.seekg(0, std::ios::beg);
+		 
+		 fileData.resize(fileSize);
+		 file.read(reinterpret_cast<char*>(fileData.data()), fileSize);
+		 file.close();
+		 
+		 // Detect format
+		 format = DetectFormat(fileData.data(), fileSize);
+	 }
 	 
-	 std::vector<uint8_t> fileData(fileSize);
-	 file.read(reinterpret_cast<char*>(fileData.data()), fileSize);
-	 file.close();
+	 const uint8_t* fileBytes = mappedFile.IsMapped() ? mappedFile.data() : fileData.data();
+	 size_t fileSize = mappedFile.IsMapped() ? mappedFile.size() : fileData.size();
 	 
 	 UpdateProgress(path, fileSize, fileSize, ROMValidationStatus::UNKNOWN);
 	 
-	 // Detect format
-	 ROMFormat format = DetectFormat(fileData.data(), fileSize);
-	 
 	 // Get ROM name from path
 	 std::filesystem::path filePath(path);
 	 std::string romName = filePath.stem().string();
 	 
 	 // Extract files if compressed
-	 std::unordered_map<std::string, std::vector<uint8_t>> files;
+	 std::unordered_map<std::string, std::vector<uint8_t>> extractedFiles;
+	 std::vector<ROMFileView> files;
 	 if (format == ROMFormat::BIN) {
-		 // Single file, add to files map
-		 files[filePath.filename().string()] = fileData;
+		 // Single file, used in place
+		 files.push_back({ filePath.filename().string(), fileBytes, fileSize, path });
 	 } else {
 		 // Extract files from compressed ROM
-		 files = ExtractFiles(fileData.data(), fileSize, format);
+		 extractedFiles = ExtractFiles(fileBytes, fileSize, format);
 		 
-		 if (files.empty()) {
+		 if (extractedFiles.empty()) {
 			 SetError("Failed to extract files from compressed ROM");
 			 UpdateProgress(path, fileSize, fileSize, ROMValidationStatus::INVALID_FORMAT);
 			 return false;
 		 }
 		 
+		 files = MakeFileViews(extractedFiles);
 		 m_logger.Info("ROMLoader", "Extracted " + std::to_string(files.size()) + " files from " + path);
 	 }
 	 
@@ -194,8 +208,8 @@
 	 m_loadedROMInfo.status = status;
 	 m_loadedROMInfo.totalSize = 0;
 	 
-	 for (const auto& file : files) {
-		 m_loadedROMInfo.totalSize += file.second.size();
+	 for (const auto& loadedFile : files) {
+		 m_loadedROMInfo.totalSize += loadedFile.size;
 	 }
 	 
 	 m_logger.Info("ROMLoader", "ROM loaded successfully: " + romName);
@@ -478,6 +492,10 @@
 	 return m_loadedROMInfo;
  }
  
+ const std::vector<ROMFileInfo>& ROMLoader::GetLoadedROMFiles() const {
+	 return m_loadedROMFiles;
+ }
+ 
  bool ROMLoader::IsROMLoaded() const {
 	 return m_romLoaded;
  }
@@ -957,6 +975,14 @@
 	 const std::string& romName, 
 	 bool validateChecksum) {
 	 
+	 return ValidateROMFiles(MakeFileViews(files), romName, validateChecksum);
+ }
+ 
+ ROMValidationStatus ROMLoader::ValidateROMFiles(
+	 const std::vector<ROMFileView>& files,
+	 const std::string& romName,
+	 bool validateChecksum) {
+	 
 	 m_logger.Info("ROMLoader", "Validating ROM files for: " + romName);
 	 
 	 // Check if ROM is in database
@@ -973,7 +999,8 @@
 				 continue; // Skip optional files
 			 }
 			 
-			 auto fileIt = files.find(expectedFile.filename);
+			 auto fileIt = std::find_if(files.begin(), files.end(),
+										[&](const ROMFileView& file) { return file.filename == expectedFile.filename; });
 			 if (fileIt == files.end()) {
 				 m_logger.Warning("ROMLoader", "Missing required file: " + expectedFile.filename);
 				 missingFiles = true;
@@ -981,17 +1008,17 @@
 			 }
 			 
 			 // Check size
-			 if (fileIt->second.size() != expectedFile.size) {
+			 if (fileIt->size != expectedFile.size) {
 				 m_logger.Warning("ROMLoader", "File size mismatch for " + expectedFile.filename + 
 							   ": expected " + std::to_string(expectedFile.size) + 
-							   ", got " + std::to_string(fileIt->second.size()));
+							   ", got " + std::to_string(fileIt->size));
 				 wrongSize = true;
 				 break;
 			 }
 			 
 			 // Check checksum if requested
 			 if (validateChecksum) {
-				 uint32_t crc = CalculateCRC32(fileIt->second.data(), fileIt->second.size());
+				 uint32_t crc = CalculateCRC32(fileIt->data, fileIt->size);
 				 if (crc != expectedFile.crc32) {
 					 m_logger.Warning("ROMLoader", "Checksum mismatch for " + expectedFile.filename);
 					 wrongChecksum = true;
@@ -1022,7 +1049,7 @@
 		 // Check minimum file size (basic sanity check)
 		 bool hasSufficientSize = false;
 		 for (const auto& file : files) {
-			 if (file.second.size() >= 256) { // Arbitrary minimum size
+			 if (file.size >= 256) { // Arbitrary minimum size
 				 hasSufficientSize = true;
 				 break;
 			 }
@@ -1035,12 +1062,12 @@
 		 // Check for ROM header validity
 		 bool validHeader = false;
 		 for (const auto& file : files) {
-			 if (file.second.size() > 16) {
+			 if (file.size > 16) {
 				 // Simple validation: check for "NIXX" marker at start of ROM
 				 // In a real implementation, this would be a more sophisticated check
 				 const char* marker = "NIXX";
-				 if (std::search(file.second.begin(), file.second.begin() + 16, 
-							   marker, marker + 4) != file.second.begin() + 16) {
+				 if (std::search(file.data, file.data + 16, 
+							   marker, marker + 4) != file.data + 16) {
 					 validHeader = true;
 					 break;
 				 }
@@ -1053,9 +1080,9 @@
 			 
 			 for (const auto& file : files) {
 				 std::string ext;
-				 size_t dotPos = file.first.find_last_of(".");
+				 size_t dotPos = file.filename.find_last_of(".");
 				 if (dotPos != std::string::npos) {
-					 ext = file.first.substr(dotPos);
+					 ext = file.filename.substr(dotPos);
 					 std::transform(ext.begin(), ext.end(), ext.begin(), 
 								  [](unsigned char c) { return std::tolower(c); });
 					 
@@ -1079,6 +1106,13 @@
 	 const std::unordered_map<std::string, std::vector<uint8_t>>& files,
 	 const std::string& romName) {
 	 
+	 return LoadROMToMemory(MakeFileViews(files), romName);
+ }
+ 
+ bool ROMLoader::LoadROMToMemory(
+	 const std::vector<ROMFileView>& files,
+	 const std::string& romName) {
+	 
 	 m_logger.Info("ROMLoader", "Loading ROM data into memory for: " + romName);
 	 
 	 // Clear loaded ROM files
@@ -1089,7 +1123,8 @@
 	 if (it != m_romDatabase.end()) {
 		 // Found in database, use load addresses from database
 		 for (const auto& expectedFile : it->second) {
-			 auto fileIt = files.find(expectedFile.filename);
+			 auto fileIt = std::find_if(files.begin(), files.end(),
+										[&](const ROMFileView& file) { return file.filename == expectedFile.filename; });
 			 if (fileIt == files.end()) {
 				 if (expectedFile.required) {
 					 m_logger.Error("ROMLoader", "Missing required file: " + expectedFile.filename);
@@ -1101,17 +1136,26 @@
 			 // Create ROM file info
 			 ROMFileInfo fileInfo;
 			 fileInfo.filename = expectedFile.filename;
-			 fileInfo.size = fileIt->second.size();
-			 fileInfo.crc32 = CalculateCRC32(fileIt->second.data(), fileIt->second.size());
-			 fileInfo.md5 = CalculateMD5(fileIt->second.data(), fileIt->second.size());
-			 fileInfo.sha1 = CalculateSHA1(fileIt->second.data(), fileIt->second.size());
+			 fileInfo.size = fileIt->size;
+			 fileInfo.crc32 = CalculateCRC32(fileIt->data, fileIt->size);
+			 fileInfo.md5 = CalculateMD5(fileIt->data, fileIt->size);
+			 fileInfo.sha1 = CalculateSHA1(fileIt->data, fileIt->size);
 			 fileInfo.loadAddress = expectedFile.loadAddress;
 			 fileInfo.format = ROMFormat::BIN;
 			 fileInfo.required = expectedFile.required;
 			 fileInfo.region = expectedFile.region;
 			 
-			 // Load data into memory
-			 if (!m_memoryManager.LoadROM(fileIt->second, fileInfo.loadAddress)) {
+			 // Regions off the 68000 bus are addressed from their own start
+			 uint32_t address = fileInfo.loadAddress;
+			 MemoryRegion* region = m_memoryManager.GetRegionByName(fileInfo.region);
+			 if (region && !region->onMainBus) {
+				 address += region->startAddress;
+			 }
+			 
+			 // Map uncompressed files straight from disk, copy everything else
+			 bool mapped = !fileIt->sourcePath.empty() &&
+						   m_memoryManager.MapROMFile(fileIt->sourcePath, address);
+			 if (!mapped && !m_memoryManager.LoadROM(fileIt->data, fileIt->size, address)) {
 				 m_logger.Error("ROMLoader", "Failed to load ROM data at address " + 
 							 std::to_string(fileInfo.loadAddress));
 				 return false;
@@ -1130,18 +1174,20 @@
 		 for (const auto& file : files) {
 			 // Create ROM file info
 			 ROMFileInfo fileInfo;
-			 fileInfo.filename = file.first;
-			 fileInfo.size = file.second.size();
-			 fileInfo.crc32 = CalculateCRC32(file.second.data(), file.second.size());
-			 fileInfo.md5 = CalculateMD5(file.second.data(), file.second.size());
-			 fileInfo.sha1 = CalculateSHA1(file.second.data(), file.second.size());
+			 fileInfo.filename = file.filename;
+			 fileInfo.size = file.size;
+			 fileInfo.crc32 = CalculateCRC32(file.data, file.size);
+			 fileInfo.md5 = CalculateMD5(file.data, file.size);
+			 fileInfo.sha1 = CalculateSHA1(file.data, file.size);
 			 fileInfo.loadAddress = baseAddress;
 			 fileInfo.format = ROMFormat::BIN;
 			 fileInfo.required = true;
 			 fileInfo.region = "ROM";
 			 
-			 // Load data into memory
-			 if (!m_memoryManager.LoadROM(file.second, fileInfo.loadAddress)) {
+			 // Map uncompressed files straight from disk, copy everything else
+			 bool mapped = !file.sourcePath.empty() &&
+						   m_memoryManager.MapROMFile(file.sourcePath, fileInfo.loadAddress);
+			 if (!mapped && !m_memoryManager.LoadROM(file.data, file.size, fileInfo.loadAddress)) {
 				 m_logger.Error("ROMLoader", "Failed to load ROM data at address " + 
 							 std::to_string(fileInfo.loadAddress));
 				 return false;
@@ -1154,7 +1200,7 @@
 						std::to_string(fileInfo.loadAddress));
 			 
 			 // Increment base address for next file
-			 baseAddress += file.second.size();
+			 baseAddress += file.size;
 		 }
 	 }
 	 
@@ -1162,6 +1208,19 @@
 	 return true;
  }
  
+ std::vector<ROMFileView> ROMLoader::MakeFileViews(
+	 const std::unordered_map<std::string, std::vector<uint8_t>>& files) {
+	 
+	 std::vector<ROMFileView> views;
+	 views.reserve(files.size());
+	 
+	 for (const auto& file : files) {
+		 views.push_back({ file.first, file.second.data(), file.second.size(), "" });
+	 }
+	 
+	 return views;
+ }
+ 
  uint32_t ROMLoader::CalculateCRC32(const uint8_t* data, size_t size) {
 	 uint32_t crc = 0xFFFFFFFF;
 	 
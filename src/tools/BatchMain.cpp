@@ -0,0 +1,149 @@
+/**
+ * BatchMain.cpp
+ * Command line front end for the NiXX-32 batch runner
+ *
+ * Reads a manifest with one job per line:
+ *
+ *     # rom                 movie               hash file           [frames] [variant]
+ *     roms/telefunk1.rom    movies/attract.txt  out/attract.hash    3600     original
+ *     roms/telefunk2.rom    movies/stage1.txt   out/stage1.hash
+ *
+ * '-' stands for no movie or no hash file. Blank lines and text after '#'
+ * are ignored. A JSON summary of every job is printed when all are done.
+ *
+ * Usage: nixx32_batch <manifest> [--threads N]
+ */
+
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <fstream>
+ #include <sstream>
+ #include <string>
+ #include <vector>
+
+ #include "BatchRunner.h"
+
+ namespace {
+
+ using namespace NiXX32;
+
+ void PrintUsage(const char* program) {
+	 std::fprintf(stderr, "Usage: %s <manifest> [--threads N]\n", program);
+ }
+
+ bool LoadManifest(const std::string& path, std::vector<BatchJob>& jobs) {
+	 std::ifstream file(path);
+	 if (!file) {
+		 std::fprintf(stderr, "Failed to open manifest: %s\n", path.c_str());
+		 return false;
+	 }
+
+	 std::string line;
+	 int lineNumber = 0;
+	 while (std::getline(file, line)) {
+		 lineNumber++;
+		 size_t comment = line.find('#');
+		 if (comment != std::string::npos) {
+			 line.erase(comment);
+		 }
+
+		 std::istringstream fields(line);
+		 BatchJob job{ std::string(), std::string(), std::string(), 0, HardwareVariant::NIXX32_ORIGINAL };
+		 std::string variant;
+		 if (!(fields >> job.romPath)) {
+			 continue;
+		 }
+		 if (!(fields >> job.moviePath >> job.hashPath)) {
+			 std::fprintf(stderr, "%s:%d: expected rom, movie and hash file\n", path.c_str(), lineNumber);
+			 return false;
+		 }
+		 if (fields >> job.frames) {
+			 fields >> variant;
+		 } else if (!fields.eof()) {
+			 std::fprintf(stderr, "%s:%d: invalid frame count\n", path.c_str(), lineNumber);
+			 return false;
+		 }
+
+		 if (job.moviePath == "-") {
+			 job.moviePath.clear();
+		 }
+		 if (job.hashPath == "-") {
+			 job.hashPath.clear();
+		 }
+		 if (variant == "plus") {
+			 job.variant = HardwareVariant::NIXX32_PLUS;
+		 } else if (!variant.empty() && variant != "original") {
+			 std::fprintf(stderr, "%s:%d: unknown variant: %s\n", path.c_str(), lineNumber, variant.c_str());
+			 return false;
+		 }
+		 jobs.push_back(job);
+	 }
+	 return true;
+ }
+
+ // Quote a string for JSON output
+ std::string JsonString(const std::string& text) {
+	 std::string quoted = "\"";
+	 for (char c : text) {
+		 if (c == '"' || c == '\\') {
+			 quoted += '\\';
+			 quoted += c;
+		 } else if (static_cast<unsigned char>(c) < 0x20) {
+			 char escape[8];
+			 std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+			 quoted += escape;
+		 } else {
+			 quoted += c;
+		 }
+	 }
+	 return quoted + "\"";
+ }
+
+ } // namespace
+
+ int main(int argc, char* argv[]) {
+	 std::string manifestPath;
+	 unsigned threads = 0;
+	 for (int i = 1; i < argc; i++) {
+		 if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			 threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+		 } else if (argv[i][0] != '-' && manifestPath.empty()) {
+			 manifestPath = argv[i];
+		 } else {
+			 PrintUsage(argv[0]);
+			 return 2;
+		 }
+	 }
+	 if (manifestPath.empty()) {
+		 PrintUsage(argv[0]);
+		 return 2;
+	 }
+
+	 std::vector<BatchJob> jobs;
+	 if (!LoadManifest(manifestPath, jobs)) {
+		 return 1;
+	 }
+
+	 BatchRunner runner(threads);
+	 std::vector<BatchResult> results = runner.Run(jobs);
+
+	 bool allPassed = true;
+	 std::printf("{\n  \"threads\": %u,\n  \"jobs\": [\n", runner.GetThreadCount());
+	 for (size_t i = 0; i < jobs.size(); i++) {
+		 const BatchResult& result = results[i];
+		 allPassed = allPassed && result.success;
+		 std::printf("    {\"rom\": %s, \"movie\": %s, \"success\": %s, \"error\": %s, "
+					 "\"frames\": %llu, \"video_hash\": \"%016llx\", \"audio_hash\": \"%016llx\", "
+					 "\"seconds\": %.6f}%s\n",
+					 JsonString(jobs[i].romPath).c_str(), JsonString(jobs[i].moviePath).c_str(),
+					 result.success ? "true" : "false", JsonString(result.error).c_str(),
+					 static_cast<unsigned long long>(result.framesRun),
+					 static_cast<unsigned long long>(result.videoHash),
+					 static_cast<unsigned long long>(result.audioHash),
+					 result.seconds, i + 1 < jobs.size() ? "," : "");
+	 }
+	 std::printf("  ]\n}\n");
+
+	 return allPassed ? 0 : 1;
+ }
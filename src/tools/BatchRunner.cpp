@@ -0,0 +1,158 @@
+/**
+ * BatchRunner.cpp
+ * Implementation of the parallel multi-instance batch runner
+ *
+ * Workers take the next job index from a shared atomic counter, so no lock
+ * is held while jobs run and each result slot is written by one thread.
+ * Hashes are 64-bit FNV-1a over the rendered frame and the stereo samples
+ * produced for each frame.
+ */
+
+ #include "BatchRunner.h"
+ #include "InputMovie.h"
+
+ #include <algorithm>
+ #include <atomic>
+ #include <chrono>
+ #include <cstdio>
+ #include <exception>
+ #include <memory>
+ #include <thread>
+
+ namespace NiXX32 {
+
+ namespace {
+
+ constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+ constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+ // Emulated frames per second, for splitting audio output into frames
+ constexpr uint64_t FRAME_RATE = 60;
+
+ uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+	 const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	 for (size_t i = 0; i < size; i++) {
+		 hash = (hash ^ bytes[i]) * FNV_PRIME;
+	 }
+	 return hash;
+ }
+
+ } // namespace
+
+ BatchRunner::BatchRunner(unsigned threadCount)
+	 : m_threadCount(threadCount) {
+	 if (m_threadCount == 0) {
+		 m_threadCount = std::max(1u, std::thread::hardware_concurrency());
+	 }
+ }
+
+ std::vector<BatchResult> BatchRunner::Run(const std::vector<BatchJob>& jobs) {
+	 std::vector<BatchResult> results(jobs.size());
+	 std::atomic<size_t> nextJob(0);
+
+	 auto worker = [&]() {
+		 for (;;) {
+			 size_t index = nextJob.fetch_add(1, std::memory_order_relaxed);
+			 if (index >= jobs.size()) {
+				 break;
+			 }
+			 results[index] = RunJob(jobs[index]);
+		 }
+	 };
+
+	 size_t threadCount = std::min<size_t>(m_threadCount, jobs.size());
+	 std::vector<std::thread> threads;
+	 threads.reserve(threadCount);
+	 for (size_t i = 0; i < threadCount; i++) {
+		 threads.emplace_back(worker);
+	 }
+	 for (std::thread& thread : threads) {
+		 thread.join();
+	 }
+	 return results;
+ }
+
+ BatchResult BatchRunner::RunJob(const BatchJob& job) {
+	 BatchResult result{ false, std::string(), 0, FNV_OFFSET_BASIS, FNV_OFFSET_BASIS, 0.0 };
+	 auto start = std::chrono::steady_clock::now();
+
+	 std::unique_ptr<FILE, int(*)(FILE*)> hashFile(nullptr, &std::fclose);
+	 try {
+		 InputMovie movie;
+		 if (!job.moviePath.empty() && !movie.Load(job.moviePath, result.error)) {
+			 return result;
+		 }
+
+		 uint64_t frames = job.frames != 0 ? job.frames : movie.GetLength();
+		 if (frames == 0) {
+			 result.error = "No frame count given and no input movie to take it from";
+			 return result;
+		 }
+
+		 if (!job.hashPath.empty()) {
+			 hashFile.reset(std::fopen(job.hashPath.c_str(), "w"));
+			 if (!hashFile) {
+				 result.error = "Failed to open hash file: " + job.hashPath;
+				 return result;
+			 }
+		 }
+
+		 System system(job.variant, std::string());
+		 if (!system.Initialize(job.romPath)) {
+			 result.error = "Failed to initialize system with ROM: " + job.romPath;
+			 return result;
+		 }
+
+		 GraphicsSystem& graphics = system.GetGraphicsSystem();
+		 AudioSystem& audio = system.GetAudioSystem();
+		 InputSystem& input = system.GetInputSystem();
+
+		 uint16_t width = 0;
+		 uint16_t height = 0;
+		 graphics.GetScreenResolution(width, height);
+		 std::vector<uint32_t> frameBuffer(static_cast<size_t>(width) * height);
+
+		 uint64_t sampleRate = audio.GetConfig().sampleRate;
+		 std::vector<int16_t> samples;
+
+		 for (uint64_t frame = 0; frame < frames; frame++) {
+			 movie.Apply(frame, input);
+			 system.RunFrame();
+
+			 std::fill(frameBuffer.begin(), frameBuffer.end(), 0);
+			 graphics.Render(frameBuffer.data(), width, height, width * static_cast<int>(sizeof(uint32_t)));
+			 uint64_t videoHash = HashBytes(FNV_OFFSET_BASIS, frameBuffer.data(),
+											frameBuffer.size() * sizeof(uint32_t));
+
+			 // Whole samples due by the end of this frame, so no sample is lost
+			 // to rounding over a long run
+			 size_t sampleCount = static_cast<size_t>((frame + 1) * sampleRate / FRAME_RATE -
+													  frame * sampleRate / FRAME_RATE);
+			 samples.assign(sampleCount * 2, 0);
+			 if (sampleCount > 0) {
+				 audio.FillAudioBuffer(samples.data(), static_cast<int>(sampleCount));
+			 }
+			 uint64_t audioHash = HashBytes(FNV_OFFSET_BASIS, samples.data(), samples.size() * sizeof(int16_t));
+
+			 result.videoHash = videoHash;
+			 result.audioHash = HashBytes(result.audioHash, samples.data(), samples.size() * sizeof(int16_t));
+			 result.framesRun = frame + 1;
+
+			 if (hashFile) {
+				 std::fprintf(hashFile.get(), "%llu %016llx %016llx\n",
+							  static_cast<unsigned long long>(frame),
+							  static_cast<unsigned long long>(videoHash),
+							  static_cast<unsigned long long>(audioHash));
+			 }
+		 }
+		 result.success = true;
+	 }
+	 catch (const std::exception& e) {
+		 result.error = e.what();
+	 }
+
+	 result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	 return result;
+ }
+
+ } // namespace NiXX32
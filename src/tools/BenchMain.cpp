@@ -0,0 +1,245 @@
+/**
+ * BenchMain.cpp
+ * Headless throughput benchmark for NiXX-32 arcade board emulation
+ *
+ * Runs a ROM for a fixed number of emulated frames as fast as the host
+ * allows, with no renderer, audio output or frame pacing in the loop, and
+ * reports the result as a single JSON object so runs can be compared
+ * commit over commit.
+ *
+ * Usage: nixx32_bench <rom> [--frames N] [--variant original|plus]
+ *                          [--scanline] [--config path] [--output path]
+ */
+
+ #include <chrono>
+ #include <cstdint>
+ #include <cstdio>
+ #include <cstdlib>
+ #include <cstring>
+ #include <exception>
+ #include <string>
+ #include <vector>
+
+ #if defined(_WIN32)
+ #include <windows.h>
+ #include <psapi.h>
+ #else
+ #include <sys/resource.h>
+ #endif
+
+ #include "NiXX32System.h"
+ #include "HostProfiler.h"
+
+ namespace {
+
+ using namespace NiXX32;
+
+ // Frames run when --frames is not given (10 emulated seconds)
+ constexpr uint64_t DEFAULT_FRAMES = 600;
+
+ /**
+  * Benchmark settings from the command line
+  */
+ struct BenchOptions {
+	 std::string romPath;
+	 std::string configPath;
+	 std::string outputPath;   // Empty for stdout
+	 uint64_t frames = DEFAULT_FRAMES;
+	 HardwareVariant variant = HardwareVariant::NIXX32_ORIGINAL;
+	 bool scanline = false;
+ };
+
+ void PrintUsage(const char* program) {
+	 std::fprintf(stderr,
+				  "Usage: %s <rom> [--frames N] [--variant original|plus] [--scanline]\n"
+				  "       [--config path] [--output path]\n",
+				  program);
+ }
+
+ bool ParseOptions(int argc, char* argv[], BenchOptions& options) {
+	 for (int i = 1; i < argc; i++) {
+		 const char* arg = argv[i];
+		 bool hasValue = i + 1 < argc;
+
+		 if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+			 char* end = nullptr;
+			 options.frames = std::strtoull(argv[++i], &end, 10);
+			 if (*end != '\0' || options.frames == 0) {
+				 std::fprintf(stderr, "Invalid frame count: %s\n", argv[i]);
+				 return false;
+			 }
+		 } else if (std::strcmp(arg, "--variant") == 0 && hasValue) {
+			 std::string variant = argv[++i];
+			 if (variant == "original") {
+				 options.variant = HardwareVariant::NIXX32_ORIGINAL;
+			 } else if (variant == "plus") {
+				 options.variant = HardwareVariant::NIXX32_PLUS;
+			 } else {
+				 std::fprintf(stderr, "Unknown variant: %s\n", variant.c_str());
+				 return false;
+			 }
+		 } else if (std::strcmp(arg, "--scanline") == 0) {
+			 options.scanline = true;
+		 } else if (std::strcmp(arg, "--config") == 0 && hasValue) {
+			 options.configPath = argv[++i];
+		 } else if (std::strcmp(arg, "--output") == 0 && hasValue) {
+			 options.outputPath = argv[++i];
+		 } else if (arg[0] != '-' && options.romPath.empty()) {
+			 options.romPath = arg;
+		 } else {
+			 std::fprintf(stderr, "Unknown or incomplete option: %s\n", arg);
+			 return false;
+		 }
+	 }
+	 return !options.romPath.empty();
+ }
+
+ /**
+  * Get the peak resident set size of this process
+  * @return Peak RSS in kilobytes, or 0 if unavailable
+  */
+ uint64_t GetPeakRSSKilobytes() {
+ #if defined(_WIN32)
+	 PROCESS_MEMORY_COUNTERS counters;
+	 if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		 return static_cast<uint64_t>(counters.PeakWorkingSetSize) / 1024;
+	 }
+	 return 0;
+ #else
+	 struct rusage usage;
+	 if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		 return 0;
+	 }
+ #if defined(__APPLE__)
+	 return static_cast<uint64_t>(usage.ru_maxrss) / 1024;  // Bytes on macOS
+ #else
+	 return static_cast<uint64_t>(usage.ru_maxrss);         // Kilobytes on Linux
+ #endif
+ #endif
+ }
+
+ // Quote a string for JSON output
+ std::string JsonString(const std::string& text) {
+	 std::string quoted = "\"";
+	 for (char c : text) {
+		 switch (c) {
+			 case '"':  quoted += "\\\""; break;
+			 case '\\': quoted += "\\\\"; break;
+			 case '\n': quoted += "\\n"; break;
+			 case '\t': quoted += "\\t"; break;
+			 default:
+				 if (static_cast<unsigned char>(c) < 0x20) {
+					 char escape[8];
+					 std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+					 quoted += escape;
+				 } else {
+					 quoted += c;
+				 }
+				 break;
+		 }
+	 }
+	 return quoted + "\"";
+ }
+
+ } // namespace
+
+ int main(int argc, char* argv[]) {
+	 BenchOptions options;
+	 if (!ParseOptions(argc, argv, options)) {
+		 PrintUsage(argv[0]);
+		 return 2;
+	 }
+
+	 try {
+		 System system(options.variant, options.configPath);
+		 if (!system.Initialize(options.romPath)) {
+			 std::fprintf(stderr, "Failed to initialize system with ROM: %s\n", options.romPath.c_str());
+			 return 1;
+		 }
+		 system.SetScanlineRendering(options.scanline);
+
+		 GraphicsSystem& graphics = system.GetGraphicsSystem();
+		 uint16_t width = 0;
+		 uint16_t height = 0;
+		 graphics.GetScreenResolution(width, height);
+		 std::vector<uint32_t> frameBuffer(static_cast<size_t>(width) * height);
+
+		 M68000CPU& mainCPU = system.GetMainCPU();
+		 Z80CPU& audioCPU = system.GetAudioCPU();
+		 uint64_t mainStartCycles = mainCPU.GetCycleCount();
+		 uint64_t audioStartCycles = audioCPU.GetCycleCount();
+
+		 HostProfiler& profiler = system.GetProfiler();
+		 profiler.SetEnabled(true);
+		 profiler.Reset();
+
+		 auto start = std::chrono::steady_clock::now();
+		 for (uint64_t frame = 0; frame < options.frames; frame++) {
+			 system.RunFrame();
+
+			 // Composing the frame is part of the cost a front end would pay
+			 ProfileScope profile(profiler, ProfileCategory::GRAPHICS);
+			 graphics.Render(frameBuffer.data(), width, height, width * static_cast<int>(sizeof(uint32_t)));
+		 }
+		 double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		 profiler.SetEnabled(false);
+
+		 uint64_t mainCycles = mainCPU.GetCycleCount() - mainStartCycles;
+		 uint64_t audioCycles = audioCPU.GetCycleCount() - audioStartCycles;
+		 double safeSeconds = seconds > 0.0 ? seconds : 1e-9;
+
+		 std::string json = "{\n";
+		 char line[256];
+		 json += "  \"rom\": " + JsonString(options.romPath) + ",\n";
+		 json += std::string("  \"variant\": \"") +
+				 (options.variant == HardwareVariant::NIXX32_PLUS ? "plus" : "original") + "\",\n";
+		 json += std::string("  \"mode\": \"") + (options.scanline ? "scanline" : "frame") + "\",\n";
+		 std::snprintf(line, sizeof(line), "  \"frames\": %llu,\n", static_cast<unsigned long long>(options.frames));
+		 json += line;
+		 std::snprintf(line, sizeof(line), "  \"wall_seconds\": %.6f,\n", seconds);
+		 json += line;
+		 std::snprintf(line, sizeof(line), "  \"fps\": %.3f,\n", options.frames / safeSeconds);
+		 json += line;
+		 std::snprintf(line, sizeof(line), "  \"main_cpu_mhz\": %.3f,\n", mainCycles / safeSeconds / 1e6);
+		 json += line;
+		 std::snprintf(line, sizeof(line), "  \"audio_cpu_mhz\": %.3f,\n", audioCycles / safeSeconds / 1e6);
+		 json += line;
+		 std::snprintf(line, sizeof(line), "  \"main_cpu_cycles\": %llu,\n", static_cast<unsigned long long>(mainCycles));
+		 json += line;
+		 std::snprintf(line, sizeof(line), "  \"audio_cpu_cycles\": %llu,\n", static_cast<unsigned long long>(audioCycles));
+		 json += line;
+
+		 json += "  \"subsystem_seconds\": {\n";
+		 for (size_t i = 0; i < static_cast<size_t>(ProfileCategory::COUNT); i++) {
+			 ProfileCategory category = static_cast<ProfileCategory>(i);
+			 std::snprintf(line, sizeof(line), "    \"%s\": %.6f%s\n",
+						   HostProfiler::GetCategoryName(category), profiler.GetSeconds(category),
+						   i + 1 < static_cast<size_t>(ProfileCategory::COUNT) ? "," : "");
+			 json += line;
+		 }
+		 json += "  },\n";
+
+		 std::snprintf(line, sizeof(line), "  \"peak_rss_kb\": %llu\n",
+					   static_cast<unsigned long long>(GetPeakRSSKilobytes()));
+		 json += line;
+		 json += "}\n";
+
+		 if (options.outputPath.empty()) {
+			 std::fputs(json.c_str(), stdout);
+		 } else {
+			 FILE* file = std::fopen(options.outputPath.c_str(), "w");
+			 if (!file) {
+				 std::fprintf(stderr, "Failed to open output file: %s\n", options.outputPath.c_str());
+				 return 1;
+			 }
+			 std::fputs(json.c_str(), file);
+			 std::fclose(file);
+		 }
+	 }
+	 catch (const std::exception& e) {
+		 std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+		 return 1;
+	 }
+
+	 return 0;
+ }
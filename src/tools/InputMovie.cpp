@@ -0,0 +1,117 @@
+/**
+ * InputMovie.cpp
+ * Implementation of scripted input playback
+ */
+
+ #include "InputMovie.h"
+ #include "InputSystem.h"
+
+ #include <algorithm>
+ #include <fstream>
+ #include <sstream>
+
+ namespace NiXX32 {
+
+ InputMovie::InputMovie()
+	 : m_cursor(0) {
+ }
+
+ bool InputMovie::Load(const std::string& path, std::string& error) {
+	 m_events.clear();
+	 m_cursor = 0;
+
+	 std::ifstream file(path);
+	 if (!file) {
+		 error = "Failed to open input movie: " + path;
+		 return false;
+	 }
+
+	 std::string line;
+	 int lineNumber = 0;
+	 while (std::getline(file, line)) {
+		 lineNumber++;
+		 size_t comment = line.find('#');
+		 if (comment != std::string::npos) {
+			 line.erase(comment);
+		 }
+
+		 std::istringstream fields(line);
+		 uint64_t frame = 0;
+		 std::string action;
+		 if (!(fields >> frame)) {
+			 // Blank or comment-only lines have no frame number
+			 if (line.find_first_not_of(" \t\r") == std::string::npos) {
+				 continue;
+			 }
+			 error = path + ":" + std::to_string(lineNumber) + ": expected a frame number";
+			 return false;
+		 }
+		 fields >> action;
+
+		 MovieEvent event{ frame, MovieAction::JOYSTICK, 0, 0, 0 };
+		 unsigned first = 0;
+		 unsigned second = 0;
+		 unsigned third = 0;
+		 bool valid = false;
+		 if (action == "joystick") {
+			 valid = static_cast<bool>(fields >> first >> second) && second <= 0x0F;
+			 event.action = MovieAction::JOYSTICK;
+			 event.player = static_cast<uint8_t>(first);
+			 event.value = static_cast<uint8_t>(second);
+		 } else if (action == "button") {
+			 valid = static_cast<bool>(fields >> first >> second >> third) && third <= 1;
+			 event.action = MovieAction::BUTTON;
+			 event.player = static_cast<uint8_t>(first);
+			 event.control = static_cast<uint8_t>(second);
+			 event.value = static_cast<uint8_t>(third);
+		 } else if (action == "coin" || action == "service") {
+			 valid = static_cast<bool>(fields >> first >> second) && second <= 1;
+			 event.action = action == "coin" ? MovieAction::COIN : MovieAction::SERVICE;
+			 event.control = static_cast<uint8_t>(first);
+			 event.value = static_cast<uint8_t>(second);
+		 }
+		 valid = valid && first <= 0xFF && second <= 0xFF;
+
+		 if (!valid) {
+			 error = path + ":" + std::to_string(lineNumber) + ": invalid input change";
+			 return false;
+		 }
+		 m_events.push_back(event);
+	 }
+
+	 // Changes on the same frame keep their file order
+	 std::stable_sort(m_events.begin(), m_events.end(),
+					  [](const MovieEvent& a, const MovieEvent& b) { return a.frame < b.frame; });
+	 return true;
+ }
+
+ void InputMovie::Apply(uint64_t frame, InputSystem& input) {
+	 while (m_cursor < m_events.size() && m_events[m_cursor].frame <= frame) {
+		 const MovieEvent& event = m_events[m_cursor++];
+		 bool pressed = event.value != 0;
+		 switch (event.action) {
+			 case MovieAction::JOYSTICK:
+				 input.SetJoystickDirection(static_cast<JoystickDirection>(event.value), event.player);
+				 break;
+			 case MovieAction::BUTTON:
+				 input.SetButtonState(event.control, pressed, event.player);
+				 break;
+			 case MovieAction::COIN:
+				 input.SetCoinControlState(event.control, pressed);
+				 break;
+			 case MovieAction::SERVICE:
+				 input.SetServiceControlState(event.control, pressed);
+				 break;
+		 }
+	 }
+ }
+
+ void InputMovie::Rewind() {
+	 m_cursor = 0;
+ }
+
+ uint64_t InputMovie::GetLength() const {
+	 return m_events.empty() ? 0 : m_events.back().frame + 1;
+ }
+
+ } // namespace NiXX32
@@ -0,0 +1,58 @@
+/**
+ * FrameExchange.cpp
+ * Implementation of the lock-free triple-buffered frame handoff
+ *
+ * Publish() and AcquireLatest() each swap their own buffer with the spare
+ * in one atomic exchange. Release/acquire ordering on that exchange makes
+ * the pixels written before Publish() visible to the consumer that picks
+ * the buffer up.
+ */
+
+ #include "FrameExchange.h"
+
+ #include <algorithm>
+
+ namespace NiXX32 {
+
+ FrameExchange::FrameExchange()
+	 : m_width(0),
+	   m_height(0),
+	   m_writeIndex(0),
+	   m_readIndex(1),
+	   m_spare(2) {
+ }
+
+ void FrameExchange::Resize(int width, int height) {
+	 m_width = std::max(width, 0);
+	 m_height = std::max(height, 0);
+	 for (std::vector<uint32_t>& buffer : m_buffers) {
+		 buffer.assign(static_cast<size_t>(m_width) * m_height, 0);
+	 }
+	 m_writeIndex = 0;
+	 m_readIndex = 1;
+	 m_spare.store(2, std::memory_order_relaxed);
+ }
+
+ uint32_t* FrameExchange::GetWriteBuffer() {
+	 return m_buffers[m_writeIndex].data();
+ }
+
+ void FrameExchange::Publish() {
+	 uint8_t previous = m_spare.exchange(static_cast<uint8_t>(m_writeIndex | FRESH), std::memory_order_acq_rel);
+	 m_writeIndex = previous & INDEX_MASK;
+ }
+
+ bool FrameExchange::AcquireLatest() {
+	 if (!(m_spare.load(std::memory_order_relaxed) & FRESH)) {
+		 return false;
+	 }
+	 uint8_t previous = m_spare.exchange(m_readIndex, std::memory_order_acq_rel);
+	 m_readIndex = previous & INDEX_MASK;
+	 return true;
+ }
+
+ const uint32_t* FrameExchange::GetReadBuffer() const {
+	 return m_buffers[m_readIndex].data();
+ }
+
+ } // namespace NiXX32